@@ -3,6 +3,8 @@
 #include <Tempest/Log>
 #include <Tempest/TextCodec>
 #include <cstring>
+#include <cstdlib>
+#include <algorithm>
 
 #include "gothic.h"
 
@@ -76,6 +78,16 @@ CommandLine::CommandLine(int argc, const char** argv) {
       if(i<argc)
         isMeshSh = (std::string_view(argv[i])!="0" && std::string_view(argv[i])!="false");
       }
+    else if(arg=="-workers") {
+      ++i;
+      if(i<argc)
+        workers = size_t(std::max(0,std::atoi(argv[i])));
+      }
+    else if(arg=="-cache") {
+      ++i;
+      if(i<argc)
+        cache = argv[i];
+      }
     }
 
   if(gpath.empty()) {
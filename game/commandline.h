@@ -31,6 +31,8 @@ class CommandLine {
     bool                doForceG1()     const { return forceG1;  }
     bool                doForceG2()     const { return forceG2;  }
     std::string_view    defaultSave()   const { return saveDef;  }
+    size_t              workerThreads() const { return workers;  }
+    std::string_view    cachePath()     const { return cache;    }
 
     std::string         wrldDef;
 
@@ -40,6 +42,7 @@ class CommandLine {
     GraphicBackend      graphics = GraphicBackend::Vulkan;
     std::u16string      gpath, gscript, gmod;
     std::string         saveDef;
+    std::string         cache;
     bool                noMenu   = false;
     bool                isWindow = false;
     bool                isDebug  = false;
@@ -51,5 +54,6 @@ class CommandLine {
     bool                isMeshSh = true;
     bool                forceG1  = false;
     bool                forceG2  = false;
+    size_t              workers  = 0;
   };
 
@@ -0,0 +1,125 @@
+#include "assetprefetch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <unordered_set>
+
+#include "resources.h"
+#include "gothic.h"
+
+static std::string entryKey(const AssetManifest::Entry& e) {
+  std::string ret;
+  ret.reserve(e.name.size()+1);
+  ret.push_back(char('0'+e.kind));
+  ret += e.name;
+  return ret;
+  }
+
+AssetPrefetch::~AssetPrefetch() {
+  cancel();
+  }
+
+bool AssetPrefetch::isEnabled() {
+  return Gothic::settingsGetI("PERFORMANCE","assetPrefetch")!=0;
+  }
+
+AssetManifest AssetPrefetch::record(uint32_t epoch) {
+  AssetManifest ret;
+  ret.entries = Resources::usedAssets(epoch);
+  // sounds are cheap and are played long after load: last priority
+  for(auto& s:Gothic::inst().usedSoundFx(epoch))
+    ret.entries.push_back(AssetManifest::Entry{AssetManifest::Sound,std::move(s)});
+  return ret;
+  }
+
+void AssetPrefetch::start(std::string_view w) {
+  if(!isEnabled())
+    return;
+  auto k = AssetManifest::key(w);
+  if(k==world && isBusy())
+    return;
+  cancel();
+
+  if(k!=world) {
+    world    = std::move(k);
+    manifest = AssetManifest::load(w);
+    loadUs   = std::make_unique<std::atomic<uint64_t>[]>(manifest.entries.size());
+    }
+  // same world again: assets are looked up once more, to keep them alive for new cache epoch
+  done.store(0);
+  stop.store(false);
+  if(manifest.isEmpty())
+    return;
+  // chain of small jobs keeps order of first use
+  const size_t count = manifest.entries.size();
+  for(size_t i=0; i<count; i+=BatchSize) {
+    const size_t e = std::min(count,i+BatchSize);
+    if(task)
+      task = Workers::then(task,[this,i,e](){ run(i,e); }); else
+      task = Workers::async([this,i,e](){ run(i,e); });
+    }
+  }
+
+void AssetPrefetch::cancel() {
+  stop.store(true);
+  if(task)
+    task.wait();
+  task = Workers::Task();
+  }
+
+bool AssetPrefetch::isBusy() const {
+  return task && !task.isDone();
+  }
+
+bool AssetPrefetch::isTarget(std::string_view w) const {
+  return !world.empty() && world==AssetManifest::key(w);
+  }
+
+AssetPrefetch::Stats AssetPrefetch::stats(const AssetManifest& used) const {
+  std::unordered_set<std::string> inUse;
+  for(auto& e:used.entries)
+    inUse.insert(entryKey(e));
+
+  Stats st;
+  st.entries = manifest.entries.size();
+  st.loaded  = done.load(std::memory_order_acquire);
+  for(size_t i=0; i<st.loaded; ++i) {
+    if(inUse.find(entryKey(manifest.entries[i]))==inUse.end())
+      continue;
+    st.used   += 1;
+    st.usedUs += loadUs[i].load(std::memory_order_relaxed);
+    }
+  return st;
+  }
+
+void AssetPrefetch::run(size_t begin, size_t end) {
+  Resources::PrefetchScope scope;
+  for(size_t i=begin; i<end; ++i) {
+    if(stop.load(std::memory_order_relaxed))
+      break;
+    auto&      e     = manifest.entries[i];
+    const auto time0 = std::chrono::steady_clock::now();
+    try {
+      switch(e.kind) {
+        case AssetManifest::Texture:
+          Resources::loadTexture(e.name);
+          break;
+        case AssetManifest::Mesh:
+          Resources::loadMesh(e.name);
+          break;
+        case AssetManifest::Animation:
+          Resources::loadAnimation(e.name);
+          break;
+        case AssetManifest::Sound:
+          Gothic::inst().loadSoundFx(e.name);
+          break;
+        }
+      }
+    catch(...) {
+      // not fatal: world reports it, if asset is still in use
+      }
+    auto dt = std::chrono::steady_clock::now()-time0;
+    loadUs[i].fetch_add(uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(dt).count()),std::memory_order_relaxed);
+    done.store(i+1,std::memory_order_release);
+    }
+  }
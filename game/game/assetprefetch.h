@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "utils/assetmanifest.h"
+#include "utils/workers.h"
+
+// Loads assets, recorded in manifest of a world, on worker thread and in order of first use:
+// world load is then served from warm caches. Prefetched assets are not counted as used by the world.
+class AssetPrefetch final {
+  public:
+    struct Stats final {
+      size_t   entries = 0; // in manifest
+      size_t   loaded  = 0; // prefetched so far
+      size_t   used    = 0; // prefetched, then used by world
+      uint64_t usedUs  = 0; // prefetch time of used assets: upper bound of time, saved by world load
+      };
+
+    AssetPrefetch() = default;
+    ~AssetPrefetch();
+
+    static bool          isEnabled();
+    // assets, used by world, that was entered at cache `epoch`
+    static AssetManifest record(uint32_t epoch);
+
+    // no-op, if `world` is being prefetched already; prefetch of other world is canceled
+    void                 start(std::string_view world);
+    void                 cancel();
+    bool                 isBusy() const;
+
+    bool                 isTarget(std::string_view world) const;
+    Stats                stats(const AssetManifest& used) const;
+
+  private:
+    // assets per job: waiting main thread may pick up a job, it must not stall for whole manifest
+    static constexpr size_t BatchSize = 8;
+
+    void                 run(size_t begin, size_t end);
+
+    std::string                              world;
+    AssetManifest                            manifest;
+    std::unique_ptr<std::atomic<uint64_t>[]> loadUs;
+    std::atomic<size_t>                      done{0};
+    std::atomic<bool>                        stop{false};
+    Workers::Task                            task; // last batch of the chain
+  };
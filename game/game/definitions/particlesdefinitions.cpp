@@ -4,6 +4,7 @@
 
 #include "graphics/pfx/particlefx.h"
 #include "utils/fileext.h"
+#include "resources.h"
 #include "gothic.h"
 
 using namespace Tempest;
@@ -41,6 +42,7 @@ const ParticleFx* ParticlesDefinitions::implGet(std::string_view name, bool rela
   auto decl=implGetDirect(name, relaxed);
   if(!decl)
     return nullptr;
+  Resources::PinScope pin; // definitions outlive world
   std::unique_ptr<ParticleFx> p{new ParticleFx(*decl,name)};
   auto elt = pfx.insert(std::make_pair(std::move(cname),std::move(p)));
 
@@ -52,6 +54,7 @@ const ParticleFx* ParticlesDefinitions::implGet(const ParticleFx& base, const Vi
   if(it!=pfxKey.end())
     return it->second.get();
 
+  Resources::PinScope pin;
   std::unique_ptr<ParticleFx> p{new ParticleFx(base,key)};
   auto elt = pfxKey.insert(std::make_pair(&key,std::move(p)));
 
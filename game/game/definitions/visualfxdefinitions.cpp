@@ -3,6 +3,7 @@
 #include <Tempest/Log>
 
 #include "graphics/visualfx.h"
+#include "resources.h"
 #include "gothic.h"
 
 using namespace Tempest;
@@ -24,6 +25,7 @@ const VisualFx* VisualFxDefinitions::get(std::string_view name) {
   if(def == nullptr)
     return nullptr;
 
+  Resources::PinScope pin; // definitions outlive world
   auto ret = vfx.insert(std::make_pair<std::string,std::unique_ptr<VisualFx>>(std::move(cname),nullptr));
   ret.first->second.reset(new VisualFx(*def,*vm,name));
 
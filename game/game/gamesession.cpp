@@ -5,6 +5,7 @@
 #include <Tempest/MemReader>
 #include <Tempest/MemWriter>
 #include <cctype>
+#include <chrono>
 
 #include "utils/string_frm.h"
 #include "worldstatestorage.h"
@@ -59,6 +60,7 @@ GameSession::GameSession(std::string file) {
   Gothic::inst().setLoadingProgress(0);
   setupSettings();
   setTime(gtime(8,0));
+  prefetch.start(file);
 
   vm.reset(new GameScript(*this));
   setWorld(std::unique_ptr<World>(new World(*this,std::move(file),true,[&](int v){
@@ -119,6 +121,7 @@ GameSession::GameSession(Serialize &fin) {
   std::string    wname;
   fin.setEntry("game/session");
   fin.read(ticks,wrldTime,wrldTimePart,wname);
+  prefetch.start(wname);
 
   cam.reset(new Camera());
   vm.reset(new GameScript(*this));
@@ -148,6 +151,7 @@ GameSession::GameSession(Serialize &fin) {
   }
 
 GameSession::~GameSession() {
+  recordAssets();
   }
 
 void GameSession::save(Serialize &fout, std::string_view name, const Pixmap& screen) {
@@ -229,6 +233,10 @@ void GameSession::changeWorld(std::string_view world, std::string_view wayPoint)
   chWorld.wp  = wayPoint;
   }
 
+void GameSession::prefetchWorld(std::string_view world) {
+  prefetch.start(world);
+  }
+
 void GameSession::exitSession() {
   exitSessionFlg=true;
   }
@@ -324,6 +332,10 @@ auto GameSession::implChangeWorld(std::unique_ptr<GameSession>&& game,
     return std::move(game);
     }
 
+  const auto time0 = std::chrono::steady_clock::now();
+  recordAssets();
+  prefetch.start(w);
+
   HeroStorage hdata;
   if(auto hero = wrld->player())
     hdata.save(*hero);
@@ -368,9 +380,29 @@ auto GameSession::implChangeWorld(std::unique_ptr<GameSession>&& game,
 
   cam->reset(wrld->player());
   Log::i("Done loading world[",world,"]");
+
+  if(prefetch.isTarget(w)) {
+    auto dt = std::chrono::steady_clock::now()-time0;
+    auto st = prefetch.stats(AssetPrefetch::record(wrld->cacheEpoch()));
+    Log::i("world change: ",int(std::chrono::duration_cast<std::chrono::milliseconds>(dt).count())," ms; asset prefetch: ",
+           int(st.used)," of ",int(st.loaded),"/",int(st.entries)," prefetched assets in use (",
+           int(st.loaded>0 ? st.used*100/st.loaded : 0),"%), saved up to ",int(st.usedUs/1000)," ms");
+    }
   return std::move(game);
   }
 
+void GameSession::recordAssets() {
+  if(wrld==nullptr || !AssetPrefetch::isEnabled())
+    return;
+  auto used = AssetPrefetch::record(wrld->cacheEpoch());
+  if(prefetch.isTarget(wrld->name())) {
+    auto st = prefetch.stats(used);
+    Log::i("asset prefetch: world \"",wrld->name(),"\" used ",int(st.used)," of ",int(st.loaded)," prefetched assets (",
+           int(st.loaded>0 ? st.used*100/st.loaded : 0),"%), ",int(used.entries.size())," assets in total");
+    }
+  used.save(wrld->name());
+  }
+
 const WorldStateStorage& GameSession::findStorage(std::string_view name) {
   for(auto& i:visitedWorlds)
     if(i.compareName(name))
@@ -7,6 +7,7 @@
 #include "ui/documentmenu.h"
 #include "ui/chapterscreen.h"
 #include "game/gamescript.h"
+#include "game/assetprefetch.h"
 #include "camera.h"
 #include "gamemusic.h"
 #include "gametime.h"
@@ -38,6 +39,8 @@ class GameSession final {
     auto         clearWorld() -> std::unique_ptr<World>;
 
     void         changeWorld(std::string_view world, std::string_view wayPoint);
+    // loads assets of `world` in background, ahead of changeWorld
+    void         prefetchWorld(std::string_view world);
     void         exitSession();
 
     auto         version() const -> const VersionInfo&;
@@ -89,6 +92,7 @@ class GameSession final {
     void         initScripts(bool firstTime);
     auto         implChangeWorld(std::unique_ptr<GameSession> &&game, std::string_view world, std::string_view wayPoint) -> std::unique_ptr<GameSession>;
     auto         findStorage(std::string_view name) -> const WorldStateStorage&;
+    void         recordAssets();
 
     Tempest::SoundDevice           sound;
 
@@ -102,6 +106,7 @@ class GameSession final {
     std::vector<WorldStateStorage> visitedWorlds;
 
     ChWorld                        chWorld;
+    AssetPrefetch                  prefetch;
     bool                           exitSessionFlg=false;
 
     static const uint64_t          multTime;
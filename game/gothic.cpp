@@ -17,7 +17,9 @@
 #include "game/serialize.h"
 
 #include "utils/fileutil.h"
+#include "utils/cachedir.h"
 #include "utils/inifile.h"
+#include "utils/workers.h"
 
 #include "commandline.h"
 
@@ -82,6 +84,31 @@ Gothic::Gothic() {
   defaults->set("ENGINE", "zWindCycleTime",     4);
   defaults->set("ENGINE", "zWindCycleTimeVar",  6);
 
+  defaults->set("PERFORMANCE", "workerThreads", 0);
+  defaults->set("PERFORMANCE", "workerPinning", 0);
+  // asset cache budgets, in megabytes; 0 - unlimited
+  defaults->set("PERFORMANCE", "textureCacheMb",   512);
+  defaults->set("PERFORMANCE", "meshCacheMb",      256);
+  defaults->set("PERFORMANCE", "animationCacheMb", 128);
+  defaults->set("PERFORMANCE", "emitterCacheMb",   16);
+  defaults->set("PERFORMANCE", "bundleCacheMb",    16);
+  // landscape collision, stored in "landscape" of cache directory; size limit in megabytes
+  defaults->set("PERFORMANCE", "landscapeCache",   1);
+  defaults->set("PERFORMANCE", "landscapeCacheMb", 512);
+  // packed meshes, skeletons and animation samples, stored in "assets" of cache directory; size limit in megabytes
+  defaults->set("PERFORMANCE", "assetCache",       1);
+  defaults->set("PERFORMANCE", "assetCacheMb",     1024);
+  // per-world manifests of used assets, stored in "manifest" of cache directory and prefetched on world change
+  defaults->set("PERFORMANCE", "assetPrefetch",    1);
+  // quantized storage of animation samples, decoded on the fly
+  defaults->set("PERFORMANCE", "animCompress",     1);
+  // animation samples are read on first use of sequence
+  defaults->set("PERFORMANCE", "animLazy",         1);
+  // reduced update rate of skeletal animation for distant and culled objects
+  defaults->set("PERFORMANCE", "animLod",          1);
+  // npc, playing same idle loop at close time, share sampled pose
+  defaults->set("PERFORMANCE", "poseCache",        1);
+
   defaults->set("KEYS", "keyEnd",         "0100");
   defaults->set("KEYS", "keyHeal",        "2300");
   defaults->set("KEYS", "keyPotion",      "1900");
@@ -108,6 +135,24 @@ Gothic::Gothic() {
   defaults->set("KEYS", "keyShowMap",     "3200");
   }
 
+  {
+  size_t workers = CommandLine::inst().workerThreads();
+  if(workers==0)
+    workers = size_t(std::max(0,settingsGetI("PERFORMANCE","workerThreads")));
+  Workers::setup(workers,settingsGetI("PERFORMANCE","workerPinning")!=0);
+  }
+  animLod   = settingsGetI("PERFORMANCE","animLod")!=0;
+  poseCache = settingsGetI("PERFORMANCE","poseCache")!=0;
+
+  {
+  // on-disk caches are bounded once per run: files, written during session, stay until next start
+  auto limit = [](std::string_view name) { return uint64_t(std::max(0,settingsGetI("PERFORMANCE",name)))*1024*1024; };
+  if(settingsGetI("PERFORMANCE","landscapeCache")!=0)
+    CacheDir::trim(CacheDir::dir("landscape"),limit("landscapeCacheMb"));
+  if(settingsGetI("PERFORMANCE","assetCache")!=0)
+    CacheDir::trim(CacheDir::dir("assets"),limit("assetCacheMb"));
+  }
+
   detectGothicVersion();
 
   std::u16string_view mod = CommandLine::inst().modPath();
@@ -235,6 +280,8 @@ SoundFx *Gothic::loadSoundFx(std::string_view name) {
   auto cname = std::string(name);
 
   std::lock_guard<std::mutex> guard(syncSnd);
+  if(!CacheUsage::isPrefetching())
+    sndFxUse[cname] = CacheUsage::epoch();
   auto it=sndFxCache.find(cname);
   if(it!=sndFxCache.end())
     return &it->second;
@@ -249,6 +296,16 @@ SoundFx *Gothic::loadSoundFx(std::string_view name) {
     }
   }
 
+std::vector<std::string> Gothic::usedSoundFx(uint32_t epoch) {
+  std::vector<std::string> ret;
+  std::lock_guard<std::mutex> guard(syncSnd);
+  for(auto& [name,e]:sndFxUse)
+    if(e>=epoch && sndFxCache.find(name)!=sndFxCache.end())
+      ret.push_back(name);
+  std::sort(ret.begin(),ret.end());
+  return ret;
+  }
+
 SoundFx *Gothic::loadSoundWavFx(std::string_view name) {
   auto snd   = Resources::loadSoundBuffer(name);
   auto cname = std::string(name);
@@ -399,7 +456,10 @@ void Gothic::startLoad(std::string_view banner,
 void Gothic::implStartLoadSave(std::string_view banner,
                                bool load,
                                const std::function<std::unique_ptr<GameSession>(std::unique_ptr<GameSession>&&)> f) {
-  loadTex = banner.empty() ? &saveTex : Resources::loadTexture(banner);
+  {
+    Resources::PinScope pin; // banner stays on screen, while epoch changes
+    loadTex = banner.empty() ? &saveTex : Resources::loadTexture(banner);
+  }
   loadProgress.store(0);
 
   auto zero=LoadState::Idle;
@@ -408,6 +468,8 @@ void Gothic::implStartLoadSave(std::string_view banner,
     return; // loading already
     }
 
+  if(load)
+    Resources::startCacheEpoch();
   onStartLoading();
   auto g = clearGame().release();
   try{
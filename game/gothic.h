@@ -66,6 +66,8 @@ class Gothic final {
 
     SoundFx*     loadSoundFx   (std::string_view name);
     SoundFx*     loadSoundWavFx(std::string_view name);
+    // names of sound effects, looked up since cache epoch
+    auto         usedSoundFx(uint32_t epoch) -> std::vector<std::string>;
 
     auto         loadParticleFx(std::string_view name, bool relaxed=false) -> const ParticleFx*;
     auto         loadParticleFx(const ParticleFx* base, const VisualFx::Key* key) -> const ParticleFx*;
@@ -90,6 +92,15 @@ class Gothic final {
     bool         doFrate() const { return showFpsCounter; }
     void         setFRate(bool f) { showFpsCounter = f; }
 
+    bool         doParallelNpc() const { return parallelNpc; }
+    void         setParallelNpc(bool p) { parallelNpc = p; }
+
+    bool         doAnimLod() const { return animLod; }
+    void         setAnimLod(bool l) { animLod = l; }
+
+    bool         doPoseCache() const { return poseCache; }
+    void         setPoseCache(bool c) { poseCache = c; }
+
     bool         doRayQuery() const;
     bool         doMeshShading() const;
 
@@ -163,6 +174,9 @@ class Gothic final {
     bool                                    showFpsCounter = false;
     bool                                    hideFocus      = false;
     bool                                    isMeshSh       = false;
+    bool                                    parallelNpc    = true;
+    bool                                    animLod        = true;
+    bool                                    poseCache      = true;
     std::string                             wrldDef, plDef;
 
     std::unique_ptr<IniFile>                defaults;
@@ -189,6 +203,7 @@ class Gothic final {
     Tempest::SoundDevice                    sndDev;
     std::unordered_map<std::string,SoundFx> sndFxCache;
     std::unordered_map<std::string,SoundFx> sndWavCache;
+    std::unordered_map<std::string,uint32_t> sndFxUse; // last cache epoch, effect was used in
     std::vector<Tempest::SoundEffect>       sndStorage;
 
     std::vector<std::unique_ptr<DocumentMenu::Show>> documents;
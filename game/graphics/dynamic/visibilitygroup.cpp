@@ -150,7 +150,7 @@ void VisibilityGroup::buildTree() {
   treeNode.resize(2); // dummy node + root
   buildTree(1,treeTok.data(),treeTok.data()+treeTok.size(),0);
 
-  uint8_t maxTh = Workers::maxThreads();
+  size_t  maxTh = Workers::maxThreads();
   size_t  depth = 1;
 
   if(maxTh>=8)
@@ -408,9 +408,12 @@ bool MdlVisual::setToFightMode(const WeaponState f) {
 void MdlVisual::setObjMatrix(const Tempest::Matrix4x4 &m, bool syncAttach) {
   pos = m;
   skInst->setObjectMatrix(m,syncAttach);
-  view.setPose(m,*skInst);
+  if(lodSlot.culled)
+    lodSlot.poseDirty = true; else
+    view.setPose(m,*skInst);
   if(syncAttach)
-    syncAttaches();
+    syncAttaches(); else
+    lodSlot.moved = true;
   }
 
 void MdlVisual::setHeadRotation(float dx, float dz) {
@@ -464,7 +467,7 @@ bool MdlVisual::isUsingTorch() const {
   return torch.view!=nullptr;
   }
 
-bool MdlVisual::updateAnimation(Npc* npc, World& world, uint64_t dt) {
+bool MdlVisual::updateAnimation(Npc* npc, World& world, uint64_t dt, AnimLod* lod) {
   Pose&    pose      = *skInst;
   uint64_t tickCount = world.tickCount();
   auto     pos3      = Vec3{pos.at(3,0), pos.at(3,1), pos.at(3,2)};
@@ -473,6 +476,7 @@ bool MdlVisual::updateAnimation(Npc* npc, World& world, uint64_t dt) {
     pose.processSfx(*npc,tickCount);
   if(world.isInPfxRange(pos3))
     pose.processPfx(*this,world,tickCount);
+  pose.setFxBarrier(tickCount);
 
   for(size_t i=0;i<effects.size();) {
     if(effects[i].timeUntil<tickCount) {
@@ -486,11 +490,40 @@ bool MdlVisual::updateAnimation(Npc* npc, World& world, uint64_t dt) {
 
   solver.update(tickCount);
   pose.setObjectMatrix(pos,false);
-  const bool changed = pose.update(tickCount);
 
-  if(changed)
+  const auto lvl    = (lod==nullptr ? AnimLod::L_Full : lod->level(pos3,npc!=nullptr && npc->isPlayer()));
+  const bool culled = (lvl==AnimLod::L_Culled);
+  const bool moved  = lodSlot.moved;
+  lodSlot.culled = culled;
+  lodSlot.moved  = false;
+  pose.setLerp(lvl==AnimLod::L_Reduced || lvl==AnimLod::L_Far);
+
+  if(lod!=nullptr && !AnimLod::isDue(lvl,lodSlot,tickCount)) {
+    const auto t0     = std::chrono::steady_clock::now();
+    const bool lerped = pose.updateLerp(tickCount);
+    if(lerped)
+      view.setPose(pos,pose);
+    lod->commit(lvl,false,false,std::chrono::steady_clock::now()-t0);
+    return lerped || moved;
+    }
+
+  const auto t0      = std::chrono::steady_clock::now();
+  const bool changed = pose.update(tickCount,&world.poseCache()) || moved;
+  lodSlot.lastEval = tickCount;
+
+  // culled: bones are still valid for gameplay, but not uploaded to gpu
+  const bool upload  = !culled && (changed || lodSlot.poseDirty);
+  if(upload) {
     view.setPose(pos,pose);
-  return changed;
+    lodSlot.poseDirty = false;
+    }
+  else if(culled) {
+    lodSlot.poseDirty |= changed;
+    }
+
+  if(lod!=nullptr)
+    lod->commit(lvl,true,culled && changed,std::chrono::steady_clock::now()-t0);
+  return changed || upload;
   }
 
 void MdlVisual::processLayers(World& world) {
@@ -717,6 +750,8 @@ bool MdlVisual::startAnim(Npc &npc, WeaponState st) {
 
   if(st==fgtMode)
     return true;
+  // drawing takes a while: enough to load attack and parade animations
+  solver.warmup(st);
   const Animation::Sequence *sq = solver.solveAnim(st,fgtMode,run);
   if(sq==nullptr)
     return false;
@@ -5,6 +5,7 @@
 #include "graphics/mesh/animationsolver.h"
 #include "graphics/pfx/pfxobjects.h"
 #include "game/constants.h"
+#include "world/animlod.h"
 #include "meshobjects.h"
 #include "effect.h"
 
@@ -72,7 +73,7 @@ class MdlVisual final {
     bool                           isUsingTorch() const;
 
     const Pose&                    pose() const { return *skInst; }
-    bool                           updateAnimation(Npc* npc, World& world, uint64_t dt);
+    bool                           updateAnimation(Npc* npc, World& world, uint64_t dt, AnimLod* lod = nullptr);
     void                           processLayers  (World& world);
     bool                           processEvents(World& world, uint64_t &barrier, Animation::EvCount &ev);
     auto                           mapBone(const size_t boneId) const -> Tempest::Vec3;
@@ -169,5 +170,6 @@ class MdlVisual final {
     WeaponState                    fgtMode=WeaponState::NoWeapon;
     AnimationSolver                solver;
     std::unique_ptr<Pose>          skInst;
+    AnimLod::Slot                  lodSlot;
   };
 
@@ -2,7 +2,10 @@
 
 #include <Tempest/Log>
 #include <cctype>
+#include <chrono>
+#include <unordered_set>
 
+#include "graphics/mesh/assetcache.h"
 #include "utils/string_frm.h"
 #include "world/objects/npc.h"
 #include "world/world.h"
@@ -10,6 +13,10 @@
 
 using namespace Tempest;
 
+static std::atomic<bool>     lazyLoad{false};
+static std::atomic<uint32_t> lazyLoads{0};
+static std::atomic<uint64_t> lazyLoadUs{0};
+
 static void setupTime(std::vector<uint64_t>& t0,const std::vector<int32_t>& inp,float fps){
   t0.resize(inp.size());
   for(size_t i=0;i<inp.size();++i){
@@ -17,6 +24,25 @@ static void setupTime(std::vector<uint64_t>& t0,const std::vector<int32_t>& inp,
     }
   }
 
+static void setSamples(Animation::AnimData& d, AssetCache::AnimSamples&& p) {
+  d.fpsRate   = p.fps;
+  d.numFrames = p.numFrames;
+  d.nodeIndex = std::move(p.nodeIndex);
+  d.samples   = std::move(p.samples);
+
+  d.setupMoveTr();
+  if(AnimPack::isEnabled())
+    d.pack();
+  }
+
+static bool hasDefWindow(const Animation::AnimData& d) {
+  // same as !defWindow.empty(), but doesn't require samples to be loaded
+  for(auto& e:d.events)
+    if(e.type==phoenix::mds::event_tag_type::window && !e.frames.empty())
+      return true;
+  return false;
+  }
+
 static uint64_t frameClamp(int32_t frame,uint32_t first,uint32_t numFrames,uint32_t last) {
   if(frame<int(first))
     return 0;
@@ -31,13 +57,13 @@ Animation::Animation(phoenix::model_script &p, std::string_view name, const bool
   ref = std::move(p.aliases);
 
   for(auto& ani : p.animations) {
-    auto& data = loadMAN(ani, std::string(name) + '-' + ani.name + ".MAN");
-    data.data->sfx = std::move(ani.sfx);
-    data.data->gfx = std::move(ani.sfx_ground);
-    data.data->pfx = std::move(ani.pfx);
-    data.data->pfxStop = std::move(ani.pfx_stop);
-    data.data->events = std::move(ani.events);
-    data.data->mmStartAni = std::move(ani.morph);
+    auto& data = *loadMAN(ani, std::string(name) + '-' + ani.name + ".MAN").data.get();
+    data.sfx = std::move(ani.sfx);
+    data.gfx = std::move(ani.sfx_ground);
+    data.pfx = std::move(ani.pfx);
+    data.pfxStop = std::move(ani.pfx_stop);
+    data.events = std::move(ani.events);
+    data.mmStartAni = std::move(ani.morph);
     }
 
   for(auto& co : p.combinations) {
@@ -73,6 +99,12 @@ Animation::Animation(phoenix::model_script &p, std::string_view name, const bool
   meshDef = std::move(p.skeleton);
 
   setupIndex();
+
+  if(AnimPack::isEnabled() && !isLazyLoad()) {
+    auto st = sampleStats();
+    Log::i("animation \"",name,"\": ",unsigned(st.sequences)," sequences, samples ",unsigned(st.rawBytes/1024),
+           " KiB -> ",unsigned(st.bytes/1024)," KiB packed");
+    }
   }
 
 const Animation::Sequence* Animation::sequence(std::string_view name) const {
@@ -103,19 +135,106 @@ std::string_view Animation::defaultMesh() const {
   return "";
   }
 
+size_t Animation::memoryUsage() const {
+  std::unordered_set<const AnimData*> unique;
+  size_t ret = sequences.size()*sizeof(Sequence);
+  for(auto& i:sequences) {
+    auto d = i.data.get();
+    if(d==nullptr || !d->isLoaded() || !unique.insert(d).second)
+      continue;
+    ret += d->memoryUsage();
+    }
+  return ret;
+  }
+
+Animation::SampleStats Animation::sampleStats() const {
+  std::unordered_set<const AnimData*> unique;
+  SampleStats st;
+  for(auto& i:sequences) {
+    auto d = i.data.get();
+    if(d==nullptr || !d->isLoaded() || !unique.insert(d).second)
+      continue;
+    st.sequences++;
+    st.rawBytes += d->numSamples()*sizeof(phoenix::animation_sample);
+    st.bytes    += d->samples.size()*sizeof(phoenix::animation_sample) + d->packed.memoryUsage();
+    }
+  return st;
+  }
+
+void Animation::setLazyLoad(bool e) {
+  lazyLoad.store(e);
+  }
+
+bool Animation::isLazyLoad() {
+  return lazyLoad.load(std::memory_order_relaxed);
+  }
+
+Animation::LoadStats Animation::loadStats() {
+  LoadStats st;
+  st.loads  = lazyLoads .load(std::memory_order_relaxed);
+  st.loadUs = lazyLoadUs.load(std::memory_order_relaxed);
+  return st;
+  }
+
+void Animation::setLoadListener(LoadListener f) {
+  auto l = std::make_shared<const LoadListener>(std::move(f));
+  for(auto& i:sequences) {
+    auto d = i.data.get();
+    if(d!=nullptr && !d->isLoaded())
+      d->onLoad = l;
+    }
+  }
+
+Workers::Task Animation::warmup(std::string_view tag) const {
+  return implWarmup([tag](std::string_view name) {
+    return name.find(tag)!=std::string_view::npos;
+    });
+  }
+
+Workers::Task Animation::warmupExcept(std::span<const char* const> tags) const {
+  return implWarmup([tags](std::string_view name) {
+    for(auto t:tags)
+      if(name.find(t)!=std::string_view::npos)
+        return false;
+    return true;
+    });
+  }
+
+template<class Pred>
+Workers::Task Animation::implWarmup(const Pred& pred) const {
+  std::vector<std::shared_ptr<AnimData>> pending;
+  for(auto& i:sequences) {
+    auto& d = i.data.ptr;
+    // queued flag goes first: repeated warm-ups of shared model skip name tests
+    if(d==nullptr || d->queued.load(std::memory_order_relaxed) || d->isLoaded() || !pred(i.name))
+      continue;
+    if(!d->queued.exchange(true))
+      pending.push_back(d);
+    }
+  if(pending.empty())
+    return Workers::Task();
+  // data is owned by the task: Animation itself may be evicted from cache meanwhile
+  return Workers::async([pending=std::move(pending)]() {
+    for(auto& i:pending)
+      i->load();
+    });
+  }
+
 Animation::Sequence& Animation::loadMAN(const phoenix::mds::animation& hdr, std::string_view name) {
   sequences.emplace_back(hdr,name);
   auto& ret = sequences.back();
   if(ret.data==nullptr) {
-    ret.data = std::make_shared<AnimData>();
+    ret.data = DataRef(std::make_shared<AnimData>());
     Log::e("unable to load animation sequence: \"",name,"\"");
     }
   return ret;
   }
 
 void Animation::setupIndex() {
+  // lazy sequences set up events on load: frame timings depend on fps of MAN file
   for(auto& sq:sequences)
-    sq.data->setupEvents(sq.data->fpsRate);
+    if(sq.data.get()->source==nullptr)
+      sq.data.get()->load();
 
   for(auto& r:ref) {
     Sequence ani;
@@ -162,7 +281,7 @@ void Animation::setupIndex() {
   for(auto& i:sequences) {
     if((i.next==i.askName && !i.next.empty()) || i.next==i.name)
       i.animCls = Loop;
-    if(!i.data->defWindow.empty()) {
+    if(hasDefWindow(*i.data.get())) {
       i.animCls = Transition;
       i.next    = "";
       }
@@ -185,14 +304,11 @@ void Animation::setupIndex() {
 
 
 Animation::Sequence::Sequence(const phoenix::mds::animation& hdr, std::string_view fname) {
-  const phoenix::vdf_entry* entry = Resources::vdfsIndex().find_entry(fname);
+  const phoenix::vdf_entry* entry = Resources::findFile(fname);
   if(entry==nullptr)
     return;
 
-  phoenix::buffer reader = entry->open();
-  auto p                 = phoenix::animation::parse(reader);
-
-  data = std::make_shared<AnimData>();
+  data = DataRef(std::make_shared<AnimData>());
   askName    = hdr.name;
   layer      = hdr.layer;
   flags      = hdr.flags;
@@ -201,18 +317,21 @@ Animation::Sequence::Sequence(const phoenix::mds::animation& hdr, std::string_vi
   next       = hdr.next;
   reverse    = hdr.direction != phoenix::mds::animation_direction::forward;
 
-  data->firstFrame = uint32_t(hdr.first_frame);
-  data->lastFrame  = uint32_t(hdr.last_frame);
+  auto& d = *data.get();
+  d.firstFrame = uint32_t(hdr.first_frame);
+  d.lastFrame  = uint32_t(hdr.last_frame);
 
+  if(isLazyLoad()) {
+    // MAN header repeats name and layer of MDS entry
+    name     = hdr.name;
+    d.source = entry;
+    return;
+    }
 
-  name = p.name;
+  auto p = AssetCache::animation(*entry);
+  name  = p.name;
   layer = p.layer;
-  data->fpsRate = p.fps;
-  data->numFrames = p.frame_count;
-  data->nodeIndex = p.node_indices;
-  data->samples = p.samples;
-
-  setupMoveTr();
+  setSamples(d,std::move(p));
   }
 
 bool Animation::Sequence::isFinished(uint64_t now, uint64_t sTime, uint16_t comboLen) const {
@@ -525,10 +644,6 @@ void Animation::Sequence::schemeName(char scheme[64]) const {
     }
   }
 
-void Animation::Sequence::setupMoveTr() {
-  data->setupMoveTr();
-  }
-
 void Animation::AnimData::setupMoveTr() {
   size_t sz = nodeIndex.size();
   if(sz==0)
@@ -568,6 +683,55 @@ void Animation::AnimData::setupMoveTr() {
     }
   }
 
+void Animation::AnimData::implLoad() {
+  std::call_once(once,[this]() {
+    if(source!=nullptr) {
+      const auto time0 = std::chrono::steady_clock::now();
+      try {
+        setSamples(*this,AssetCache::animation(*source));
+        }
+      catch(const std::exception& e) {
+        Log::e("unable to load animation sequence: \"",source->name,"\" (",e.what(),")");
+        }
+      const auto dt = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-time0);
+      lazyLoads .fetch_add(1,std::memory_order_relaxed);
+      lazyLoadUs.fetch_add(uint64_t(dt.count()),std::memory_order_relaxed);
+      }
+    setupEvents(fpsRate);
+    loaded.store(true,std::memory_order_release);
+    if(onLoad!=nullptr)
+      (*onLoad)(memoryUsage());
+    });
+  }
+
+void Animation::AnimData::pack() {
+  AnimPack pk(samples,nodeIndex.size());
+  if(pk.isEmpty())
+    return;
+  packed  = std::move(pk);
+  samples = std::vector<phoenix::animation_sample>();
+  }
+
+size_t Animation::AnimData::numSamples() const {
+  if(!packed.isEmpty())
+    return packed.size();
+  return samples.size();
+  }
+
+size_t Animation::AnimData::memoryUsage() const {
+  return samples.size()  *sizeof(phoenix::animation_sample) +
+         packed.memoryUsage() +
+         nodeIndex.size()*sizeof(uint32_t) +
+         tr.size()       *sizeof(Tempest::Vec3);
+  }
+
+const phoenix::animation_sample* Animation::AnimData::frame(size_t id, phoenix::animation_sample* buf, size_t n) const {
+  if(packed.isEmpty())
+    return &samples[id*nodeIndex.size()];
+  packed.decode(buf,id,n);
+  return buf;
+  }
+
 void Animation::AnimData::setupEvents(float fpsRate) {
   if(fpsRate<=0.f)
     return;
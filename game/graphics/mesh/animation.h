@@ -2,9 +2,17 @@
 
 #include <phoenix/model_script.hh>
 #include <phoenix/animation.hh>
+#include <phoenix/vdfs.hh>
 
 #include <Tempest/Vec>
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <span>
+
+#include "animpack.h"
+#include "utils/workers.h"
 
 class Npc;
 class MdlVisual;
@@ -38,11 +46,14 @@ class Animation final {
       std::vector<EvMorph> morph;
       };
 
+    using LoadListener = std::function<void(size_t bytes)>;
+
     struct AnimData final {
       Tempest::Vec3                               translate={};
       Tempest::Vec3                               moveTr={};
 
-      std::vector<phoenix::animation_sample>      samples;
+      std::vector<phoenix::animation_sample>      samples;   // empty, if packed
+      AnimPack                                    packed;
       std::vector<uint32_t>                       nodeIndex;
       std::vector<Tempest::Vec3>                  tr;
       bool                                        hasMoveTr=false;
@@ -65,8 +76,50 @@ class Animation final {
       std::vector<uint64_t>                       defParFrame;
       std::vector<uint64_t>                       defWindow;
 
+      // MAN file, that is not read yet; samples and frame timings are valid after load()
+      const phoenix::vdf_entry*                   source = nullptr;
+      // told size of samples, once they are read
+      std::shared_ptr<const LoadListener>         onLoad;
+
+      void                                        load() { if(!loaded.load(std::memory_order_acquire)) implLoad(); }
+      bool                                        isLoaded() const { return loaded.load(std::memory_order_acquire); }
+
       void                                        setupMoveTr();
       void                                        setupEvents(float fpsRate);
+      void                                        pack();
+
+      size_t                                      numSamples() const;
+      size_t                                      memoryUsage() const;
+      // first `n` tracks of frame `id`: decoded to `buf`, if samples are packed
+      auto                                        frame(size_t id, phoenix::animation_sample* buf, size_t n) const -> const phoenix::animation_sample*;
+
+      private:
+        void                                      implLoad();
+
+        std::once_flag                            once;
+        std::atomic<bool>                         loaded{false};
+        std::atomic<bool>                         queued{false}; // scheduled for warm-up
+      friend class Animation;
+      };
+
+    // shared AnimData, that is loaded on first access
+    class DataRef final {
+      public:
+        DataRef() = default;
+        DataRef(std::shared_ptr<AnimData> d):ptr(std::move(d)){}
+
+        AnimData* operator -> () const { return load(); }
+        AnimData& operator *  () const { return *load(); }
+        // as is, without loading
+        AnimData* get() const { return ptr.get(); }
+
+        bool      operator == (std::nullptr_t) const { return ptr==nullptr; }
+
+      private:
+        AnimData* load() const { if(ptr!=nullptr) ptr->load(); return ptr.get(); }
+
+        std::shared_ptr<AnimData> ptr;
+      friend class Animation;
       };
 
     struct Sequence final {
@@ -109,10 +162,9 @@ class Animation final {
       const Animation*                       owner   = nullptr;
 
       std::vector<const Sequence*>           comb;
-      std::shared_ptr<AnimData>              data;
+      DataRef                                data;
 
       private:
-        void                                 setupMoveTr();
         static void                          processEvent(const phoenix::mds::event_tag& e, EvCount& ev, uint64_t time);
         bool                                 extractFrames(uint64_t &frameA, uint64_t &frameB, bool &invert, uint64_t barrier, uint64_t sTime, uint64_t now) const;
       };
@@ -124,8 +176,36 @@ class Animation final {
     const Sequence*    sequenceAsc(std::string_view name) const;
     void               debug() const;
     std::string_view   defaultMesh() const;
+    struct SampleStats final {
+      size_t sequences = 0; // with unique data
+      size_t rawBytes  = 0; // as float samples
+      size_t bytes     = 0; // as stored
+      };
+
+    struct LoadStats final {
+      uint32_t loads  = 0; // sequences, loaded on first use or by warm-up
+      uint64_t loadUs = 0;
+      };
+
+    // size of loaded animation samples; aliases share data with original sequence
+    size_t             memoryUsage() const;
+    SampleStats        sampleStats() const;
+
+    // samples are read on first use of sequence, instead of Animation constructor
+    static void        setLazyLoad(bool e);
+    static bool        isLazyLoad();
+    static LoadStats   loadStats();
+    // `f(bytes)` is called for every sequence, loaded after this call; may be called after Animation is destroyed
+    void               setLoadListener(LoadListener f);
+
+    // load sequences, with `tag` in name, on worker thread
+    Workers::Task      warmup(std::string_view tag) const;
+    // same, for sequences with none of `tags` in name
+    Workers::Task      warmupExcept(std::span<const char* const> tags) const;
 
   private:
+    template<class Pred>
+    Workers::Task      implWarmup(const Pred& pred) const;
     Sequence&          loadMAN(const phoenix::mds::animation& hdr, std::string_view name);
     void               setupIndex();
 
@@ -10,6 +10,16 @@
 
 using namespace Tempest;
 
+static const char* weaponTag[] = {
+  "",
+  "FIST",
+  "1H",
+  "2H",
+  "BOW",
+  "CBOW",
+  "MAG"
+  };
+
 AnimationSolver::AnimationSolver() {
   }
 
@@ -44,6 +54,9 @@ void AnimationSolver::load(Serialize &fin) {
 void AnimationSolver::setSkeleton(const Skeleton *sk) {
   baseSk = sk;
   invalidateCache();
+  // sequences without weapon are used right away: read them on worker, not on first pose update
+  if(sk!=nullptr && sk->animation()!=nullptr)
+    sk->animation()->warmupExcept(std::span(weaponTag).subspan(1));
   }
 
 bool AnimationSolver::hasOverlay(const Skeleton* sk) const {
@@ -61,6 +74,9 @@ void AnimationSolver::addOverlay(const Skeleton* sk,uint64_t time) {
   ov.time     = time;
   overlay.push_back(ov);
   invalidateCache();
+  // overlays are small and used at once: whole set is read ahead
+  if(sk->animation()!=nullptr)
+    sk->animation()->warmup("");
   }
 
 void AnimationSolver::delOverlay(std::string_view sk) {
@@ -362,17 +378,8 @@ const Animation::Sequence* AnimationSolver::solveFrm(std::string_view fview, Wea
   char format[256] = {};
   std::snprintf(format,sizeof(format),"%.*s",int(fview.size()),fview.data());
 
-  static const char* weapon[] = {
-    "",
-    "FIST",
-    "1H",
-    "2H",
-    "BOW",
-    "CBOW",
-    "MAG"
-    };
   char name[128]={};
-  std::snprintf(name,sizeof(name),format,weapon[int(st)],weapon[int(st)]);
+  std::snprintf(name,sizeof(name),format,weaponTag[int(st)],weaponTag[int(st)]);
   if(auto ret=solveFrm(name))
     return ret;
   std::snprintf(name,sizeof(name),format,"");
@@ -417,6 +424,17 @@ const Animation::Sequence* AnimationSolver::solveNext(const Animation::Sequence&
   return baseSk ? baseSk->sequence(name) : nullptr;
   }
 
+void AnimationSolver::warmup(WeaponState st) const {
+  std::string_view tag = weaponTag[int(st)];
+  if(tag.empty())
+    return;
+  for(auto& i:overlay)
+    if(i.skeleton!=nullptr && i.skeleton->animation()!=nullptr)
+      i.skeleton->animation()->warmup(tag);
+  if(baseSk!=nullptr && baseSk->animation()!=nullptr)
+    baseSk->animation()->warmup(tag);
+  }
+
 const Animation::Sequence *AnimationSolver::solveFrm(std::string_view name) const {
   if(name.empty())
     return nullptr;
@@ -89,6 +89,9 @@ class AnimationSolver final {
     const Animation::Sequence*     solveAnim(WeaponState st, WeaponState cur, bool run) const;
     const Animation::Sequence*     solveAnim(Interactive *inter, Anim a, const Pose &pose) const;
 
+    // start loading fight animations of weapon state, before they are needed
+    void                           warmup(WeaponState st) const;
+
   private:
     const Animation::Sequence*     solveFrm    (std::string_view format, WeaponState st) const;
 
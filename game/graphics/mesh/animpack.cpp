@@ -0,0 +1,165 @@
+#include "animpack.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+static std::atomic<bool> enabled{false};
+
+static constexpr uint32_t maxRot   = 0x7FFF;
+static constexpr uint32_t maxPos   = 0xFFFF;
+static constexpr float    sqrt2    = 1.41421356f;
+// below that range position track is considered constant, in centimeters
+static constexpr float    posEps   = 1e-3f;
+// components, that are stored, for each index of dropped one
+static constexpr uint8_t  rotSlot[4][3] = {{1,2,3},{0,2,3},{0,1,3},{0,1,2}};
+
+AnimPack::AnimPack(const std::vector<phoenix::animation_sample>& samples, size_t tracks) {
+  if(tracks==0 || tracks>0xFFFF || samples.size()<tracks || samples.size()%tracks!=0)
+    return;
+
+  const size_t frames = samples.size()/tracks;
+  base.assign(samples.begin(),samples.begin()+ptrdiff_t(tracks));
+
+  std::vector<Rot> code(samples.size());
+  for(size_t i=0; i<samples.size(); ++i)
+    code[i] = packRot(samples[i]);
+
+  for(size_t t=0; t<tracks; ++t) {
+    bool  rotConst = true;
+    float pMin[3]  = {base[t].position.x, base[t].position.y, base[t].position.z};
+    float pMax[3]  = {pMin[0], pMin[1], pMin[2]};
+    for(size_t f=1; f<frames; ++f) {
+      auto& a = code[t];
+      auto& b = code[f*tracks+t];
+      rotConst &= (a.v[0]==b.v[0] && a.v[1]==b.v[1] && a.v[2]==b.v[2]);
+
+      auto& p = samples[f*tracks+t].position;
+      const float v[3] = {p.x, p.y, p.z};
+      for(int c=0; c<3; ++c) {
+        pMin[c] = std::min(pMin[c],v[c]);
+        pMax[c] = std::max(pMax[c],v[c]);
+        }
+      }
+
+    if(!rotConst)
+      rotTrack.push_back(uint16_t(t));
+
+    bool posConst = true;
+    for(int c=0; c<3; ++c)
+      posConst &= (pMax[c]-pMin[c]<=posEps);
+    if(!posConst) {
+      PosRange rg;
+      for(int c=0; c<3; ++c) {
+        rg.min  [c] = pMin[c];
+        rg.scale[c] = (pMax[c]-pMin[c])/float(maxPos);
+        }
+      posTrack.push_back(uint16_t(t));
+      posRange.push_back(rg);
+      }
+    }
+
+  rot.reserve(rotTrack.size()*frames);
+  pos.reserve(posTrack.size()*frames);
+  for(size_t f=0; f<frames; ++f) {
+    for(auto t:rotTrack)
+      rot.push_back(code[f*tracks+t]);
+    for(size_t i=0; i<posTrack.size(); ++i) {
+      auto& rg = posRange[i];
+      auto& p  = samples[f*tracks+posTrack[i]].position;
+      const float v[3] = {p.x, p.y, p.z};
+      Pos   q;
+      for(int c=0; c<3; ++c) {
+        if(rg.scale[c]>0)
+          q.v[c] = uint16_t(std::min<long>(std::lround((v[c]-rg.min[c])/rg.scale[c]),long(maxPos)));
+        }
+      pos.push_back(q);
+      }
+    }
+
+  numTracks = tracks;
+  numFrames = frames;
+  }
+
+void AnimPack::setEnabled(bool e) {
+  enabled.store(e);
+  }
+
+bool AnimPack::isEnabled() {
+  return enabled.load(std::memory_order_relaxed);
+  }
+
+size_t AnimPack::memoryUsage() const {
+  return base.size()    *sizeof(phoenix::animation_sample) +
+         rotTrack.size()*sizeof(uint16_t) + rot.size()*sizeof(Rot) +
+         posTrack.size()*sizeof(uint16_t) + posRange.size()*sizeof(PosRange) + pos.size()*sizeof(Pos);
+  }
+
+void AnimPack::decode(phoenix::animation_sample* dst, size_t frame, size_t n) const {
+  n     = std::min(n,numTracks);
+  frame = std::min(frame,numFrames-1);
+  std::copy(base.begin(),base.begin()+ptrdiff_t(n),dst);
+
+  const size_t nr = rotTrack.size();
+  const Rot*   r  = rot.data()+frame*nr;
+  for(size_t i=0; i<nr; ++i) {
+    const size_t t = rotTrack[i];
+    if(t>=n)
+      break;
+    unpackRot(dst[t],r[i]);
+    }
+
+  const size_t np = posTrack.size();
+  const Pos*   p  = pos.data()+frame*np;
+  for(size_t i=0; i<np; ++i) {
+    const size_t t = posTrack[i];
+    if(t>=n)
+      break;
+    auto& rg = posRange[i];
+    dst[t].position.x = rg.min[0] + float(p[i].v[0])*rg.scale[0];
+    dst[t].position.y = rg.min[1] + float(p[i].v[1])*rg.scale[1];
+    dst[t].position.z = rg.min[2] + float(p[i].v[2])*rg.scale[2];
+    }
+  }
+
+AnimPack::Rot AnimPack::packRot(const phoenix::animation_sample& s) {
+  float q[4] = {s.rotation.x, s.rotation.y, s.rotation.z, s.rotation.w};
+  float len  = std::sqrt(q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]);
+  if(len<=0) {
+    q[0] = q[1] = q[2] = 0;
+    q[3] = len = 1;
+    }
+
+  uint32_t big = 0;
+  for(uint32_t i=1; i<4; ++i)
+    if(std::abs(q[i])>std::abs(q[big]))
+      big = i;
+  // q and -q are the same rotation: keep dropped component positive
+  const float k = (q[big]<0 ? -sqrt2 : sqrt2)/len;
+
+  Rot r;
+  for(int i=0; i<3; ++i) {
+    float v = std::clamp(q[rotSlot[big][i]]*k,-1.f,1.f);
+    r.v[i] = uint16_t(std::lround((v*0.5f+0.5f)*float(maxRot)));
+    }
+  r.v[0] = uint16_t(r.v[0] | ((big&1u)<<15));
+  r.v[1] = uint16_t(r.v[1] | ((big>>1)<<15));
+  return r;
+  }
+
+void AnimPack::unpackRot(phoenix::animation_sample& s, const Rot& r) {
+  const uint32_t big = uint32_t(r.v[0]>>15) | (uint32_t(r.v[1]>>15)<<1);
+  float q[4] = {};
+  float sum  = 0;
+  for(int i=0; i<3; ++i) {
+    float v = (float(r.v[i]&maxRot)*(2.f/float(maxRot)) - 1.f)*(1.f/sqrt2);
+    q[rotSlot[big][i]] = v;
+    sum += v*v;
+    }
+  q[big] = std::sqrt(std::max(0.f,1.f-sum));
+
+  s.rotation.x = q[0];
+  s.rotation.y = q[1];
+  s.rotation.z = q[2];
+  s.rotation.w = q[3];
+  }
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <phoenix/animation.hh>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compressed samples of one animation. Rotations are stored as smallest-three quaternions, 15 bits per
+// component; positions as 16 bit fractions of per-track range. Tracks, that don't change over animation,
+// are stored once, at full precision.
+class AnimPack final {
+  public:
+    AnimPack() = default;
+    // `samples` - `numTracks` samples per frame, frame after frame
+    AnimPack(const std::vector<phoenix::animation_sample>& samples, size_t numTracks);
+
+    static void setEnabled(bool e);
+    static bool isEnabled();
+
+    bool   isEmpty()     const { return numTracks==0; }
+    size_t size()        const { return numFrames*numTracks; }
+    size_t memoryUsage() const;
+
+    // first `n` tracks of `frame`
+    void   decode(phoenix::animation_sample* dst, size_t frame, size_t n) const;
+
+  private:
+    struct Rot final {
+      uint16_t v[3] = {}; // top bits of v[0],v[1] - index of dropped component
+      };
+    struct Pos final {
+      uint16_t v[3] = {};
+      };
+    struct PosRange final {
+      float min  [3] = {};
+      float scale[3] = {};
+      };
+
+    static Rot                  packRot  (const phoenix::animation_sample& s);
+    static void                 unpackRot(phoenix::animation_sample& s, const Rot& r);
+
+    size_t                                 numTracks = 0;
+    size_t                                 numFrames = 0;
+
+    // constant tracks, animated ones are overwritten by decode
+    std::vector<phoenix::animation_sample> base;
+
+    std::vector<uint16_t>                  rotTrack;
+    std::vector<Rot>                       rot;      // frame after frame, rotTrack.size() per frame
+
+    std::vector<uint16_t>                  posTrack;
+    std::vector<PosRange>                  posRange;
+    std::vector<Pos>                       pos;      // frame after frame, posTrack.size() per frame
+  };
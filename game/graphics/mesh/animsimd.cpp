@@ -0,0 +1,340 @@
+#include "animsimd.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX__)
+#  include <immintrin.h>
+#  define ANIM_SIMD_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#  include <emmintrin.h>
+#  define ANIM_SIMD_SSE
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  include <arm_neon.h>
+#  define ANIM_SIMD_NEON
+#endif
+
+namespace {
+
+#if defined(ANIM_SIMD_AVX)
+struct Lanes {
+  using V = __m256;
+  static constexpr size_t width = 8;
+
+  static V    load  (const float* p)  { return _mm256_load_ps(p);  }
+  static void store (float* p, V v)   { _mm256_store_ps(p,v);      }
+  static V    splat (float f)         { return _mm256_set1_ps(f);  }
+  static V    add   (V a, V b)        { return _mm256_add_ps(a,b); }
+  static V    sub   (V a, V b)        { return _mm256_sub_ps(a,b); }
+  static V    mul   (V a, V b)        { return _mm256_mul_ps(a,b); }
+  static V    div   (V a, V b)        { return _mm256_div_ps(a,b); }
+  static V    sqrt  (V a)             { return _mm256_sqrt_ps(a);  }
+  static V    abs   (V a)             { return _mm256_andnot_ps(_mm256_set1_ps(-0.f),a); }
+  static V    sign  (V a)             { return _mm256_and_ps(_mm256_set1_ps(-0.f),a);    }
+  static V    flip  (V a, V sign)     { return _mm256_xor_ps(a,sign); }
+  static V    less  (V a, V b)        { return _mm256_cmp_ps(a,b,_CMP_LT_OQ); }
+  static V    select(V m, V a, V b)   { return _mm256_blendv_ps(b,a,m); }
+  };
+#elif defined(ANIM_SIMD_SSE)
+struct Lanes {
+  using V = __m128;
+  static constexpr size_t width = 4;
+
+  static V    load  (const float* p)  { return _mm_load_ps(p);  }
+  static void store (float* p, V v)   { _mm_store_ps(p,v);      }
+  static V    splat (float f)         { return _mm_set1_ps(f);  }
+  static V    add   (V a, V b)        { return _mm_add_ps(a,b); }
+  static V    sub   (V a, V b)        { return _mm_sub_ps(a,b); }
+  static V    mul   (V a, V b)        { return _mm_mul_ps(a,b); }
+  static V    div   (V a, V b)        { return _mm_div_ps(a,b); }
+  static V    sqrt  (V a)             { return _mm_sqrt_ps(a);  }
+  static V    abs   (V a)             { return _mm_andnot_ps(_mm_set1_ps(-0.f),a); }
+  static V    sign  (V a)             { return _mm_and_ps(_mm_set1_ps(-0.f),a);    }
+  static V    flip  (V a, V sign)     { return _mm_xor_ps(a,sign); }
+  static V    less  (V a, V b)        { return _mm_cmplt_ps(a,b);  }
+  static V    select(V m, V a, V b)   { return _mm_or_ps(_mm_and_ps(m,a),_mm_andnot_ps(m,b)); }
+  };
+#elif defined(ANIM_SIMD_NEON)
+struct Lanes {
+  using V = float32x4_t;
+  static constexpr size_t width = 4;
+
+  static V    load  (const float* p)  { return vld1q_f32(p);    }
+  static void store (float* p, V v)   { vst1q_f32(p,v);         }
+  static V    splat (float f)         { return vdupq_n_f32(f);  }
+  static V    add   (V a, V b)        { return vaddq_f32(a,b);  }
+  static V    sub   (V a, V b)        { return vsubq_f32(a,b);  }
+  static V    mul   (V a, V b)        { return vmulq_f32(a,b);  }
+  static V    div   (V a, V b)        { return vdivq_f32(a,b);  }
+  static V    sqrt  (V a)             { return vsqrtq_f32(a);   }
+  static V    abs   (V a)             { return vabsq_f32(a);    }
+  static V    sign  (V a)             { return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a),vdupq_n_u32(0x80000000u))); }
+  static V    flip  (V a, V sign)     { return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a),vreinterpretq_u32_f32(sign))); }
+  static V    less  (V a, V b)        { return vreinterpretq_f32_u32(vcltq_f32(a,b)); }
+  static V    select(V m, V a, V b)   { return vbslq_f32(vreinterpretq_u32_f32(m),a,b); }
+  };
+#else
+struct Lanes {
+  using V = float;
+  static constexpr size_t width = 1;
+
+  static V    load  (const float* p)  { return *p; }
+  static void store (float* p, V v)   { *p = v;    }
+  static V    splat (float f)         { return f;  }
+  static V    add   (V a, V b)        { return a+b; }
+  static V    sub   (V a, V b)        { return a-b; }
+  static V    mul   (V a, V b)        { return a*b; }
+  static V    div   (V a, V b)        { return a/b; }
+  static V    sqrt  (V a)             { return std::sqrt(a); }
+  static V    abs   (V a)             { return std::abs(a);  }
+  static V    sign  (V a)             { return std::signbit(a) ? -1.f : 1.f; }
+  static V    flip  (V a, V sign)     { return a*sign; }
+  static V    less  (V a, V b)        { return a<b ? 1.f : 0.f; }
+  static V    select(V m, V a, V b)   { return m!=0.f ? a : b; }
+  };
+#endif
+
+using V = Lanes::V;
+
+static_assert(BoneSamples::Capacity%8==0, "bone lanes must be padded to widest SIMD");
+
+struct Quat {
+  V x, y, z, w;
+  };
+
+struct Sample {
+  Quat q;
+  V    px, py, pz;
+
+  static Sample load(const BoneSamples& s, size_t i) {
+    Sample r;
+    r.q.x = Lanes::load(s.qx+i);
+    r.q.y = Lanes::load(s.qy+i);
+    r.q.z = Lanes::load(s.qz+i);
+    r.q.w = Lanes::load(s.qw+i);
+    r.px  = Lanes::load(s.px+i);
+    r.py  = Lanes::load(s.py+i);
+    r.pz  = Lanes::load(s.pz+i);
+    return r;
+    }
+
+  void store(BoneSamples& s, size_t i) const {
+    Lanes::store(s.qx+i,q.x);
+    Lanes::store(s.qy+i,q.y);
+    Lanes::store(s.qz+i,q.z);
+    Lanes::store(s.qw+i,q.w);
+    Lanes::store(s.px+i,px);
+    Lanes::store(s.py+i,py);
+    Lanes::store(s.pz+i,pz);
+    }
+  };
+
+inline V lerp(V a, V b, V t) {
+  return Lanes::add(a,Lanes::mul(Lanes::sub(b,a),t));
+  }
+
+// nlerp along shortest path, with weight corrected by cubic in t; coefficients are fitted to minimize angular error
+inline Quat slerp(const Quat& a, Quat b, V t) {
+  using L = Lanes;
+  V dot  = L::add(L::add(L::mul(a.x,b.x),L::mul(a.y,b.y)),L::add(L::mul(a.z,b.z),L::mul(a.w,b.w)));
+  V sign = L::sign(dot);
+  b.x = L::flip(b.x,sign);
+  b.y = L::flip(b.y,sign);
+  b.z = L::flip(b.z,sign);
+  b.w = L::flip(b.w,sign);
+
+  V d  = L::abs(dot);
+  V k  = L::add(L::splat(0.932175f),L::mul(d,L::add(L::splat(-1.253428f),L::mul(d,L::splat(0.328007f)))));
+  V tc = L::mul(L::mul(t,L::sub(t,L::splat(0.5f))),L::sub(t,L::splat(1.f)));
+  tc   = L::add(t,L::mul(tc,k));
+
+  Quat r;
+  r.x = lerp(a.x,b.x,tc);
+  r.y = lerp(a.y,b.y,tc);
+  r.z = lerp(a.z,b.z,tc);
+  r.w = lerp(a.w,b.w,tc);
+
+  V len = L::add(L::add(L::mul(r.x,r.x),L::mul(r.y,r.y)),L::add(L::mul(r.z,r.z),L::mul(r.w,r.w)));
+  V inv = L::div(L::splat(1.f),L::sqrt(len));
+  r.x = L::mul(r.x,inv);
+  r.y = L::mul(r.y,inv);
+  r.z = L::mul(r.z,inv);
+  r.w = L::mul(r.w,inv);
+  return r;
+  }
+
+inline Sample mix(const Sample& a, const Sample& b, V t) {
+  Sample r;
+  r.q  = slerp(a.q,b.q,t);
+  r.px = lerp(a.px,b.px,t);
+  r.py = lerp(a.py,b.py,t);
+  r.pz = lerp(a.pz,b.pz,t);
+  return r;
+  }
+
+void transpose(BoneSamples& dst, const phoenix::animation_sample* src, size_t n) {
+  for(size_t i=0; i<n; ++i)
+    dst.set(i,src[i]);
+  // padding lanes: identity, to not run into zero length
+  for(size_t i=n; i<(n+7)/8*8; ++i) {
+    dst.qx[i] = 0;
+    dst.qy[i] = 0;
+    dst.qz[i] = 0;
+    dst.qw[i] = 1;
+    dst.px[i] = 0;
+    dst.py[i] = 0;
+    dst.pz[i] = 0;
+    }
+  }
+
+}
+
+phoenix::animation_sample BoneSamples::get(size_t i) const {
+  phoenix::animation_sample s = {};
+  s.rotation.x = qx[i];
+  s.rotation.y = qy[i];
+  s.rotation.z = qz[i];
+  s.rotation.w = qw[i];
+  s.position.x = px[i];
+  s.position.y = py[i];
+  s.position.z = pz[i];
+  return s;
+  }
+
+void BoneSamples::set(size_t i, const phoenix::animation_sample& s) {
+  qx[i] = s.rotation.x;
+  qy[i] = s.rotation.y;
+  qz[i] = s.rotation.z;
+  qw[i] = s.rotation.w;
+  px[i] = s.position.x;
+  py[i] = s.position.y;
+  pz[i] = s.position.z;
+  }
+
+void BoneSamples::copy(size_t i, const BoneSamples& src, size_t srcId) {
+  qx[i] = src.qx[srcId];
+  qy[i] = src.qy[srcId];
+  qz[i] = src.qz[srcId];
+  qw[i] = src.qw[srcId];
+  px[i] = src.px[srcId];
+  py[i] = src.py[srcId];
+  pz[i] = src.pz[srcId];
+  }
+
+const char* AnimSimd::isa() {
+#if defined(ANIM_SIMD_AVX)
+  return "avx";
+#elif defined(ANIM_SIMD_SSE)
+  return "sse2";
+#elif defined(ANIM_SIMD_NEON)
+  return "neon";
+#else
+  return "scalar";
+#endif
+  }
+
+void AnimSimd::sample(BoneSamples& dst, const phoenix::animation_sample* a, const phoenix::animation_sample* b, size_t n, float t) {
+  BoneSamples sa, sb;
+  transpose(sa,a,n);
+  transpose(sb,b,n);
+
+  const V tv = Lanes::splat(t);
+  for(size_t i=0; i<n; i+=Lanes::width) {
+    auto r = mix(Sample::load(sa,i),Sample::load(sb,i),tv);
+    r.store(dst,i);
+    }
+  }
+
+void AnimSimd::blend(BoneSamples& dst, const BoneSamples& src, const float* w, size_t n) {
+  const V zero = Lanes::splat(0.f);
+  const V one  = Lanes::splat(1.f);
+  for(size_t i=0; i<n; i+=Lanes::width) {
+    const V wv   = Lanes::load(w+i);
+    const V part = Lanes::less(wv,one);
+    const V any  = Lanes::less(zero,wv);
+
+    auto a = Sample::load(dst,i);
+    auto b = Sample::load(src,i);
+    auto r = mix(a,b,wv);
+
+    r.q.x = Lanes::select(any,Lanes::select(part,r.q.x,b.q.x),a.q.x);
+    r.q.y = Lanes::select(any,Lanes::select(part,r.q.y,b.q.y),a.q.y);
+    r.q.z = Lanes::select(any,Lanes::select(part,r.q.z,b.q.z),a.q.z);
+    r.q.w = Lanes::select(any,Lanes::select(part,r.q.w,b.q.w),a.q.w);
+    r.px  = Lanes::select(any,Lanes::select(part,r.px, b.px ),a.px );
+    r.py  = Lanes::select(any,Lanes::select(part,r.py, b.py ),a.py );
+    r.pz  = Lanes::select(any,Lanes::select(part,r.pz, b.pz ),a.pz );
+    r.store(dst,i);
+    }
+  }
+
+void AnimSimd::toMatrix(Tempest::Matrix4x4* dst, const BoneSamples& s, size_t n) {
+  using L = Lanes;
+  static_assert(sizeof(Tempest::Matrix4x4)==16*sizeof(float), "Matrix4x4 is expected to be plain float[4][4]");
+
+  const V two = L::splat(2.f);
+  for(size_t i=0; i<n; i+=L::width) {
+    const V x = L::load(s.qx+i), y = L::load(s.qy+i), z = L::load(s.qz+i), w = L::load(s.qw+i);
+    const V xx = L::mul(x,x), yy = L::mul(y,y), zz = L::mul(z,z), ww = L::mul(w,w);
+    const V xy = L::mul(x,y), xz = L::mul(x,z), yz = L::mul(y,z);
+    const V wx = L::mul(w,x), wy = L::mul(w,y), wz = L::mul(w,z);
+
+    // same layout as mkMatrix(phoenix::animation_sample)
+    alignas(32) float m[12][L::width];
+    L::store(m[0], L::sub(L::add(ww,xx),L::add(yy,zz)));
+    L::store(m[1], L::mul(two,L::sub(xy,wz)));
+    L::store(m[2], L::mul(two,L::add(xz,wy)));
+    L::store(m[3], L::mul(two,L::add(xy,wz)));
+    L::store(m[4], L::sub(L::add(ww,yy),L::add(xx,zz)));
+    L::store(m[5], L::mul(two,L::sub(yz,wx)));
+    L::store(m[6], L::mul(two,L::sub(xz,wy)));
+    L::store(m[7], L::mul(two,L::add(yz,wx)));
+    L::store(m[8], L::sub(L::add(ww,zz),L::add(xx,yy)));
+    L::store(m[9], L::load(s.px+i));
+    L::store(m[10],L::load(s.py+i));
+    L::store(m[11],L::load(s.pz+i));
+
+    for(size_t r=0; r<L::width && i+r<n; ++r) {
+      float mt[16] = {
+        m[0][r], m[1][r], m[2][r],  0,
+        m[3][r], m[4][r], m[5][r],  0,
+        m[6][r], m[7][r], m[8][r],  0,
+        m[9][r], m[10][r],m[11][r], 1,
+        };
+      std::memcpy(reinterpret_cast<void*>(&dst[i+r]),mt,sizeof(mt));
+      }
+    }
+  }
+
+void AnimSimd::mul(Tempest::Matrix4x4& dst, const Tempest::Matrix4x4& a, const Tempest::Matrix4x4& b) {
+  // column-major: column j of result is sum of columns of `a`, weighted by column j of `b`
+  const float* pa = reinterpret_cast<const float*>(&a);
+  const float* pb = reinterpret_cast<const float*>(&b);
+  float        r[16];
+#if defined(ANIM_SIMD_AVX) || defined(ANIM_SIMD_SSE)
+  const __m128 a0 = _mm_loadu_ps(pa+0), a1 = _mm_loadu_ps(pa+4), a2 = _mm_loadu_ps(pa+8), a3 = _mm_loadu_ps(pa+12);
+  for(size_t j=0; j<4; ++j) {
+    const float* bj = pb+j*4;
+    __m128 v = _mm_mul_ps(a0,_mm_set1_ps(bj[0]));
+    v = _mm_add_ps(v,_mm_mul_ps(a1,_mm_set1_ps(bj[1])));
+    v = _mm_add_ps(v,_mm_mul_ps(a2,_mm_set1_ps(bj[2])));
+    v = _mm_add_ps(v,_mm_mul_ps(a3,_mm_set1_ps(bj[3])));
+    _mm_storeu_ps(r+j*4,v);
+    }
+#elif defined(ANIM_SIMD_NEON)
+  const float32x4_t a0 = vld1q_f32(pa+0), a1 = vld1q_f32(pa+4), a2 = vld1q_f32(pa+8), a3 = vld1q_f32(pa+12);
+  for(size_t j=0; j<4; ++j) {
+    const float32x4_t bj = vld1q_f32(pb+j*4);
+    float32x4_t v = vmulq_laneq_f32(a0,bj,0);
+    v = vfmaq_laneq_f32(v,a1,bj,1);
+    v = vfmaq_laneq_f32(v,a2,bj,2);
+    v = vfmaq_laneq_f32(v,a3,bj,3);
+    vst1q_f32(r+j*4,v);
+    }
+#else
+  for(size_t j=0; j<4; ++j)
+    for(size_t i=0; i<4; ++i)
+      r[j*4+i] = pa[i]*pb[j*4] + pa[4+i]*pb[j*4+1] + pa[8+i]*pb[j*4+2] + pa[12+i]*pb[j*4+3];
+#endif
+  std::memcpy(reinterpret_cast<void*>(&dst),r,sizeof(r));
+  }
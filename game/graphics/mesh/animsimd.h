@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Tempest/Matrix4x4>
+
+#include <phoenix/animation.hh>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "resources.h"
+
+// Bone samples in structure-of-arrays layout: each component is a separate lane, padded to SIMD width.
+struct BoneSamples final {
+  static constexpr size_t Capacity = Resources::MAX_NUM_SKELETAL_NODES;
+
+  alignas(32) float qx[Capacity] = {};
+  alignas(32) float qy[Capacity] = {};
+  alignas(32) float qz[Capacity] = {};
+  alignas(32) float qw[Capacity] = {};
+  alignas(32) float px[Capacity] = {};
+  alignas(32) float py[Capacity] = {};
+  alignas(32) float pz[Capacity] = {};
+
+  auto get (size_t i) const -> phoenix::animation_sample;
+  void set (size_t i, const phoenix::animation_sample& s);
+  void copy(size_t i, const BoneSamples& src, size_t srcId);
+  };
+
+// Skeletal pose kernels: AVX, SSE2 or NEON, depending on target of the build, scalar otherwise.
+// Rotations are interpolated with normalized lerp and corrected weight: deviation from slerp is below 1e-2 rad
+// for rotations far apart and below 1e-4 rad for neighbour frames of animation.
+namespace AnimSimd {
+  // instruction set of kernels: "avx", "sse2", "neon" or "scalar"
+  const char* isa();
+
+  // dst[i] = mix(a[i],b[i],t), for i<n; lanes past `n` are overwritten
+  void sample  (BoneSamples& dst, const phoenix::animation_sample* a, const phoenix::animation_sample* b, size_t n, float t);
+  // dst[i] = mix(dst[i],src[i],w[i]), for i<n: w[i]<=0 keeps dst[i], w[i]>=1 takes src[i] as is.
+  // `w` is padded to BoneSamples::Capacity
+  void blend   (BoneSamples& dst, const BoneSamples& src, const float* w, size_t n);
+  // local transforms of first `n` bones
+  void toMatrix(Tempest::Matrix4x4* dst, const BoneSamples& s, size_t n);
+  // dst = a*b, same convention as Tempest::Matrix4x4::mul
+  void mul     (Tempest::Matrix4x4& dst, const Tempest::Matrix4x4& a, const Tempest::Matrix4x4& b);
+  }
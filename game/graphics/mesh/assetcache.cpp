@@ -0,0 +1,417 @@
+#include "assetcache.h"
+
+#include <Tempest/File>
+#include <Tempest/Log>
+
+#include <phoenix/proto_mesh.hh>
+#include <phoenix/model_mesh.hh>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <thread>
+
+#include "utils/cachedir.h"
+#include "utils/cacheio.h"
+#include "gothic.h"
+
+namespace {
+
+// asset cache file layout: header, then payload of one asset
+struct AssetCacheHeader {
+  char     magic[4]  = {'O','G','A','C'};
+  uint32_t version   = 1;
+  uint32_t kind      = 0;
+  uint16_t vertSize  = sizeof(Resources::Vertex);
+  uint16_t vertASize = sizeof(Resources::VertexA);
+  uint64_t key       = 0;
+  uint64_t size      = 0; // payload size
+  uint64_t buildUs   = 0;
+  };
+
+std::atomic<bool>     enabled{false};
+std::atomic<bool>     writable{true};
+std::atomic<uint64_t> archiveStamp{0};
+
+std::atomic<uint64_t> hits{0}, misses{0}, loadUs{0}, bakeUs{0}, savedUs{0};
+
+uint64_t elapsedUs(std::chrono::steady_clock::time_point t0) {
+  auto t1 = std::chrono::steady_clock::now();
+  return uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(t1-t0).count());
+  }
+
+void fnv1a(uint64_t& hash, const void* data, size_t size) {
+  auto p = reinterpret_cast<const uint8_t*>(data);
+  for(size_t i=0; i<size; ++i) {
+    hash ^= p[i];
+    hash *= 0x100000001b3ull;
+    }
+  }
+
+}
+
+void AssetCache::setEnabled(bool e) {
+  enabled.store(e);
+  }
+
+bool AssetCache::isEnabled() {
+  return enabled.load(std::memory_order_relaxed);
+  }
+
+void AssetCache::setArchiveStamp(uint64_t stamp) {
+  archiveStamp.store(stamp);
+  }
+
+AssetCache::Stats AssetCache::stats() {
+  Stats ret;
+  ret.hits    = hits.load();
+  ret.misses  = misses.load();
+  ret.loadUs  = loadUs.load();
+  ret.bakeUs  = bakeUs.load();
+  ret.savedUs = savedUs.load();
+  return ret;
+  }
+
+std::optional<PackedMesh> AssetCache::mesh(const phoenix::vdf_entry& src) {
+  return cached<std::optional<PackedMesh>>(src,K_Mesh,bakeMesh);
+  }
+
+PackedModel AssetCache::model(const phoenix::vdf_entry& src) {
+  return cached<PackedModel>(src,K_Model,bakeModel);
+  }
+
+phoenix::model_hierarchy AssetCache::hierarchy(const phoenix::vdf_entry& src) {
+  return cached<phoenix::model_hierarchy>(src,K_Hierarchy,bakeHierarchy);
+  }
+
+AssetCache::AnimSamples AssetCache::animation(const phoenix::vdf_entry& src) {
+  return cached<AnimSamples>(src,K_Animation,bakeAnimation);
+  }
+
+std::optional<PackedMesh> AssetCache::bakeMesh(const phoenix::vdf_entry& src) {
+  auto reader = src.open();
+  auto zmsh   = phoenix::proto_mesh::parse(reader);
+  if(zmsh.sub_meshes.empty())
+    return std::nullopt;
+  return PackedMesh(zmsh,PackedMesh::PK_Visual);
+  }
+
+PackedModel AssetCache::bakeModel(const phoenix::vdf_entry& src) {
+  auto reader = src.open();
+  auto mdm    = phoenix::model_mesh::parse(reader);
+  return PackedModel(mdm);
+  }
+
+phoenix::model_hierarchy AssetCache::bakeHierarchy(const phoenix::vdf_entry& src) {
+  auto reader = src.open();
+  return phoenix::model_hierarchy::parse(reader);
+  }
+
+AssetCache::AnimSamples AssetCache::bakeAnimation(const phoenix::vdf_entry& src) {
+  auto reader = src.open();
+  auto p      = phoenix::animation::parse(reader);
+
+  AnimSamples ret;
+  ret.name      = std::move(p.name);
+  ret.layer     = p.layer;
+  ret.fps       = p.fps;
+  ret.numFrames = p.frame_count;
+  ret.nodeIndex = std::move(p.node_indices);
+  ret.samples   = std::move(p.samples);
+  return ret;
+  }
+
+template<class T, class Bake>
+T AssetCache::cached(const phoenix::vdf_entry& src, Kind kind, const Bake& bake) {
+  if(!isEnabled())
+    return bake(src);
+
+  const uint64_t k       = key(src,kind);
+  const auto     time0   = std::chrono::steady_clock::now();
+  uint64_t       buildUs = 0;
+  T              ret;
+  if(load(k,kind,ret,buildUs)) {
+    hits   .fetch_add(1,std::memory_order_relaxed);
+    loadUs .fetch_add(elapsedUs(time0),std::memory_order_relaxed);
+    savedUs.fetch_add(buildUs,std::memory_order_relaxed);
+    return ret;
+    }
+
+  ret     = bake(src);
+  buildUs = elapsedUs(time0);
+  misses.fetch_add(1,std::memory_order_relaxed);
+  bakeUs.fetch_add(buildUs,std::memory_order_relaxed);
+  save(k,kind,ret,buildUs);
+  return ret;
+  }
+
+uint64_t AssetCache::key(const phoenix::vdf_entry& src, Kind kind) {
+  // same name may come from another archive, after mods are changed: offset and size tell them apart.
+  // meshlet layout depends on mesh shading support
+  uint64_t hash  = 0xcbf29ce484222325ull;
+  uint64_t stamp = archiveStamp.load(std::memory_order_relaxed);
+  uint8_t  ms    = Gothic::inst().doMeshShading() ? 1 : 0;
+  fnv1a(hash,&stamp,sizeof(stamp));
+  fnv1a(hash,&kind,sizeof(kind));
+  fnv1a(hash,&ms,sizeof(ms));
+  fnv1a(hash,src.name.data(),src.name.size());
+  fnv1a(hash,&src.offset,sizeof(src.offset));
+  fnv1a(hash,&src.size,sizeof(src.size));
+  return hash;
+  }
+
+std::filesystem::path AssetCache::path(uint64_t key, Kind kind) {
+  static const char*                 ext[] = {"msh","mdm","mdh","man"};
+  static const std::filesystem::path dir   = CacheDir::dir("assets");
+  if(dir.empty())
+    return dir;
+  char name[64] = {};
+  std::snprintf(name,sizeof(name),"%016llx.%s",static_cast<unsigned long long>(key),ext[kind]);
+  return dir/name;
+  }
+
+template<class T>
+bool AssetCache::load(uint64_t key, Kind kind, T& out, uint64_t& buildUs) {
+  const auto dst = path(key,kind);
+  if(dst.empty())
+    return false;
+
+  std::vector<uint8_t> file;
+  try {
+    Tempest::RFile fin(dst.u16string().c_str());
+    file.resize(fin.size());
+    if(fin.read(file.data(),file.size())!=file.size())
+      return false;
+    }
+  catch(...) {
+    return false;
+    }
+
+  CacheReader rd;
+  rd.begin = file.data();
+  rd.at    = rd.begin;
+  rd.end   = rd.begin + file.size();
+
+  AssetCacheHeader ref, hdr;
+  ref.kind = kind;
+  ref.key  = key;
+  if(!rd.read(hdr) || std::memcmp(hdr.magic,ref.magic,4)!=0 || hdr.version!=ref.version || hdr.kind!=ref.kind ||
+     hdr.vertSize!=ref.vertSize || hdr.vertASize!=ref.vertASize || hdr.key!=key || hdr.size!=uint64_t(rd.end-rd.at))
+    return false;
+  if(!read(rd,out) || rd.at!=rd.end)
+    return false;
+  buildUs = hdr.buildUs;
+  return true;
+  }
+
+template<class T>
+void AssetCache::save(uint64_t key, Kind kind, const T& v, uint64_t buildUs) {
+  if(!writable.load(std::memory_order_relaxed))
+    return;
+
+  CacheWriter wr;
+  AssetCacheHeader hdr;
+  hdr.kind    = kind;
+  hdr.key     = key;
+  hdr.buildUs = buildUs;
+  wr.write(hdr);
+  write(wr,v);
+
+  const uint64_t size = wr.data.size()-sizeof(hdr);
+  std::memcpy(wr.data.data()+offsetof(AssetCacheHeader,size),&size,sizeof(size));
+
+  // written aside and renamed: loader on another thread must not observe partial file
+  const auto dst = path(key,kind);
+  if(dst.empty())
+    return;
+  char sfx[32] = {};
+  std::snprintf(sfx,sizeof(sfx),".%zx",std::hash<std::thread::id>()(std::this_thread::get_id()));
+  auto tmp = dst;
+  tmp += sfx;
+  try {
+    std::error_code ec;
+    {
+      Tempest::WFile fout(tmp.u16string().c_str());
+      fout.write(wr.data.data(),wr.data.size());
+    }
+    std::filesystem::rename(tmp,dst,ec);
+    if(ec)
+      std::filesystem::remove(tmp,ec);
+    }
+  catch(...) {
+    if(writable.exchange(false))
+      Tempest::Log::e("asset cache: unable to write cache files");
+    }
+  }
+
+void AssetCache::write(CacheWriter& wr, const phoenix::material& m) {
+  // only fields, that are used at runtime
+  wr.writeStr(m.name);
+  wr.writeStr(m.texture);
+  wr.write(m.group);
+  wr.write(m.color);
+  wr.write(m.alpha_func);
+  wr.write(m.texture_anim_fps);
+  wr.write(m.texture_anim_map_mode);
+  wr.write(m.texture_anim_map_dir);
+  wr.write(m.wave_mode);
+  wr.write(m.wave_max_amplitude);
+  wr.write(m.environment_mapping);
+  wr.write(m.environment_mapping_strength);
+  wr.write(m.disable_collision);
+  }
+
+bool AssetCache::read(CacheReader& rd, phoenix::material& m) {
+  return rd.readStr(m.name) &&
+         rd.readStr(m.texture) &&
+         rd.read(m.group) &&
+         rd.read(m.color) &&
+         rd.read(m.alpha_func) &&
+         rd.read(m.texture_anim_fps) &&
+         rd.read(m.texture_anim_map_mode) &&
+         rd.read(m.texture_anim_map_dir) &&
+         rd.read(m.wave_mode) &&
+         rd.read(m.wave_max_amplitude) &&
+         rd.read(m.environment_mapping) &&
+         rd.read(m.environment_mapping_strength) &&
+         rd.read(m.disable_collision);
+  }
+
+void AssetCache::write(CacheWriter& wr, const PackedMesh& pm) {
+  wr.writeVec(pm.vertices);
+  wr.writeVec(pm.verticesA);
+  wr.writeVec(pm.indices);
+  wr.writeVec(pm.indices8);
+  wr.write(uint32_t(pm.subMeshes.size()));
+  for(auto& i:pm.subMeshes) {
+    write(wr,i.material);
+    wr.write(uint64_t(i.iboOffset));
+    wr.write(uint64_t(i.iboLength));
+    }
+  wr.writeVec(pm.meshletBounds);
+  wr.writeVec(pm.verticesId);
+  wr.write(pm.isUsingAlphaTest);
+  wr.write(pm.mBbox);
+  }
+
+bool AssetCache::read(CacheReader& rd, PackedMesh& pm) {
+  uint32_t count = 0;
+  if(!rd.readVec(pm.vertices) || !rd.readVec(pm.verticesA) || !rd.readVec(pm.indices) || !rd.readVec(pm.indices8) ||
+     !rd.read(count) || size_t(rd.end-rd.at)<count)
+    return false;
+  pm.subMeshes.resize(count);
+  for(auto& i:pm.subMeshes) {
+    uint64_t off = 0, len = 0;
+    if(!read(rd,i.material) || !rd.read(off) || !rd.read(len) || off+len>pm.indices.size())
+      return false;
+    i.iboOffset = size_t(off);
+    i.iboLength = size_t(len);
+    }
+  return rd.readVec(pm.meshletBounds) &&
+         rd.readVec(pm.verticesId) &&
+         rd.read(pm.isUsingAlphaTest) &&
+         rd.read(pm.mBbox);
+  }
+
+void AssetCache::write(CacheWriter& wr, const std::optional<PackedMesh>& pm) {
+  wr.write(uint8_t(pm.has_value() ? 1 : 0));
+  if(pm)
+    write(wr,*pm);
+  }
+
+bool AssetCache::read(CacheReader& rd, std::optional<PackedMesh>& pm) {
+  uint8_t has = 0;
+  if(!rd.read(has))
+    return false;
+  if(has==0) {
+    pm.reset();
+    return true;
+    }
+  PackedMesh m;
+  if(!read(rd,m))
+    return false;
+  pm = std::move(m);
+  return true;
+  }
+
+void AssetCache::write(CacheWriter& wr, const PackedModel& m) {
+  wr.write(uint32_t(m.attach.size()));
+  for(auto& i:m.attach) {
+    wr.writeStr(i.first);
+    write(wr,i.second);
+    }
+  wr.write(uint32_t(m.skined.size()));
+  for(auto& i:m.skined)
+    write(wr,i);
+  }
+
+bool AssetCache::read(CacheReader& rd, PackedModel& m) {
+  uint32_t count = 0;
+  if(!rd.read(count) || size_t(rd.end-rd.at)<count)
+    return false;
+  m.attach.reserve(count);
+  for(uint32_t i=0; i<count; ++i) {
+    std::string name;
+    PackedMesh  pm;
+    if(!rd.readStr(name) || !read(rd,pm))
+      return false;
+    m.attach.emplace_back(std::move(name),std::move(pm));
+    }
+  if(!rd.read(count) || size_t(rd.end-rd.at)<count)
+    return false;
+  m.skined.reserve(count);
+  for(uint32_t i=0; i<count; ++i) {
+    PackedMesh pm;
+    if(!read(rd,pm))
+      return false;
+    m.skined.emplace_back(std::move(pm));
+    }
+  return true;
+  }
+
+void AssetCache::write(CacheWriter& wr, const phoenix::model_hierarchy& h) {
+  // only fields, that are used by Skeleton
+  wr.write(uint32_t(h.nodes.size()));
+  for(auto& i:h.nodes) {
+    wr.write(i.parent_index);
+    wr.writeStr(i.name);
+    wr.write(i.transform);
+    }
+  wr.write(h.collision_bbox);
+  wr.write(h.root_translation);
+  }
+
+bool AssetCache::read(CacheReader& rd, phoenix::model_hierarchy& h) {
+  uint32_t count = 0;
+  if(!rd.read(count) || size_t(rd.end-rd.at)<count)
+    return false;
+  h.nodes.resize(count);
+  for(auto& i:h.nodes) {
+    if(!rd.read(i.parent_index) || !rd.readStr(i.name) || !rd.read(i.transform))
+      return false;
+    }
+  return rd.read(h.collision_bbox) &&
+         rd.read(h.root_translation);
+  }
+
+void AssetCache::write(CacheWriter& wr, const AnimSamples& a) {
+  wr.writeStr(a.name);
+  wr.write(a.layer);
+  wr.write(a.fps);
+  wr.write(a.numFrames);
+  wr.writeVec(a.nodeIndex);
+  wr.writeVec(a.samples);
+  }
+
+bool AssetCache::read(CacheReader& rd, AnimSamples& a) {
+  return rd.readStr(a.name) &&
+         rd.read(a.layer) &&
+         rd.read(a.fps) &&
+         rd.read(a.numFrames) &&
+         rd.readVec(a.nodeIndex) &&
+         rd.readVec(a.samples);
+  }
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <phoenix/vdfs.hh>
+#include <phoenix/animation.hh>
+#include <phoenix/model_hierarchy.hh>
+
+#include <filesystem>
+#include <optional>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "graphics/mesh/submesh/packedmesh.h"
+
+struct CacheWriter;
+struct CacheReader;
+
+// On-disk cache of packed runtime representations: meshlets of .MRM/.MDM, skeleton hierarchies
+// and decoded animation samples. Files are keyed by source entry and timestamps of all mounted archives;
+// any mismatch falls back to parsing the source, which refreshes the file.
+class AssetCache final {
+  public:
+    // decoded samples of .MAN file
+    struct AnimSamples final {
+      std::string                            name;
+      uint32_t                               layer     = 0;
+      float                                  fps       = 0;
+      uint32_t                               numFrames = 0;
+      std::vector<uint32_t>                  nodeIndex;
+      std::vector<phoenix::animation_sample> samples;
+      };
+
+    struct Stats final {
+      uint64_t hits    = 0;
+      uint64_t misses  = 0;
+      uint64_t loadUs  = 0; // reading cache files
+      uint64_t bakeUs  = 0; // parsing and packing of source files, on miss
+      uint64_t savedUs = 0; // bake time, recorded in files, that were hit
+      };
+
+    static void     setEnabled(bool e);
+    static bool     isEnabled();
+    // names and timestamps of mounted archives: any change invalidates every cached file
+    static void     setArchiveStamp(uint64_t stamp);
+    static Stats    stats();
+
+    // cached, if enabled
+    static auto     mesh     (const phoenix::vdf_entry& src) -> std::optional<PackedMesh>;
+    static auto     model    (const phoenix::vdf_entry& src) -> PackedModel;
+    static auto     hierarchy(const phoenix::vdf_entry& src) -> phoenix::model_hierarchy;
+    static auto     animation(const phoenix::vdf_entry& src) -> AnimSamples;
+
+    // always parse source file
+    static auto     bakeMesh     (const phoenix::vdf_entry& src) -> std::optional<PackedMesh>;
+    static auto     bakeModel    (const phoenix::vdf_entry& src) -> PackedModel;
+    static auto     bakeHierarchy(const phoenix::vdf_entry& src) -> phoenix::model_hierarchy;
+    static auto     bakeAnimation(const phoenix::vdf_entry& src) -> AnimSamples;
+
+  private:
+    enum Kind : uint32_t {
+      K_Mesh,
+      K_Model,
+      K_Hierarchy,
+      K_Animation,
+      };
+
+    template<class T, class Bake>
+    static T        cached(const phoenix::vdf_entry& src, Kind kind, const Bake& bake);
+    static uint64_t key (const phoenix::vdf_entry& src, Kind kind);
+    static auto     path(uint64_t key, Kind kind) -> std::filesystem::path;
+
+    template<class T>
+    static bool     load(uint64_t key, Kind kind, T& out, uint64_t& buildUs);
+    template<class T>
+    static void     save(uint64_t key, Kind kind, const T& v, uint64_t buildUs);
+
+    static void     write(CacheWriter& wr, const phoenix::material& m);
+    static void     write(CacheWriter& wr, const PackedMesh& pm);
+    static void     write(CacheWriter& wr, const std::optional<PackedMesh>& pm);
+    static void     write(CacheWriter& wr, const PackedModel& m);
+    static void     write(CacheWriter& wr, const phoenix::model_hierarchy& h);
+    static void     write(CacheWriter& wr, const AnimSamples& a);
+
+    static bool     read(CacheReader& rd, phoenix::material& m);
+    static bool     read(CacheReader& rd, PackedMesh& pm);
+    static bool     read(CacheReader& rd, std::optional<PackedMesh>& pm);
+    static bool     read(CacheReader& rd, PackedModel& m);
+    static bool     read(CacheReader& rd, phoenix::model_hierarchy& h);
+    static bool     read(CacheReader& rd, AnimSamples& a);
+  };
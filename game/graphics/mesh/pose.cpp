@@ -10,10 +10,32 @@
 #include "skeleton.h"
 #include "animmath.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace Tempest;
 
+// frames around `frame`, given in 1/1000 of frame, and blend factor between them
+static void pickFrames(const Animation::Sequence& s, uint64_t frame, uint64_t& frameA, uint64_t& frameB, float& a) {
+  const uint64_t numFrames = s.data->numFrames;
+  frameA = frame/1000;
+  frameB = frame/1000+1; //next
+  a      = float(frame%1000)/1000.f;
+
+  if(s.animCls==Animation::Loop) {
+    frameA%=numFrames;
+    frameB%=numFrames;
+    } else {
+    frameA = std::min<uint64_t>(frameA,numFrames-1);
+    frameB = std::min<uint64_t>(frameB,numFrames-1);
+    }
+
+  if(s.reverse) {
+    frameA = numFrames-1-frameA;
+    frameB = numFrames-1-frameB;
+    }
+  }
+
 Pose::Pose() {
   lay.reserve(4);
   }
@@ -60,10 +82,10 @@ void Pose::save(Serialize &fout) {
 
   for(auto& i:hasSamples)
     fout.write(uint8_t(i));
-  for(auto& i:base)
-    fout.write(i);
-  for(auto& i:prev)
-    fout.write(i);
+  for(size_t i=0; i<BoneSamples::Capacity; ++i)
+    fout.write(base.get(i));
+  for(size_t i=0; i<BoneSamples::Capacity; ++i)
+    fout.write(prev.get(i));
   for(auto& i:tr)
     fout.write(i);
   }
@@ -79,6 +101,7 @@ void Pose::load(Serialize &fin, const AnimationSolver& solver) {
     i.seq = solver.solveFrm(name);
     }
   fin.read(lastUpdate);
+  lastFx = lastUpdate;
   fin.read(combo.bits);
   removeIf(lay,[](const Layer& l){
     return l.seq==nullptr;
@@ -97,10 +120,15 @@ void Pose::load(Serialize &fin, const AnimationSolver& solver) {
   numBones = skeleton==nullptr ? 0 : skeleton->nodes.size();
   for(auto& i:hasSamples)
     fin.read(reinterpret_cast<uint8_t&>(i));
-  for(auto& i:base)
-    fin.read(i);
-  for(auto& i:prev)
-    fin.read(i);
+  phoenix::animation_sample smp = {};
+  for(size_t i=0; i<BoneSamples::Capacity; ++i) {
+    fin.read(smp);
+    base.set(i,smp);
+    }
+  for(size_t i=0; i<BoneSamples::Capacity; ++i) {
+    fin.read(smp);
+    prev.set(i,smp);
+    }
   for(auto& i:tr)
     fin.read(i);
   }
@@ -294,7 +322,7 @@ void Pose::processLayers(AnimationSolver& solver, uint64_t tickCount) {
     }
   }
 
-bool Pose::update(uint64_t tickCount) {
+bool Pose::update(uint64_t tickCount, PoseCache* cache) {
   if(lay.size()==0) {
     const bool ret = needToUpdate;
     if(needToUpdate || lastUpdate==0)
@@ -304,32 +332,84 @@ bool Pose::update(uint64_t tickCount) {
     return ret;
     }
 
+  const PoseCache::Entry* shared = nullptr;
   if(lastUpdate!=tickCount) {
-    for(auto& i:lay) {
-      const Animation::Sequence* seq = i.seq;
-      if(0<i.comb && i.comb<=i.seq->comb.size()) {
-        if(auto sx = i.seq->comb[size_t(i.comb-1)])
-          seq = sx;
+    if(cache!=nullptr && lay.size()==1)
+      shared = sharedFrame(*cache,lay[0],tickCount);
+    if(shared!=nullptr) {
+      needToUpdate = true;
+      } else {
+      for(auto& i:lay) {
+        const Animation::Sequence* seq = i.seq;
+        if(0<i.comb && i.comb<=i.seq->comb.size()) {
+          if(auto sx = i.seq->comb[size_t(i.comb-1)])
+            seq = sx;
+          }
+        needToUpdate |= updateFrame(*seq,i.bs,lastUpdate,i.sAnim,tickCount);
         }
-      needToUpdate |= updateFrame(*seq,i.bs,lastUpdate,i.sAnim,tickCount);
       }
     lastUpdate = tickCount;
     }
 
   if(needToUpdate) {
-    mkSkeleton(pos);
+    if(lerp!=nullptr) {
+      auto& f = *lerp;
+      if(f.count==0 || f.time[1]!=tickCount) {
+        f.smp [0] = f.smp [1];
+        f.time[0] = f.time[1];
+        f.count   = uint8_t(std::min(f.count+1,2));
+        }
+      f.smp [1] = base;
+      f.time[1] = tickCount;
+      mkLerpSkeleton(tickCount);
+      } else {
+      mkSkeleton(pos,shared);
+      }
     needToUpdate = false;
     return true;
     }
   return false;
   }
 
+void Pose::setLerp(bool enable) {
+  if(enable && lerp==nullptr)
+    lerp.reset(new LerpFrames());
+  else if(!enable)
+    lerp.reset();
+  }
+
+bool Pose::updateLerp(uint64_t tickCount) {
+  if(lerp==nullptr || lerp->count<2 || lay.size()==0)
+    return false;
+  mkLerpSkeleton(tickCount);
+  return true;
+  }
+
+void Pose::mkLerpSkeleton(uint64_t tickCount) {
+  auto& f = *lerp;
+  if(f.count<2 || f.time[1]<=f.time[0]) {
+    mkSkeleton(pos);
+    return;
+    }
+
+  // pose at time[1] is reached, once next one is evaluated: no jump, when new sample comes in
+  const float a = std::min(1.f,float(tickCount-f.time[1])/float(f.time[1]-f.time[0]));
+  alignas(32) float weight[BoneSamples::Capacity] = {};
+  std::fill(weight,weight+numBones,a);
+
+  // `base` keeps state of animation, for next evaluation
+  base = f.smp[0];
+  AnimSimd::blend(base,f.smp[1],weight,numBones);
+  mkSkeleton(pos);
+  base = f.smp[1];
+  }
+
 bool Pose::updateFrame(const Animation::Sequence &s, BodyState bs,
                        uint64_t barrier, uint64_t sTime, uint64_t now) {
   auto&        d         = *s.data;
   const size_t numFrames = d.numFrames;
   const size_t idSize    = d.nodeIndex.size();
-  if(numFrames==0 || idSize==0 || d.samples.size()%idSize!=0)
+  if(numFrames==0 || idSize==0 || d.numSamples()%idSize!=0)
     return false;
   if(numFrames==1 && !needToUpdate)
     return false;
@@ -337,86 +417,153 @@ bool Pose::updateFrame(const Animation::Sequence &s, BodyState bs,
   (void)barrier;
   now = now-sTime;
 
-  float    fpsRate = d.fpsRate;
-  uint64_t frame   = uint64_t(float(now)*fpsRate);
-  uint64_t frameA  = frame/1000;
-  uint64_t frameB  = frame/1000+1; //next
-
-  float    a       = float(frame%1000)/1000.f;
-
-  if(s.animCls==Animation::Loop) {
-    frameA%=d.numFrames;
-    frameB%=d.numFrames;
-    } else {
-    frameA = std::min<uint64_t>(frameA,d.numFrames-1);
-    frameB = std::min<uint64_t>(frameB,d.numFrames-1);
-    }
+  uint64_t frameA = 0, frameB = 0;
+  float    a      = 0;
+  pickFrames(s,uint64_t(float(now)*d.fpsRate),frameA,frameB,a);
 
-  if(s.reverse) {
-    frameA = d.numFrames-1-frameA;
-    frameB = d.numFrames-1-frameB;
-    }
+  // tracks are sampled all at once, then scattered to bones and blended in with per-bone weight
+  const size_t numTracks = std::min(idSize,BoneSamples::Capacity);
+  phoenix::animation_sample bufA[BoneSamples::Capacity], bufB[BoneSamples::Capacity];
+  auto* sampleA = d.frame(size_t(frameA),bufA,numTracks);
+  auto* sampleB = d.frame(size_t(frameB),bufB,numTracks);
 
-  auto* sampleA = &d.samples[size_t(frameA*idSize)];
-  auto* sampleB = &d.samples[size_t(frameB*idSize)];
+  BoneSamples  smp, cur;
+  alignas(32) float weight[BoneSamples::Capacity] = {};
+  AnimSimd::sample(smp,sampleA,sampleB,numTracks,a);
 
-  for(size_t i=0; i<idSize; ++i) {
+  for(size_t i=0; i<numTracks; ++i) {
     size_t idx = d.nodeIndex[i];
     if(idx>=numBones)
       continue;
-    auto smp = mix(sampleA[i],sampleB[i],a);
+    cur.copy(idx,smp,i);
     if(i==0) {
       if(bs==BS_CLIMB)
-        smp.position.y = trY;
+        cur.py[idx] = trY;
       else if(s.isFly())
-        smp.position.y = d.translate.y;
+        cur.py[idx] = d.translate.y;
       }
 
     switch(hasSamples[idx]) {
       case S_None:
         hasSamples[idx] = S_Old;
-        base      [idx] = smp;
+        weight    [idx] = 1;
         break;
       case S_Old:
         hasSamples[idx] = S_Valid;
-        prev      [idx] = base[idx];
+        prev.copy(idx,base,idx);
         [[fallthrough]];
       case S_Valid:
         if(now<s.blendIn) {
-          float a2 = float(now)/float(s.blendIn);
-          base[idx] = mix(base[idx],smp,a2);
+          weight[idx] = float(now)/float(s.blendIn);
           } else {
-          prev[idx] = smp;
-          base[idx] = smp;
+          prev.copy(idx,cur,idx);
+          weight[idx] = 1;
           }
         break;
       }
     }
+  AnimSimd::blend(base,cur,weight,numBones);
   return true;
   }
 
-void Pose::mkSkeleton(const Tempest::Matrix4x4& mt) {
+const PoseCache::Entry* Pose::sharedFrame(PoseCache& cache, const Layer& l, uint64_t tickCount) {
+  // only plain loops are shared: no combination, blending or per-object root adjustment
+  if(skeleton==nullptr || !skeleton->ordered || numBones>BoneSamples::Capacity || l.comb!=0 || l.bs==BS_CLIMB)
+    return nullptr;
+  auto& s = *l.seq;
+  if(s.animCls!=Animation::Loop || tickCount-l.sAnim<s.blendIn)
+    return nullptr;
+
+  auto&        d      = *s.data;
+  const size_t idSize = d.nodeIndex.size();
+  if(d.numFrames<=1 || idSize==0 || d.numSamples()%idSize!=0)
+    return nullptr;
+
+  const uint64_t step  = 1000/PoseCache::FrameSteps;
+  const uint64_t frame = uint64_t(float(tickCount-l.sAnim)*d.fpsRate);
+  const uint64_t time  = ((frame+step/2)/step) % (d.numFrames*PoseCache::FrameSteps);
+
+  bool fill = false;
+  auto e    = cache.acquire(skeleton,&s,time,fill);
+  if(e==nullptr)
+    return nullptr;
+  if(fill) {
+    mkShared(*e,s,time*step);
+    cache.publish(*e);
+    }
+  if(!e->valid)
+    return nullptr;
+
+  // same state, as updateFrame leaves after blend-in is complete
+  base = e->samples;
+  prev = e->samples;
+  for(size_t i=0; i<numBones; ++i)
+    hasSamples[i] = (hasSamples[i]==S_None ? S_Old : S_Valid);
+  return e;
+  }
+
+void Pose::mkShared(PoseCache::Entry& e, const Animation::Sequence& s, uint64_t frame) const {
+  auto&    d      = *s.data;
+  uint64_t frameA = 0, frameB = 0;
+  float    a      = 0;
+  pickFrames(s,frame,frameA,frameB,a);
+
+  const size_t numTracks = std::min(d.nodeIndex.size(),BoneSamples::Capacity);
+  phoenix::animation_sample bufA[BoneSamples::Capacity], bufB[BoneSamples::Capacity];
+  auto* sampleA = d.frame(size_t(frameA),bufA,numTracks);
+  auto* sampleB = d.frame(size_t(frameB),bufB,numTracks);
+
+  BoneSamples smp;
+  AnimSimd::sample(smp,sampleA,sampleB,numTracks,a);
+
+  bool   covered[Resources::MAX_NUM_SKELETAL_NODES] = {};
+  size_t count = 0;
+  for(size_t i=0; i<numTracks; ++i) {
+    size_t idx = d.nodeIndex[i];
+    if(idx>=numBones)
+      continue;
+    e.samples.copy(idx,smp,i);
+    if(i==0 && s.isFly())
+      e.samples.py[idx] = d.translate.y;
+    if(!covered[idx]) {
+      covered[idx] = true;
+      ++count;
+      }
+    }
+
+  e.valid = (count==numBones);
+  if(e.valid)
+    AnimSimd::toMatrix(e.local,e.samples,numBones);
+  }
+
+void Pose::mkSkeleton(const Tempest::Matrix4x4& mt, const PoseCache::Entry* shared) {
   if(skeleton==nullptr)
     return;
   Matrix4x4 m = mt;
   m.translate(mkBaseTranslation());
   if(skeleton->ordered)
-    implMkSkeleton(m); else
+    implMkSkeleton(m,shared!=nullptr ? shared->local : nullptr); else
     implMkSkeleton(m,size_t(-1));
   }
 
-void Pose::implMkSkeleton(const Matrix4x4 &mt) {
+void Pose::implMkSkeleton(const Matrix4x4 &mt, const Matrix4x4* local) {
   if(skeleton==nullptr)
     return;
   auto& nodes      = skeleton->nodes;
   auto  BIP01_HEAD = skeleton->BIP01_HEAD;
+
+  Matrix4x4 own[Resources::MAX_NUM_SKELETAL_NODES];
+  if(local==nullptr) {
+    AnimSimd::toMatrix(own,base,numBones);
+    local = own;
+    }
   for(size_t i=0; i<nodes.size(); ++i) {
     size_t parent = nodes[i].parent;
-    auto   mat    = hasSamples[i] ? mkMatrix(base[i]) : nodes[i].tr;
+    auto&  mat    = hasSamples[i] ? local[i] : nodes[i].tr;
 
     if(parent<Resources::MAX_NUM_SKELETAL_NODES)
-      tr[i] = tr[parent]*mat; else
-      tr[i] = mt*mat;
+      AnimSimd::mul(tr[i],tr[parent],mat); else
+      AnimSimd::mul(tr[i],mt,mat);
 
     if(i==BIP01_HEAD && (headRotX!=0 || headRotY!=0)) {
       Matrix4x4& m = tr[i];
@@ -433,7 +580,7 @@ void Pose::implMkSkeleton(const Tempest::Matrix4x4 &mt, size_t parent) {
   for(size_t i=0;i<nodes.size();++i){
     if(nodes[i].parent!=parent)
       continue;
-    auto mat = hasSamples[i] ? mkMatrix(base[i]) : nodes[i].tr;
+    auto mat = hasSamples[i] ? mkMatrix(base.get(i)) : nodes[i].tr;
     tr[i] = mt*mat;
     implMkSkeleton(tr[i],i);
     }
@@ -528,12 +675,12 @@ bool Pose::hasLayerEvents(const Pose::Layer& l) {
 
 void Pose::processSfx(Npc &npc, uint64_t tickCount) {
   for(auto& i:lay)
-    i.seq->processSfx(lastUpdate,i.sAnim,tickCount,npc);
+    i.seq->processSfx(lastFx,i.sAnim,tickCount,npc);
   }
 
 void Pose::processPfx(MdlVisual& visual, World& world, uint64_t tickCount) {
   for(auto& i:lay)
-    i.seq->processPfx(lastUpdate,i.sAnim,tickCount,visual,world);
+    i.seq->processPfx(lastFx,i.sAnim,tickCount,visual,world);
   }
 
 bool Pose::processEvents(uint64_t &barrier, uint64_t now, Animation::EvCount &ev) const {
@@ -548,10 +695,21 @@ bool Pose::processEvents(uint64_t &barrier, uint64_t now, Animation::EvCount &ev
 void Pose::setObjectMatrix(const Tempest::Matrix4x4& obj, bool sync) {
   if(pos==obj)
     return;
-  pos = obj;
-  if(sync)
-    mkSkeleton(pos); else
-    needToUpdate = true;
+  if(sync) {
+    pos = obj;
+    mkSkeleton(pos);
+    return;
+    }
+  // bones follow object without evaluation: reduced-rate animation may not update for some frames
+  Matrix4x4 rebase = pos;
+  rebase.inverse();
+  rebase = obj*rebase;
+  pos    = obj;
+  needToUpdate = true;
+  if(skeleton==nullptr)
+    return;
+  for(size_t i=0; i<skeleton->nodes.size(); ++i)
+    tr[i] = rebase*tr[i];
   }
 
 Tempest::Vec3 Pose::animMoveSpeed(uint64_t tickCount, uint64_t dt) const {
@@ -843,7 +1001,7 @@ Vec3 Pose::mkBaseTranslation() {
   if(skeleton->rootNodes.size())
     id = skeleton->rootNodes[0];
   auto& nodes = skeleton->nodes;
-  auto  b0    = hasSamples[id] ? mkMatrix(base[id]) : nodes[id].tr;
+  auto  b0    = hasSamples[id] ? mkMatrix(base.get(id)) : nodes[id].tr;
 
   float dx = b0.at(3,0);
   float dy = 0;
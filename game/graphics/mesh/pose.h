@@ -7,6 +7,8 @@
 
 #include "game/constants.h"
 #include "animation.h"
+#include "animsimd.h"
+#include "posecache.h"
 #include "resources.h"
 
 class Skeleton;
@@ -47,7 +49,12 @@ class Pose final {
     void               stopAllAnim();
 
     void               setObjectMatrix(const Tempest::Matrix4x4& obj, bool sync);
-    bool               update(uint64_t tickCount);
+    // `cache` - shared samples of looping sequences, for poses without layered animations
+    bool               update(uint64_t tickCount, PoseCache* cache = nullptr);
+    // reduced-rate animation: bones are shown blended between last two evaluated poses, one update behind
+    void               setLerp(bool enable);
+    // skipped update of reduced-rate animation: rebuild bones for `tickCount`, returns false if nothing to blend
+    bool               updateLerp(uint64_t tickCount);
 
     void               processLayers(AnimationSolver &solver, uint64_t tickCount);
     bool               processEvents(uint64_t& barrier, uint64_t now, Animation::EvCount &ev) const;
@@ -55,6 +62,7 @@ class Pose final {
     Tempest::Vec3      animMoveSpeed(uint64_t tickCount, uint64_t dt) const;
     void               processSfx(Npc &npc, uint64_t tickCount);
     void               processPfx(MdlVisual& visual, World& world, uint64_t tickCount);
+    void               setFxBarrier(uint64_t tickCount) { lastFx = tickCount; }
     bool               isDefParWindow(uint64_t tickCount) const;
     bool               isDefWindow(uint64_t tickCount) const;
     bool               isDefence(uint64_t tickCount) const;
@@ -100,6 +108,12 @@ class Pose final {
       BodyState                  bs    = BS_NONE;
       };
 
+    struct LerpFrames final {
+      BoneSamples smp [2];
+      uint64_t    time[2] = {};
+      uint8_t     count   = 0;
+      };
+
     struct ComboState {
       uint16_t bits = 0;
       uint16_t len()     const { return bits & 0x7FFF; }
@@ -109,11 +123,14 @@ class Pose final {
       };
 
     auto mkBaseTranslation() -> Tempest::Vec3;
-    void mkSkeleton(const Tempest::Matrix4x4 &mt);
-    void implMkSkeleton(const Tempest::Matrix4x4 &mt);
+    void mkSkeleton(const Tempest::Matrix4x4 &mt, const PoseCache::Entry* shared = nullptr);
+    void mkLerpSkeleton(uint64_t tickCount);
+    void implMkSkeleton(const Tempest::Matrix4x4 &mt, const Tempest::Matrix4x4* local);
     void implMkSkeleton(const Tempest::Matrix4x4 &mt, size_t parent);
 
     bool updateFrame(const Animation::Sequence &s, BodyState bs, uint64_t barrier, uint64_t sTime, uint64_t now);
+    auto sharedFrame(PoseCache& cache, const Layer& l, uint64_t tickCount) -> const PoseCache::Entry*;
+    void mkShared(PoseCache::Entry& e, const Animation::Sequence& s, uint64_t frame) const;
 
     const Animation::Sequence* solveNext(const AnimationSolver& solver, const Layer& lay);
 
@@ -134,6 +151,7 @@ class Pose final {
     float                           trY=0;
     Flags                           flag=NoFlags;
     uint64_t                        lastUpdate=0;
+    uint64_t                        lastFx=0; // sfx/pfx events are processed every frame, pose may update less often
     ComboState                      combo;
     bool                            needToUpdate = true;
     uint8_t                         hasEvents = 0;
@@ -144,8 +162,8 @@ class Pose final {
 
     size_t                          numBones = 0;
     SampleStatus                    hasSamples[Resources::MAX_NUM_SKELETAL_NODES] = {};
-    phoenix::animation_sample       base      [Resources::MAX_NUM_SKELETAL_NODES] = {};
-    phoenix::animation_sample       prev      [Resources::MAX_NUM_SKELETAL_NODES] = {};
+    BoneSamples                     base, prev;
     Tempest::Matrix4x4              tr        [Resources::MAX_NUM_SKELETAL_NODES] = {};
     Tempest::Matrix4x4              pos;
+    std::unique_ptr<LerpFrames>     lerp;
   };
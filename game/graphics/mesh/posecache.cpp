@@ -0,0 +1,63 @@
+#include "posecache.h"
+
+#include <functional>
+
+void PoseCache::beginFrame(bool e) {
+  enabled = e;
+  }
+
+void PoseCache::endFrame() {
+  Stats st;
+  st.lookups = lookups.exchange(0);
+  st.hits    = hits.exchange(0);
+  // entries keep raw pointers to skeletons and sequences: they must not outlive the frame
+  for(auto& s:shard) {
+    st.entries += uint32_t(s.used);
+    s.index.clear();
+    s.used = 0;
+    }
+  enabled = false;
+  last    = st;
+  }
+
+size_t PoseCache::Hash::operator()(const Key& k) const {
+  size_t h = std::hash<const void*>()(k.sk);
+  h ^= std::hash<const void*>()(k.sq) + 0x9e3779b9 + (h<<6) + (h>>2);
+  h ^= std::hash<uint64_t>()(k.time)  + 0x9e3779b9 + (h<<6) + (h>>2);
+  return h;
+  }
+
+PoseCache::Entry* PoseCache::acquire(const Skeleton* sk, const Animation::Sequence* sq, uint64_t time, bool& fill) {
+  fill = false;
+  if(!enabled)
+    return nullptr;
+
+  lookups.fetch_add(1,std::memory_order_relaxed);
+  const Key k = {sk,sq,time};
+  auto&     s = shard[Hash()(k)%NumShards];
+
+  std::lock_guard<std::mutex> guard(s.sync);
+  if(auto it = s.index.find(k); it!=s.index.end()) {
+    Entry* e = it->second;
+    if(!e->ready.load(std::memory_order_acquire))
+      return nullptr;
+    hits.fetch_add(1,std::memory_order_relaxed);
+    return e;
+    }
+
+  if(s.used==ShardCapacity)
+    return nullptr;
+  if(s.used==s.pool.size())
+    s.pool.emplace_back(std::make_unique<Entry>());
+  Entry* e = s.pool[s.used].get();
+  s.used++;
+  e->valid = false;
+  e->ready.store(false,std::memory_order_relaxed);
+  s.index.emplace(k,e);
+  fill = true;
+  return e;
+  }
+
+void PoseCache::publish(Entry& e) {
+  e.ready.store(true,std::memory_order_release);
+  }
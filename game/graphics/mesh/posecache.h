@@ -0,0 +1,78 @@
+#pragma once
+
+#include <Tempest/Matrix4x4>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "animation.h"
+#include "animsimd.h"
+#include "resources.h"
+
+class Skeleton;
+
+// Per-frame cache of sampled poses: objects, that play same looping sequence on same skeleton at close time,
+// share bone samples and local transforms. Each object still applies own root transform and head rotation.
+class PoseCache final {
+  public:
+    // sample time is quantized to 1/FrameSteps of animation frame
+    static constexpr uint64_t FrameSteps = 4;
+
+    struct Entry final {
+      BoneSamples        samples;
+      Tempest::Matrix4x4 local[Resources::MAX_NUM_SKELETAL_NODES];
+      bool               valid = false; // sequence covers every bone of skeleton
+
+      private:
+        std::atomic<bool> ready{false};
+      friend class PoseCache;
+      };
+
+    struct Stats final {
+      uint32_t lookups = 0; // poses, that may share sample
+      uint32_t hits    = 0;
+      uint32_t entries = 0; // samples, computed this frame
+      };
+
+    void     beginFrame(bool enabled);
+    void     endFrame();
+
+    // cached entry, or new one, if `fill` is set: caller has to fill and publish it.
+    // nullptr, if cache is disabled, full, or entry is being filled by another thread
+    Entry*   acquire(const Skeleton* sk, const Animation::Sequence* sq, uint64_t time, bool& fill);
+    void     publish(Entry& e);
+
+    auto     stats() const -> const Stats& { return last; }
+
+  private:
+    struct Key final {
+      const Skeleton*            sk   = nullptr;
+      const Animation::Sequence* sq   = nullptr;
+      uint64_t                   time = 0;
+      bool operator == (const Key& k) const { return sk==k.sk && sq==k.sq && time==k.time; }
+      };
+
+    struct Hash final {
+      size_t operator()(const Key& k) const;
+      };
+
+    struct Shard final {
+      std::mutex                          sync;
+      std::unordered_map<Key,Entry*,Hash> index;
+      std::vector<std::unique_ptr<Entry>> pool; // reused from frame to frame
+      size_t                              used = 0;
+      };
+
+    static constexpr size_t NumShards      = 8;
+    static constexpr size_t ShardCapacity  = 32;
+
+    bool                  enabled = false;
+    Shard                 shard[NumShards];
+    std::atomic<uint32_t> lookups{0};
+    std::atomic<uint32_t> hits{0};
+    Stats                 last;
+  };
@@ -89,83 +89,8 @@ ProtoMesh::ProtoMesh(PackedMesh&& pm, const std::vector<phoenix::morph_animation
     }
   }
 
-ProtoMesh::ProtoMesh(const phoenix::model &library, std::unique_ptr<Skeleton>&& sk, std::string_view fname)
-  :skeleton(std::move(sk)), fname(fname) {
-  for(auto& m:library.mesh.attachments) {
-    PackedMesh pack(m.second,PackedMesh::PK_Visual);
-    attach.emplace_back(pack);
-    auto& att = attach.back();
-    att.name = m.first;
-    att.shape.reset(PhysicMeshShape::load(std::move(pack)));
-    }
-
-  nodes.resize(skeleton==nullptr ? 0 : skeleton->nodes.size());
-  for(size_t i=0;i<nodes.size();++i) {
-    Node& n   = nodes[i];
-    auto& src = skeleton->nodes[i];
-    for(size_t r=0;r<attach.size();++r)
-      if(attach[r].name==src.name){
-        n.attachId = r;
-        break;
-        }
-    n.parentId  = src.parent;
-    n.transform = src.tr;
-    }
-
-  for(auto& i:nodes)
-    if(i.parentId<nodes.size())
-      nodes[i.parentId].hasChild=true;
-
-  size_t subCount=0;
-  for(auto& i:nodes)
-    if(i.attachId<attach.size()) {
-      attach[i.attachId].hasNode = true;
-      subCount+=attach[i.attachId].sub.size();
-      }
-  for(auto& a:attach)
-    if(!a.hasNode)
-      subCount+=a.sub.size();
-  submeshId.resize(subCount);
-
-  subCount=0;
-  for(auto& i:nodes) {
-    i.submeshIdB = subCount;
-    if(i.attachId<attach.size()) {
-      auto& att = attach[i.attachId];
-      for(size_t r=0;r<att.sub.size();++r){
-        if(att.sub[r].material.tex==nullptr) {
-          if(!att.sub[r].texName.empty())
-            Tempest::Log::e("no texture: ",att.sub[r].texName);
-          continue;
-          }
-        submeshId[subCount].id    = i.attachId;
-        submeshId[subCount].subId = r;
-        subCount++;
-        }
-      }
-    i.submeshIdE = subCount;
-    }
-  submeshId.resize(subCount);
-
-  for(size_t i=0;i<library.mesh.meshes.size();++i){
-    auto& mesh = library.mesh.meshes[i];
-    PackedMesh pkg(mesh);
-    skined.emplace_back(pkg);
-    }
-
-  if(skeleton!=nullptr) {
-    for(size_t i=0;i<skeleton->nodes.size();++i) {
-      auto& n=skeleton->nodes[i];
-      if(n.name.find("ZS_POS")==0){
-        Pos p;
-        p.name      = n.name;
-        p.node      = i;
-        p.transform = n.tr;
-        pos.push_back(p);
-        }
-      }
-    }
-  setupScheme(fname);
+ProtoMesh::ProtoMesh(const phoenix::model& library, std::unique_ptr<Skeleton>&& sk, std::string_view fname)
+  :ProtoMesh(PackedModel(library.mesh),std::move(sk),fname) {
   }
 
 ProtoMesh::ProtoMesh(const phoenix::model_hierarchy& library, std::unique_ptr<Skeleton>&& sk, std::string_view fname)
@@ -206,13 +131,16 @@ ProtoMesh::ProtoMesh(const phoenix::model_hierarchy& library, std::unique_ptr<Sk
   }
 
 ProtoMesh::ProtoMesh(const phoenix::model_mesh& library, std::unique_ptr<Skeleton>&& sk, std::string_view fname)
+  :ProtoMesh(PackedModel(library),std::move(sk),fname) {
+  }
+
+ProtoMesh::ProtoMesh(PackedModel&& library, std::unique_ptr<Skeleton>&& sk, std::string_view fname)
   :skeleton(std::move(sk)), fname(fname){
-  for(auto& m:library.attachments) {
-    PackedMesh pack(m.second,PackedMesh::PK_Visual);
-    attach.emplace_back(pack);
+  for(auto& m:library.attach) {
+    attach.emplace_back(m.second);
     auto& att = attach.back();
     att.name = m.first;
-    att.shape.reset(PhysicMeshShape::load(std::move(pack)));
+    att.shape.reset(PhysicMeshShape::load(std::move(m.second)));
   }
 
   nodes.resize(skeleton==nullptr ? 0 : skeleton->nodes.size());
@@ -263,10 +191,8 @@ ProtoMesh::ProtoMesh(const phoenix::model_mesh& library, std::unique_ptr<Skeleto
     }
   submeshId.resize(subCount);
 
-  for(const auto &i : library.meshes){
-    PackedMesh pkg(i);
-    skined.emplace_back(pkg);
-    }
+  for(auto& i:library.skined)
+    skined.emplace_back(i);
 
   if(skeleton!=nullptr) {
     for(size_t i=0;i<skeleton->nodes.size();++i) {
@@ -320,6 +246,15 @@ size_t ProtoMesh::skinedNodesCount() const {
   return ret;
   }
 
+size_t ProtoMesh::memoryUsage() const {
+  size_t ret = 0;
+  for(auto& i:attach)
+    ret += i.vbo.size()*sizeof(StaticMesh::Vertex) + i.ibo.size()*sizeof(uint32_t);
+  for(auto& i:skined)
+    ret += i.vbo.size()*sizeof(AnimMesh::VertexA) + i.ibo.size()*sizeof(uint32_t);
+  return ret;
+  }
+
 Tempest::Matrix4x4 ProtoMesh::mapToRoot(size_t n) const {
   Tempest::Matrix4x4 m;
   m.identity();
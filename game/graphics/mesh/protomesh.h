@@ -16,6 +16,7 @@
 #include "resources.h"
 
 class PackedMesh;
+class PackedModel;
 
 class ProtoMesh {
   public:
@@ -26,6 +27,7 @@ class ProtoMesh {
     ProtoMesh(const phoenix::model& lib, std::unique_ptr<Skeleton>&& sk, std::string_view fname);
     ProtoMesh(const phoenix::model_hierarchy& lib, std::unique_ptr<Skeleton>&& sk, std::string_view fname);
     ProtoMesh(const phoenix::model_mesh& lib, std::unique_ptr<Skeleton>&& sk, std::string_view fname);
+    ProtoMesh(PackedModel&& pm, std::unique_ptr<Skeleton>&& sk, std::string_view fname);
     ProtoMesh(const Material& mat, std::vector<Resources::Vertex> vbo, std::vector<uint32_t> ibo); //decals
     ProtoMesh(ProtoMesh&&)=delete;
     ProtoMesh& operator=(ProtoMesh&&)=delete;
@@ -90,6 +92,8 @@ class ProtoMesh {
     size_t                         skinedNodesCount() const;
     Tempest::Matrix4x4             mapToRoot(size_t node) const;
     size_t                         findNode(std::string_view name,size_t def=size_t(-1)) const;
+    // approximate size of geometry, uploaded to gpu
+    size_t                         memoryUsage() const;
 
   private:
     void                           setupScheme(std::string_view s);
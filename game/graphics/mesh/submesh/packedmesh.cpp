@@ -416,6 +416,15 @@ PackedMesh::PackedMesh(const phoenix::softskin_mesh&  skinned) {
   packMeshletsObj(mesh,PK_Visual,&vertices);
   }
 
+PackedModel::PackedModel(const phoenix::model_mesh& mdm) {
+  attach.reserve(mdm.attachments.size());
+  for(auto& m:mdm.attachments)
+    attach.emplace_back(m.first,PackedMesh(m.second,PackedMesh::PK_Visual));
+  skined.reserve(mdm.meshes.size());
+  for(auto& m:mdm.meshes)
+    skined.emplace_back(m);
+  }
+
 void PackedMesh::packPhysics(const phoenix::mesh& mesh, PkgType type) {
   auto& vbo = mesh.vertices;
   auto& ibo = mesh.polygons.vertex_indices;
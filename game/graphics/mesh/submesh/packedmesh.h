@@ -3,11 +3,13 @@
 #include <phoenix/mesh.hh>
 #include <phoenix/proto_mesh.hh>
 #include <phoenix/softskin_mesh.hh>
+#include <phoenix/model_mesh.hh>
 #include <phoenix/material.hh>
 
 #include <Tempest/Vec>
 #include <unordered_map>
 #include <map>
+#include <string>
 #include <utility>
 
 #include "resources.h"
@@ -63,6 +65,8 @@ class PackedMesh {
     std::pair<Tempest::Vec3,Tempest::Vec3> bbox() const;
 
   private:
+    PackedMesh() = default;
+
     Tempest::Vec3 mBbox[2];
 
     struct SkeletalData {
@@ -115,5 +119,17 @@ class PackedMesh {
 
     void   dbgUtilization(const std::vector<Meshlet>& meshlets);
     void   dbgMeshlets(const phoenix::mesh& mesh, const std::vector<Meshlet*>& meshlets);
+
+  friend class AssetCache;
+  };
+
+// attachments and soft-skin meshes of .MDM model
+class PackedModel final {
+  public:
+    PackedModel() = default;
+    explicit PackedModel(const phoenix::model_mesh& mdm);
+
+    std::vector<std::pair<std::string,PackedMesh>> attach;
+    std::vector<PackedMesh>                        skined;
   };
 
@@ -68,6 +68,10 @@ Tempest::Vec3 PfxEmitterMesh::randCoord(float rnd, const Pose* pose) const {
   return randCoord(*it,rnd,pose);
   }
 
+size_t PfxEmitterMesh::memoryUsage() const {
+  return triangle.size()*sizeof(Triangle) + vertices.size()*sizeof(Tempest::Vec3) + vertAnim.size()*sizeof(AnimData);
+  }
+
 Tempest::Vec3 PfxEmitterMesh::randCoord(const PfxEmitterMesh::Triangle& t, float rnd,
                                         const Pose* pose) const {
   rnd = (rnd-t.prefix)/t.sz;
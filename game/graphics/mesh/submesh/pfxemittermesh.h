@@ -15,6 +15,7 @@ class PfxEmitterMesh {
     PfxEmitterMesh(const phoenix::model_mesh& src);
 
     Tempest::Vec3 randCoord(float rnd, const Pose* pose) const;
+    size_t        memoryUsage() const;
 
   private:
     struct Triangle {
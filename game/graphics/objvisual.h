@@ -27,7 +27,7 @@ class ObjVisual {
     const Animation::Sequence* startAnimAndGet(std::string_view name, uint64_t tickCount, bool force = false);
     bool isAnimExist(std::string_view name) const;
 
-    bool updateAnimation(Npc* npc, World& world, uint64_t dt);
+    bool updateAnimation(Npc* npc, World& world, uint64_t dt, AnimLod* lod = nullptr);
     void processLayers(World& world);
     void syncPhysics();
 
@@ -0,0 +1,98 @@
+#include "texturequeue.h"
+
+#include "utils/workers.h"
+
+using namespace Tempest;
+
+TextureQueue::TextureQueue(Decoder decoder, Sink sink)
+  :decoder(std::move(decoder)), sink(std::move(sink)) {
+  }
+
+TextureQueue::~TextureQueue() {
+  // jobs reference this object
+  wait();
+  }
+
+void TextureQueue::push(std::string name) {
+  {
+    std::lock_guard<std::mutex> guard(sync);
+    decoding++;
+  }
+  Workers::async([this,name=std::move(name)]() {
+    decode(name);
+    });
+  }
+
+void TextureQueue::decode(const std::string& name) {
+  Pixmap pm;
+  bool   ok = false;
+  try {
+    ok = decoder(name,pm);
+    }
+  catch(...) {
+    ok = false;
+    }
+  if(!ok)
+    pm = Pixmap();
+
+  std::lock_guard<std::mutex> guard(sync);
+  ready.push_back(Ready{name,std::move(pm)});
+  decoding--;
+  if(decoding==0)
+    idle.notify_all();
+  }
+
+size_t TextureQueue::flush(size_t byteBudget) {
+  size_t count = 0, spent = 0;
+  while(true) {
+    Ready r;
+    {
+      std::lock_guard<std::mutex> guard(sync);
+      if(ready.empty())
+        break;
+      const size_t sz = byteSize(ready.front().pm);
+      if(count>0 && spent+sz>byteBudget)
+        break;
+      r = std::move(ready.front());
+      ready.pop_front();
+      spent += sz;
+      if(r.pm.isEmpty())
+        st.failed++; else
+        st.uploaded++;
+      st.bytes += sz;
+    }
+    // outside of lock: sink may push new textures
+    sink(r.name,std::move(r.pm));
+    ++count;
+    }
+  return count;
+  }
+
+void TextureQueue::wait() {
+  std::unique_lock<std::mutex> guard(sync);
+  idle.wait(guard,[this](){ return decoding==0; });
+  }
+
+TextureQueue::Stats TextureQueue::stats() {
+  std::lock_guard<std::mutex> guard(sync);
+  Stats ret    = st;
+  ret.decoding = decoding;
+  ret.ready    = ready.size();
+  return ret;
+  }
+
+size_t TextureQueue::byteSize(const Pixmap& pm) {
+  if(pm.isEmpty())
+    return 0;
+  const size_t px = size_t(pm.w())*size_t(pm.h());
+  switch(pm.format()) {
+    case Pixmap::Format::R:    return px;
+    case Pixmap::Format::RG:   return px*2;
+    case Pixmap::Format::RGB:  return px*3;
+    case Pixmap::Format::RGBA: return px*4;
+    case Pixmap::Format::DXT1: return px/2;
+    case Pixmap::Format::DXT3:
+    case Pixmap::Format::DXT5: return px;
+    default:                   return px*4;
+    }
+  }
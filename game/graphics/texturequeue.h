@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Tempest/Pixmap>
+
+#include <condition_variable>
+#include <functional>
+#include <string_view>
+#include <cstdint>
+#include <string>
+#include <mutex>
+#include <deque>
+
+// Decodes textures on worker threads and hands them over to `Sink` at frame boundary,
+// within per-frame byte budget. Doesn't touch the device: decoder and sink are supplied by owner.
+class TextureQueue final {
+  public:
+    // decoder runs on worker threads; empty pixmap is passed to sink, if decoder fails
+    using Decoder = std::function<bool(std::string_view name, Tempest::Pixmap& out)>;
+    using Sink    = std::function<void(const std::string& name, Tempest::Pixmap&& pm)>;
+
+    struct Stats final {
+      size_t   decoding = 0;
+      size_t   ready    = 0; // decoded, waiting for upload
+      uint64_t uploaded = 0;
+      uint64_t bytes    = 0;
+      uint64_t failed   = 0;
+      };
+
+    TextureQueue(Decoder decoder, Sink sink);
+    ~TextureQueue();
+
+    void          push(std::string name);
+    // call once per frame, from the thread, that owns sink; always passes at least one texture,
+    // so single huge texture can't stall the queue. Returns number of textures passed to sink
+    size_t        flush(size_t byteBudget);
+    // blocks until every pushed texture is decoded
+    void          wait();
+    Stats         stats();
+
+    static size_t byteSize(const Tempest::Pixmap& pm);
+
+  private:
+    struct Ready {
+      std::string     name;
+      Tempest::Pixmap pm;
+      };
+
+    void          decode(const std::string& name);
+
+    Decoder                 decoder;
+    Sink                    sink;
+
+    std::mutex              sync;
+    std::condition_variable idle;
+    size_t                  decoding = 0;
+    std::deque<Ready>       ready;
+    Stats                   st;
+  };
@@ -47,6 +47,7 @@ MainWindow::MainWindow(Device& device)
   renderer.resetSwapchain();
   setupUi();
 
+  Resources::PinScope pin; // hud outlives world
   barBack    = Resources::loadTexture("BAR_BACK.TGA");
   barHp      = Resources::loadTexture("BAR_HEALTH.TGA");
   barMisc    = Resources::loadTexture("BAR_MISC.TGA");
@@ -230,6 +231,22 @@ void MainWindow::paintEvent(PaintEvent& event) {
 
     auto& fnt = Resources::font();
     fnt.drawText(p,5,fnt.pixelSize()+5,fpsT);
+
+    if(world!=nullptr && Gothic::inst().doAnimLod()) {
+      auto& st = world->animLodStats();
+      char  lodT[192]={};
+      std::snprintf(lodT,sizeof(lodT),"anim lod: full %u, reduced %u, far %u, culled %u; "
+                                      "evaluated %u (%.2f ms), skipped %u (~%.2f ms saved), uploads culled %u",
+                    st.count[AnimLod::L_Full],st.count[AnimLod::L_Reduced],st.count[AnimLod::L_Far],st.count[AnimLod::L_Culled],
+                    st.evaluated,double(st.evalUs)/1000.0,st.skipped,double(st.savedUs)/1000.0,st.culled);
+      fnt.drawText(p,5,2*(fnt.pixelSize()+5),lodT);
+      }
+    if(world!=nullptr && Gothic::inst().doPoseCache()) {
+      auto& st = world->poseCacheStats();
+      char  pcT[128]={};
+      std::snprintf(pcT,sizeof(pcT),"pose cache: hits %u of %u, sampled %u",st.hits,st.lookups,st.entries);
+      fnt.drawText(p,5,3*(fnt.pixelSize()+5),pcT);
+      }
     }
   }
 
@@ -644,8 +661,10 @@ void MainWindow::drawSaving(Painter &p) {
 void MainWindow::drawSaving(Painter& p, int sw, int sh, float scale) {
   const int x = (w()-sw)/2, y = (h()-sh)/2;
 
-  if(saveback==nullptr)
+  if(saveback==nullptr) {
+    Resources::PinScope pin;
     saveback = Resources::loadTexture("SAVING.TGA");
+    }
   if(saveback==nullptr)
     return;
 
@@ -936,6 +955,8 @@ void MainWindow::onWorldLoaded() {
   device.waitIdle();
   for(auto& c:commands)
     c = device.commandBuffer();
+  // previous world is gone and gpu is idle: assets, it used alone, can go
+  Resources::trimCaches();
 
   if(auto wview=Gothic::inst().worldView()) {
     wview->updateLight();
@@ -997,6 +1018,12 @@ void MainWindow::render(){
       return;
       }
 
+    // frame boundary: textures decoded in background go to gpu here
+    if(Resources::flushTextureUploads()>0)
+      update();
+    if(Gothic::inst().checkLoading()==Gothic::LoadState::Idle)
+      Resources::trimCaches();
+
     if(!video.isActive()) {
       tickCamera(dt);
       Gothic::inst().updateAnimation(dt);
@@ -1,13 +1,21 @@
 #include "marvin.h"
 
 #include <initializer_list>
+#include <algorithm>
 #include <cstdint>
 #include <cctype>
 
 #include "utils/string_frm.h"
+#include "utils/workers.h"
 #include "world/objects/npc.h"
+#include "world/world.h"
 #include "camera.h"
 #include "gothic.h"
+#include "resources.h"
+
+#ifdef OPENGOTHIC_BENCHMARK
+#include "benchmark.h"
+#endif
 
 static bool startsWith(std::string_view str, std::string_view needle) {
   if(needle.size()>str.size())
@@ -111,6 +119,9 @@ Marvin::Marvin() {
     {"zuntrigger %s",              C_Invalid},
 
     {"cheat full",        C_CheatFull},
+    {"toogle parallelnpc",C_ToogleParallelNpc},
+    {"toogle animlod",    C_ToogleAnimLod},
+    {"toogle posecache",  C_TooglePoseCache},
 
 
     {"camera autoswitch", C_CamAutoswitch},
@@ -118,6 +129,14 @@ Marvin::Marvin() {
     {"toogle camdebug",   C_ToogleCamDebug},
     {"toogle camera",     C_ToogleCamera},
     {"insert %c",         C_Insert},
+
+#ifdef OPENGOTHIC_BENCHMARK
+    {"bench %s",          C_Bench},
+#endif
+    {"workers stats",     C_WorkersStats},
+    {"waynet stats",      C_WaynetStats},
+    {"resources stats",   C_ResourcesStats},
+    {"resources memory",  C_ResourcesMemory},
     };
   }
 
@@ -238,6 +257,21 @@ bool Marvin::exec(std::string_view v) {
       Gothic::inst().setFRate(!Gothic::inst().doFrate());
       return true;
       }
+    case C_ToogleParallelNpc:{
+      Gothic::inst().setParallelNpc(!Gothic::inst().doParallelNpc());
+      print(Gothic::inst().doParallelNpc() ? "parallel npc think-phase: on" : "parallel npc think-phase: off");
+      return true;
+      }
+    case C_ToogleAnimLod:{
+      Gothic::inst().setAnimLod(!Gothic::inst().doAnimLod());
+      print(Gothic::inst().doAnimLod() ? "animation lod: on" : "animation lod: off");
+      return true;
+      }
+    case C_TooglePoseCache:{
+      Gothic::inst().setPoseCache(!Gothic::inst().doPoseCache());
+      print(Gothic::inst().doPoseCache() ? "shared pose cache: on" : "shared pose cache: off");
+      return true;
+      }
     case C_CamAutoswitch:
       return true;
     case C_CamMode:
@@ -265,6 +299,54 @@ bool Marvin::exec(std::string_view v) {
         return false;
       return printVariable(world,ret.argv[0]);
       }
+#ifdef OPENGOTHIC_BENCHMARK
+    case C_Bench: {
+      Benchmark bench([this](std::string_view s){ print(s); });
+      return bench.exec(ret.argv[0]);
+      }
+#endif
+    case C_WorkersStats: {
+      auto st = Workers::stats();
+      auto n  = std::max<uint64_t>(st.calls,1);
+      print(string_frm("parallel calls: ",unsigned(st.calls),", inline: ",unsigned(st.inlineCalls),
+                       ", async jobs: ",unsigned(st.jobs),", steals: ",unsigned(st.steals)));
+      print(string_frm("per-call overhead: dispatch ",float(double(st.dispatchNs)/double(n)/1000.0)," us",
+                       ", join ",float(double(st.joinNs)/double(n)/1000.0)," us",
+                       ", helpers reclaimed: ",unsigned(st.reclaimed)));
+      print(string_frm("foreign jobs, run by waiting workers: ",float(double(st.foreignNs)/1000.0)," us"));
+      return true;
+      }
+    case C_WaynetStats: {
+      World* world = Gothic::inst().world();
+      if(world==nullptr)
+        return false;
+      auto st  = world->wayMatrix().pathCacheStats();
+      auto req = std::max<uint64_t>(st.hits+st.misses,1);
+      print(string_frm("path cache: ",unsigned(st.size)," routes, hits: ",unsigned(st.hits),", misses: ",unsigned(st.misses),
+                       ", evictions: ",unsigned(st.evictions),", hit rate: ",float(double(st.hits)*100.0/double(req)),"%"));
+      return true;
+      }
+    case C_ResourcesStats: {
+      for(auto& st:Resources::cacheStats()) {
+        print(string_frm(st.name,": ",unsigned(st.size)," items, lookups: ",unsigned(st.lookups),", hits: ",unsigned(st.hits),
+                         ", contended: ",unsigned(st.contended)," (",float(double(st.lockWaitNs)/1000000.0)," ms)",
+                         ", waited for load: ",unsigned(st.loadWaits)," (",float(double(st.loadWaitNs)/1000000.0)," ms)"));
+        }
+      auto tq = Resources::textureQueueStats();
+      print(string_frm("texture queue: decoding ",unsigned(tq.decoding),", ready ",unsigned(tq.ready),", uploaded ",unsigned(tq.uploaded),
+                       " (",unsigned(tq.bytes/1024)," KiB), failed ",unsigned(tq.failed)));
+      return true;
+      }
+    case C_ResourcesMemory: {
+      for(auto& st:Resources::cacheStats()) {
+        if(st.budget>0)
+          print(string_frm(st.name,": ",unsigned(st.size)," items (",unsigned(st.pinned)," pinned), ",unsigned(st.bytes/1024),
+                           " of ",unsigned(st.budget/1024)," KiB, evicted: ",unsigned(st.evicted))); else
+          print(string_frm(st.name,": ",unsigned(st.size)," items (",unsigned(st.pinned)," pinned), ",unsigned(st.bytes/1024),
+                           " KiB, evicted: ",unsigned(st.evicted)));
+        }
+      return true;
+      }
     }
 
   return true;
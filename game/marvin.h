@@ -27,6 +27,9 @@ class Marvin {
       C_ToogleFrame,
       // npc
       C_CheatFull,
+      C_ToogleParallelNpc,
+      C_ToogleAnimLod,
+      C_TooglePoseCache,
       // camera
       C_CamAutoswitch,
       C_CamMode,
@@ -34,6 +37,13 @@ class Marvin {
       C_ToogleCamera,
 
       C_Insert,
+
+      // profiling
+      C_Bench,
+      C_WorkersStats,
+      C_WaynetStats,
+      C_ResourcesStats,
+      C_ResourcesMemory,
       };
 
     struct Cmd {
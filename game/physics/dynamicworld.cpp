@@ -5,18 +5,56 @@
 #include "physicvbo.h"
 #include "graphics/mesh/skeleton.h"
 
+#include <Tempest/File>
+#include <Tempest/Log>
+
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 
 #include "graphics/mesh/submesh/packedmesh.h"
 #include "world/objects/item.h"
 #include "world/bullet.h"
 #include "world/world.h"
+#include "utils/cachedir.h"
+#include "utils/cacheio.h"
+#include "utils/workers.h"
 
 const float DynamicWorld::ghostPadding=50-22.5f;
 const float DynamicWorld::ghostHeight =140;
 const float DynamicWorld::worldHeight =20000;
 
+namespace {
+
+// landscape cache file layout:
+//   header, sectors, vertices, land indices+segments, water indices+segments, land bvh, water bvh
+struct LandscapeCacheHeader {
+  char     magic[4]   = {'O','G','L','C'};
+  uint32_t version    = 1;
+  uint32_t bulletVer  = BT_BULLET_VERSION;
+  uint16_t vecSize    = sizeof(btVector3);
+  uint16_t ptrSize    = sizeof(void*);
+  uint64_t key        = 0;
+  uint64_t buildUs    = 0;
+  };
+
+// ray tests are read-only on broadphase and shapes: batch is processed by worker threads in chunks
+template<class F>
+void parallelRays(size_t count, const F& func) {
+  static const size_t chunk = 64;
+  Workers::parallelTasks((count+chunk-1)/chunk,[count,&func](uintptr_t id) {
+    const size_t b = size_t(id)*chunk;
+    const size_t e = std::min(count,b+chunk);
+    for(size_t i=b; i<e; ++i)
+      func(i);
+    });
+  }
+
+}
+
 struct DynamicWorld::HumShape:btCapsuleShape {
   HumShape(btScalar radius, btScalar height):btCapsuleShape((height<=0.f ? 0.f : radius)*0.01f,height*0.01f) {}
 
@@ -391,41 +429,23 @@ struct DynamicWorld::BBoxList final {
   DynamicWorld&          wrld;
   };
 
-DynamicWorld::DynamicWorld(World& owner,const phoenix::mesh& worldMesh) {
+DynamicWorld::DynamicWorld(World& owner, const phoenix::mesh& worldMesh, uint64_t cacheKey) {
   world.reset(new CollisionWorld());
 
-  {
-  PackedMesh pkg(worldMesh,PackedMesh::PK_Physic);
-  sectors.resize(pkg.subMeshes.size());
-  for(size_t i=0;i<sectors.size();++i)
-    sectors[i] = pkg.subMeshes[i].material.name;
-
-  landVbo.resize(pkg.vertices.size());
-  for(size_t i=0;i<pkg.vertices.size();++i) {
-    auto v = pkg.vertices[i];
-    landVbo[i] = CollisionWorld::toMeters(Tempest::Vec3(v.pos[0],v.pos[1],v.pos[2]));
-    }
-
-  landMesh .reset(new PhysicVbo(&landVbo));
-  waterMesh.reset(new PhysicVbo(&landVbo));
-
-  for(size_t i=0;i<pkg.subMeshes.size();++i) {
-    auto& sm = pkg.subMeshes[i];
-    if(!sm.material.disable_collision && sm.iboLength>0) {
-      if(sm.material.group==phoenix::material_group::water) {
-        waterMesh->addIndex(pkg.indices,sm.iboOffset,sm.iboLength,sm.material.group);
-        } else {
-        landMesh ->addIndex(pkg.indices,sm.iboOffset,sm.iboLength,sm.material.group,sectors[i].c_str());
-        }
-      }
-    }
-  }
+  const auto      time0    = std::chrono::steady_clock::now();
+  uint64_t        buildUs  = 0;
+  btOptimizedBvh* bvh[2]   = {};
+  const bool      cached   = cacheKey!=0 && loadLandscapeCache(cacheKey,buildUs,bvh[0],bvh[1]);
+  if(!cached)
+    buildLandscape(worldMesh);
 
   btVector3 bbox[2] = {btVector3(0,0,0), btVector3(0,0,0)};
   if(!landMesh->isEmpty()) {
     Tempest::Matrix4x4 mt;
     mt.identity();
-    landShape.reset(new btMultimaterialTriangleMeshShape(landMesh.get(),landMesh->useQuantization(),true));
+    landShape.reset(new btMultimaterialTriangleMeshShape(landMesh.get(),landMesh->useQuantization(),bvh[0]==nullptr));
+    if(bvh[0]!=nullptr)
+      static_cast<btBvhTriangleMeshShape&>(*landShape).setOptimizedBvh(bvh[0]);
     landBody = world->addCollisionBody(*landShape,mt,DynamicWorld::materialFriction(phoenix::material_group::none));
     landBody->setUserIndex(C_Landscape);
 
@@ -438,7 +458,9 @@ DynamicWorld::DynamicWorld(World& owner,const phoenix::mesh& worldMesh) {
   if(!waterMesh->isEmpty()) {
     Tempest::Matrix4x4 mt;
     mt.identity();
-    waterShape.reset(new btMultimaterialTriangleMeshShape(waterMesh.get(),waterMesh->useQuantization(),true));
+    waterShape.reset(new btMultimaterialTriangleMeshShape(waterMesh.get(),waterMesh->useQuantization(),bvh[1]==nullptr));
+    if(bvh[1]!=nullptr)
+      static_cast<btBvhTriangleMeshShape&>(*waterShape).setOptimizedBvh(bvh[1]);
     waterBody = world->addCollisionBody(*waterShape,mt,0);
     waterBody->setUserIndex(C_Water);
     waterBody->setCollisionFlags(btCollisionObject::CF_STATIC_OBJECT | btCollisionObject::CF_NO_CONTACT_RESPONSE);
@@ -450,6 +472,17 @@ DynamicWorld::DynamicWorld(World& owner,const phoenix::mesh& worldMesh) {
     bbox[1].setMax(b[1]);
     }
 
+  const auto time1  = std::chrono::steady_clock::now();
+  const auto loadUs = uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(time1-time0).count());
+  if(cached) {
+    Tempest::Log::i("landscape collision: loaded from cache in ",int(loadUs/1000)," ms (build takes ",int(buildUs/1000),
+                    " ms, saved ",int((int64_t(buildUs)-int64_t(loadUs))/1000)," ms)");
+    }
+  else if(cacheKey!=0) {
+    Tempest::Log::i("landscape collision: built in ",int(loadUs/1000)," ms");
+    saveLandscapeCache(cacheKey,loadUs);
+    }
+
   world->setBBox(bbox[0],bbox[1]);
   npcList   .reset(new NpcBodyList(*this));
   bulletList.reset(new BulletsList(*this));
@@ -467,6 +500,201 @@ DynamicWorld::DynamicWorld(World& owner,const phoenix::mesh& worldMesh) {
 DynamicWorld::~DynamicWorld(){
   }
 
+void DynamicWorld::buildLandscape(const phoenix::mesh& worldMesh) {
+  landBvh .clear();
+  waterBvh.clear();
+
+  PackedMesh pkg(worldMesh,PackedMesh::PK_Physic);
+  sectors.resize(pkg.subMeshes.size());
+  for(size_t i=0;i<sectors.size();++i)
+    sectors[i] = pkg.subMeshes[i].material.name;
+
+  landVbo.resize(pkg.vertices.size());
+  for(size_t i=0;i<pkg.vertices.size();++i) {
+    auto v = pkg.vertices[i];
+    landVbo[i] = CollisionWorld::toMeters(Tempest::Vec3(v.pos[0],v.pos[1],v.pos[2]));
+    }
+
+  landMesh .reset(new PhysicVbo(&landVbo));
+  waterMesh.reset(new PhysicVbo(&landVbo));
+
+  for(size_t i=0;i<pkg.subMeshes.size();++i) {
+    auto& sm = pkg.subMeshes[i];
+    if(!sm.material.disable_collision && sm.iboLength>0) {
+      if(sm.material.group==phoenix::material_group::water) {
+        waterMesh->addIndex(pkg.indices,sm.iboOffset,sm.iboLength,sm.material.group);
+        } else {
+        landMesh ->addIndex(pkg.indices,sm.iboOffset,sm.iboLength,sm.material.group,sectors[i].c_str());
+        }
+      }
+    }
+  }
+
+std::filesystem::path DynamicWorld::landscapeCachePath(uint64_t key) {
+  auto dir = CacheDir::dir("landscape");
+  if(dir.empty())
+    return dir;
+  char name[64] = {};
+  std::snprintf(name,sizeof(name),"%016llx.lnd",static_cast<unsigned long long>(key));
+  return dir/name;
+  }
+
+bool DynamicWorld::loadLandscapeCache(uint64_t key, uint64_t& buildUs, btOptimizedBvh*& land, btOptimizedBvh*& water) {
+  std::vector<BvhChunk> file;
+  try {
+    const auto path = landscapeCachePath(key);
+    if(path.empty())
+      return false;
+    Tempest::RFile fin(path.u16string().c_str());
+    file.resize((fin.size()+sizeof(BvhChunk)-1)/sizeof(BvhChunk));
+    if(fin.read(file.data(),fin.size())!=fin.size())
+      return false;
+
+    CacheReader rd;
+    rd.begin = reinterpret_cast<const uint8_t*>(file.data());
+    rd.at    = rd.begin;
+    rd.end   = rd.begin + fin.size();
+
+    LandscapeCacheHeader ref, hdr;
+    ref.key = key;
+    if(!rd.read(hdr) || std::memcmp(hdr.magic,ref.magic,4)!=0 || hdr.version!=ref.version ||
+       hdr.bulletVer!=ref.bulletVer || hdr.vecSize!=ref.vecSize || hdr.ptrSize!=ref.ptrSize || hdr.key!=key)
+      return false;
+
+    uint32_t count = 0;
+    if(!rd.read(count))
+      return false;
+    sectors.resize(count);
+    for(auto& s:sectors) {
+      uint32_t len = 0;
+      if(!rd.read(len) || size_t(rd.end-rd.at)<len)
+        return false;
+      s.assign(reinterpret_cast<const char*>(rd.at),len);
+      rd.at += len;
+      }
+
+    if(!rd.read(count) || size_t(rd.end-rd.at)/sizeof(btVector3)<count)
+      return false;
+    landVbo.resize(count);
+    if(!rd.read(landVbo.data(),count*sizeof(btVector3)))
+      return false;
+
+    landMesh .reset(new PhysicVbo(&landVbo));
+    waterMesh.reset(new PhysicVbo(&landVbo));
+    for(auto mesh:{landMesh.get(),waterMesh.get()}) {
+      uint32_t idCount = 0, sgCount = 0;
+      if(!rd.read(idCount) || size_t(rd.end-rd.at)/sizeof(uint32_t)<idCount)
+        return false;
+      mesh->id.resize(idCount);
+      if(!rd.read(mesh->id.data(),idCount*sizeof(uint32_t)) || !rd.read(sgCount))
+        return false;
+      for(uint32_t i=0; i<sgCount; ++i) {
+        uint32_t off = 0, size = 0;
+        uint8_t  mat = 0;
+        int32_t  sec = -1;
+        if(!rd.read(off) || !rd.read(size) || !rd.read(mat) || !rd.read(sec))
+          return false;
+        if(size==0 || size_t(off)+size_t(size)*3>idCount || sec>=int32_t(sectors.size()))
+          return false;
+        const char* sector = sec>=0 ? sectors[size_t(sec)].c_str() : nullptr;
+        mesh->addSegment(size_t(size)*3,off,phoenix::material_group(mat),sector);
+        }
+      mesh->adjustMesh();
+      }
+
+    std::vector<BvhChunk>* bvh[2] = {&landBvh, &waterBvh};
+    btOptimizedBvh*        ret[2] = {};
+    for(int i=0; i<2; ++i) {
+      uint32_t size = 0;
+      if(!rd.read(size))
+        return false;
+      rd.align();
+      if(size==0)
+        continue;
+      if(size_t(rd.end-rd.at)<size)
+        return false;
+      bvh[i]->resize((size+sizeof(BvhChunk)-1)/sizeof(BvhChunk));
+      std::memcpy(bvh[i]->data(),rd.at,size);
+      rd.at += size;
+      ret[i] = btOptimizedBvh::deSerializeInPlace(bvh[i]->data(),size,false);
+      if(ret[i]==nullptr)
+        return false;
+      }
+    if((ret[0]==nullptr)!=landMesh->isEmpty() || (ret[1]==nullptr)!=waterMesh->isEmpty())
+      return false;
+
+    land    = ret[0];
+    water   = ret[1];
+    buildUs = hdr.buildUs;
+    return true;
+    }
+  catch(...) {
+    return false;
+    }
+  }
+
+void DynamicWorld::saveLandscapeCache(uint64_t key, uint64_t buildUs) const {
+  CacheWriter wr;
+
+  LandscapeCacheHeader hdr;
+  hdr.key     = key;
+  hdr.buildUs = buildUs;
+  wr.write(hdr);
+
+  wr.write(uint32_t(sectors.size()));
+  for(auto& s:sectors) {
+    wr.write(uint32_t(s.size()));
+    wr.write(s.data(),s.size());
+    }
+
+  wr.write(uint32_t(landVbo.size()));
+  wr.write(landVbo.data(),landVbo.size()*sizeof(btVector3));
+
+  for(auto mesh:{landMesh.get(),waterMesh.get()}) {
+    wr.write(uint32_t(mesh->id.size()));
+    wr.write(mesh->id.data(),mesh->id.size()*sizeof(uint32_t));
+    wr.write(uint32_t(mesh->segments.size()));
+    for(auto& sg:mesh->segments) {
+      int32_t sec = -1;
+      for(size_t i=0; i<sectors.size() && sg.sector!=nullptr; ++i)
+        if(sectors[i].c_str()==sg.sector)
+          sec = int32_t(i);
+      wr.write(uint32_t(sg.off));
+      wr.write(uint32_t(sg.size));
+      wr.write(uint8_t(sg.mat));
+      wr.write(sec);
+      }
+    }
+
+  for(auto shape:{landShape.get(),waterShape.get()}) {
+    auto  mesh = static_cast<btBvhTriangleMeshShape*>(shape);
+    auto  bvh  = mesh!=nullptr ? mesh->getOptimizedBvh() : nullptr;
+    uint32_t size = bvh!=nullptr ? bvh->calculateSerializeBufferSize() : 0;
+    wr.write(size);
+    wr.align();
+    if(size==0)
+      continue;
+    const size_t at = wr.data.size();
+    wr.data.resize(at+size);
+    // serialize into temporary aligned storage: bullet expects 16-byte aligned buffer
+    std::vector<BvhChunk> tmp((size+sizeof(BvhChunk)-1)/sizeof(BvhChunk));
+    if(!bvh->serializeInPlace(tmp.data(),size,false))
+      return;
+    std::memcpy(wr.data.data()+at,tmp.data(),size);
+    }
+
+  const auto path = landscapeCachePath(key);
+  if(path.empty())
+    return;
+  try {
+    Tempest::WFile fout(path.u16string().c_str());
+    fout.write(wr.data.data(),wr.data.size());
+    }
+  catch(...) {
+    Tempest::Log::e("landscape collision: unable to write cache file");
+    }
+  }
+
 DynamicWorld::RayLandResult DynamicWorld::landRay(const Tempest::Vec3& from, float maxDy) const {
   world->updateAabbs();
   if(maxDy==0)
@@ -631,6 +859,36 @@ float DynamicWorld::soundOclusion(const Tempest::Vec3& from, const Tempest::Vec3
   return (tlen*fr)/1.5f;
   }
 
+void DynamicWorld::landRay(const Tempest::Vec3* from, size_t count, RayLandResult* out, float maxDy) const {
+  world->updateAabbs();
+  if(maxDy==0)
+    maxDy = worldHeight;
+  parallelRays(count,[this,from,out,maxDy](size_t i) {
+    auto& p = from[i];
+    out[i] = ray(Tempest::Vec3(p.x,p.y+ghostPadding,p.z), Tempest::Vec3(p.x,p.y-maxDy,p.z));
+    });
+  }
+
+void DynamicWorld::waterRay(const Tempest::Vec3* from, size_t count, RayWaterResult* out) const {
+  world->updateAabbs();
+  parallelRays(count,[this,from,out](size_t i) {
+    auto& p = from[i];
+    out[i] = implWaterRay(p, Tempest::Vec3(p.x,p.y+worldHeight,p.z));
+    });
+  }
+
+void DynamicWorld::ray(const Tempest::Vec3* from, const Tempest::Vec3* to, size_t count, RayLandResult* out) const {
+  parallelRays(count,[this,from,to,out](size_t i) {
+    out[i] = ray(from[i],to[i]);
+    });
+  }
+
+void DynamicWorld::rayNpc(const Tempest::Vec3* from, const Tempest::Vec3* to, size_t count, RayQueryResult* out) const {
+  parallelRays(count,[this,from,to,out](size_t i) {
+    out[i] = rayNpc(from[i],to[i]);
+    });
+  }
+
 DynamicWorld::NpcItem DynamicWorld::ghostObj(std::string_view visual) {
   Tempest::Vec3 min={0,0,0}, max={0,0,0};
   if(auto sk=Resources::loadSkeleton(visual)) {
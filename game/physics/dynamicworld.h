@@ -3,14 +3,18 @@
 #include <phoenix/mesh.hh>
 
 #include <Tempest/Matrix4x4>
+#include <filesystem>
 #include <memory>
 #include <limits>
+#include <vector>
+#include <string>
 
 class btTriangleIndexVertexArray;
 class btCollisionShape;
 class btCollisionObject;
 class btRigidBody;
 class btVector3;
+class btOptimizedBvh;
 
 class PhysicMeshShape;
 class PhysicVbo;
@@ -40,7 +44,8 @@ class DynamicWorld final {
     static constexpr float spellSpeed  = 1; // centimeters per milliseconds
     static const     float ghostPadding;
 
-    DynamicWorld(World &world, const phoenix::mesh& mesh);
+    // cacheKey - hash of source file, to look up prebuilt landscape collision on disk; 0 - don't cache
+    DynamicWorld(World &world, const phoenix::mesh& mesh, uint64_t cacheKey = 0);
     DynamicWorld(const DynamicWorld&)=delete;
     ~DynamicWorld();
 
@@ -234,6 +239,12 @@ class DynamicWorld final {
     RayQueryResult rayNpc       (const Tempest::Vec3& from, const Tempest::Vec3& to) const;
     float          soundOclusion(const Tempest::Vec3& from, const Tempest::Vec3& to) const;
 
+    // batched queries: rays are split between worker threads; world must not be modified until return
+    void           landRay      (const Tempest::Vec3* from, size_t count, RayLandResult* out, float maxDy=0) const;
+    void           waterRay     (const Tempest::Vec3* from, size_t count, RayWaterResult* out) const;
+    void           ray          (const Tempest::Vec3* from, const Tempest::Vec3* to, size_t count, RayLandResult* out) const;
+    void           rayNpc       (const Tempest::Vec3* from, const Tempest::Vec3* to, size_t count, RayQueryResult* out) const;
+
     NpcItem        ghostObj  (std::string_view visual);
     Item           staticObj (const PhysicMeshShape *src, const Tempest::Matrix4x4& m);
     Item           movableObj(const PhysicMeshShape *src, const Tempest::Matrix4x4& m);
@@ -266,9 +277,20 @@ class DynamicWorld final {
     RayWaterResult implWaterRay(const Tempest::Vec3& from, const Tempest::Vec3& to) const;
     bool           hasCollision(const NpcItem &it, CollisionTest& out);
 
+    void           buildLandscape(const phoenix::mesh& worldMesh);
+    bool           loadLandscapeCache(uint64_t key, uint64_t& buildUs, btOptimizedBvh*& land, btOptimizedBvh*& water);
+    void           saveLandscapeCache(uint64_t key, uint64_t buildUs) const;
+    static auto    landscapeCachePath(uint64_t key) -> std::filesystem::path;
+
+    // storage of BVH, deserialized in place from landscape cache
+    struct alignas(16) BvhChunk {
+      uint8_t data[16] = {};
+      };
+
     std::unique_ptr<CollisionWorld>    world;
 
     std::vector<std::string>           sectors;
+    std::vector<BvhChunk>              landBvh, waterBvh;
 
     std::vector<btVector3>             landVbo;
     std::unique_ptr<PhysicVbo>         landMesh;
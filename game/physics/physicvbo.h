@@ -45,4 +45,6 @@ class PhysicVbo : public btTriangleIndexVertexArray {
     const std::vector<btVector3>& vert;
     std::vector<uint32_t>         id;
     std::vector<Segment>          segments;
+
+  friend class DynamicWorld; // landscape cache
   };
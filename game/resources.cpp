@@ -24,6 +24,8 @@
 #include "graphics/mesh/submesh/animmesh.h"
 #include "graphics/mesh/submesh/pfxemittermesh.h"
 #include "graphics/mesh/submesh/packedmesh.h"
+#include "graphics/mesh/animpack.h"
+#include "graphics/mesh/assetcache.h"
 #include "graphics/mesh/skeleton.h"
 #include "graphics/mesh/protomesh.h"
 #include "graphics/mesh/animation.h"
@@ -42,6 +44,20 @@ using namespace Tempest;
 
 Resources* Resources::inst=nullptr;
 
+static size_t cacheBudget(std::string_view name) {
+  return size_t(std::max(0,Gothic::settingsGetI("PERFORMANCE",name)))*1024*1024;
+  }
+
+// compiled texture, that replaces "NAME.TGA" in game archives: "NAME-C.TEX"; empty for other names
+static std::string compiledTexName(std::string_view name) {
+  if(!FileExt::hasExt(name,"TGA"))
+    return std::string();
+  std::string ret = std::string(name);
+  ret.resize(ret.size() + 2);
+  std::memcpy(&ret[0]+ret.size()-6,"-C.TEX",6);
+  return ret;
+  }
+
 static void emplaceTag(char* buf, char tag){
   for(size_t i=1;buf[i];++i){
     if(buf[i]==tag && buf[i-1]=='_' && buf[i+1]=='0'){
@@ -54,9 +70,20 @@ static void emplaceTag(char* buf, char tag){
   }
 
 Resources::Resources(Tempest::Device &device)
-  : dev(device) {
+  : dev(device),
+    texQueue([](std::string_view name, Tempest::Pixmap& pm){ return implDecodeTexture(name,pm); },
+             [this](const std::string& name, Tempest::Pixmap&& pm){ implUploadAsync(name,std::move(pm)); }) {
   inst=this;
 
+  texCache    .setBudget(cacheBudget("textureCacheMb"));
+  aniMeshCache.setBudget(cacheBudget("meshCacheMb"));
+  animCache   .setBudget(cacheBudget("animationCacheMb"));
+  emiMeshCache.setBudget(cacheBudget("emitterCacheMb"));
+  zenCache    .setBudget(cacheBudget("bundleCacheMb"));
+  AssetCache::setEnabled(Gothic::settingsGetI("PERFORMANCE","assetCache")!=0);
+  AnimPack::setEnabled(Gothic::settingsGetI("PERFORMANCE","animCompress")!=0);
+  Animation::setLazyLoad(Gothic::settingsGetI("PERFORMANCE","animLazy")!=0);
+
   static std::array<VertexFsq,6> fsqBuf =
    {{
       {-1,-1},{ 1,1},{1,-1},
@@ -75,9 +102,6 @@ Resources::Resources(Tempest::Device &device)
   dxMusic->addPath(Gothic::inst().nestedPath({u"_work",u"Data",u"Music",u"menu_men"}, Dir::FT_Dir));
   dxMusic->addPath(Gothic::inst().nestedPath({u"_work",u"Data",u"Music",u"orchestra"},Dir::FT_Dir));
 
-  fBuff .reserve(8*1024*1024);
-  ddsBuf.reserve(8*1024*1024);
-
   {
   Pixmap pm(1,1,Pixmap::Format::RGBA);
   uint8_t* pix = reinterpret_cast<uint8_t*>(pm.data());
@@ -116,8 +140,23 @@ void Resources::loadVdfs(const std::vector<std::u16string>& modvdfs) {
            std::make_tuple(bIsMod,b.time,int(b.ord));
     });
 
+  // any change in set of archives, or their timestamps, invalidates on-disk asset cache
+  uint64_t stamp = 0xcbf29ce484222325ull;
+  for(auto& i:archives) {
+    auto p = reinterpret_cast<const uint8_t*>(i.name.data());
+    for(size_t r=0; r<i.name.size()*sizeof(char16_t); ++r) {
+      stamp ^= p[r];
+      stamp *= 0x100000001b3ull;
+      }
+    stamp ^= uint64_t(i.time);
+    stamp *= 0x100000001b3ull;
+    }
+  AssetCache::setArchiveStamp(stamp);
+
+  // vdf_file::open maps archive: entries are views into mapping, only parsers copy data out
   for(auto& i:archives)
     inst->gothicAssets.merge(phoenix::vdf_file::open(i.name), false);
+  inst->vdfIndex = VdfsIndex(inst->gothicAssets);
 
   //for(auto& i:gothicAssets.getKnownFiles())
   //  Log::i(i);
@@ -132,18 +171,21 @@ Resources::~Resources() {
   }
 
 bool Resources::hasFile(std::string_view name) {
-  std::lock_guard<std::recursive_mutex> g(inst->sync);
-  return static_cast<const phoenix::vdf_file&>(inst->gothicAssets).find_entry(name) != nullptr;
+  return inst->vdfIndex.find(name) != nullptr;
+  }
+
+const phoenix::vdf_entry* Resources::findFile(std::string_view name) {
+  return inst->vdfIndex.find(name);
   }
 
 bool Resources::getFileData(std::string_view name, std::vector<uint8_t> &dat) {
   dat.clear();
 
-  const phoenix::vdf_entry* entry = Resources::vdfsIndex().find_entry(name);
+  const phoenix::vdf_entry* entry = Resources::findFile(name);
   if(entry==nullptr)
     return false;
 
-  // TODO: This should return a buffer!
+  // copy: prefer getFileBuffer, it's a view into mapped archive
   phoenix::buffer reader = entry->open();
   dat.assign((uint8_t*) reader.array(), (uint8_t*) reader.array() + reader.limit());
 
@@ -157,7 +199,7 @@ std::vector<uint8_t> Resources::getFileData(std::string_view name) {
   }
 
 phoenix::buffer Resources::getFileBuffer(std::string_view name) {
-  const phoenix::vdf_entry* entry = Resources::vdfsIndex().find_entry(name);
+  const phoenix::vdf_entry* entry = Resources::findFile(name);
   if (entry == nullptr)
     throw std::runtime_error("failed to open resource: " + std::string{name});
   return entry->open();
@@ -260,24 +302,16 @@ int64_t Resources::vdfTimestamp(const std::u16string& name) {
     }
   }
 
-Tempest::Texture2d* Resources::implLoadTexture(TextureCache& cache, std::string_view cname) {
-  if(cname.empty())
+std::unique_ptr<Texture2d> Resources::implLoadTexture(std::string_view cname) {
+  Tempest::Pixmap pm;
+  if(!implDecodeTexture(cname,pm))
     return nullptr;
+  return implUploadTexture(pm);
+  }
 
-  std::string name = std::string(cname);
-  auto it=cache.find(name);
-  if(it!=cache.end())
-    return it->second.get();
-
-  if(FileExt::hasExt(name,"TGA")) {
-    name.resize(name.size() + 2);
-    std::memcpy(&name[0]+name.size()-6,"-C.TEX",6);
-
-    it=cache.find(name);
-    if(it!=cache.end())
-      return it->second.get();
-
-    if(const phoenix::vdf_entry* entry = Resources::vdfsIndex().find_entry(name)) {
+bool Resources::implDecodeTexture(std::string_view cname, Tempest::Pixmap& out) {
+  if(auto name = compiledTexName(cname); !name.empty()) {
+    if(const phoenix::vdf_entry* entry = Resources::findFile(name)) {
       auto reader = entry->open();
       auto tex = phoenix::texture::parse(reader);
 
@@ -287,21 +321,15 @@ Tempest::Texture2d* Resources::implLoadTexture(TextureCache& cache, std::string_
           tex.format() == phoenix::tex_dxt4 ||
           tex.format() == phoenix::tex_dxt5) {
         auto dds = phoenix::texture_to_dds(tex);
-
-        auto t = implLoadTexture(cache, std::string(cname), dds);
-        if(t!=nullptr)
-          return t;
+        if(implDecodeTexture(dds,out))
+          return true;
         } else {
         auto rgba = tex.as_rgba8(0);
 
         try {
-          Tempest::Pixmap    pm(tex.width(), tex.height(), Tempest::Pixmap::Format::RGBA);
-          std::memcpy(pm.data(), rgba.data(), rgba.size());
-
-          std::unique_ptr<Texture2d> t{new Texture2d(dev.texture(pm))};
-          Texture2d* ret=t.get();
-          cache[std::move(name)] = std::move(t);
-          return ret;
+          out = Tempest::Pixmap(tex.width(), tex.height(), Tempest::Pixmap::Format::RGBA);
+          std::memcpy(out.data(), rgba.data(), rgba.size());
+          return true;
           }
         catch (...) {
           }
@@ -309,68 +337,54 @@ Tempest::Texture2d* Resources::implLoadTexture(TextureCache& cache, std::string_
       }
     }
 
-  if(const phoenix::vdf_entry* entry = Resources::vdfsIndex().find_entry(cname)) {
+  if(const phoenix::vdf_entry* entry = Resources::findFile(cname)) {
     phoenix::buffer reader = entry->open();
-    return implLoadTexture(cache,std::string(cname),reader);
+    return implDecodeTexture(reader,out);
     }
 
-  cache[name]=nullptr;
-  return nullptr;
+  return false;
   }
 
-Texture2d *Resources::implLoadTexture(TextureCache& cache, std::string&& name, const phoenix::buffer& data) {
+bool Resources::implDecodeTexture(const phoenix::buffer& data, Tempest::Pixmap& out) {
   try {
     Tempest::MemReader rd((uint8_t*)data.array(),data.limit());
-    Tempest::Pixmap    pm(rd);
-
-    std::unique_ptr<Texture2d> t{new Texture2d(dev.texture(pm))};
-    Texture2d* ret=t.get();
-    cache[std::move(name)] = std::move(t);
-    return ret;
+    out = Tempest::Pixmap(rd);
+    return true;
     }
   catch(...){
-    return nullptr;
+    return false;
     }
   }
 
-ProtoMesh* Resources::implLoadMesh(std::string_view name) {
-  if(name.size()==0)
+std::unique_ptr<Texture2d> Resources::implUploadTexture(const Tempest::Pixmap& pm) {
+  if(pm.isEmpty())
     return nullptr;
-
-  auto cname = std::string(name);
-  auto it    = aniMeshCache.find(cname);
-  if(it!=aniMeshCache.end())
-    return it->second.get();
-
-  auto  t   = implLoadMeshMain(cname);
-  auto  ret = t.get();
-  aniMeshCache[cname] = std::move(t);
-  if(ret==nullptr)
-    Log::e("unable to load mesh \"",cname,"\"");
-  return ret;
+  try {
+    return std::unique_ptr<Texture2d>{new Texture2d(dev.texture(pm))};
+    }
+  catch(...){
+    return nullptr;
+    }
   }
 
 std::unique_ptr<ProtoMesh> Resources::implLoadMeshMain(std::string name) {
   if(FileExt::hasExt(name,"3DS")) {
     FileExt::exchangeExt(name,"3DS","MRM");
 
-    const phoenix::vdf_entry* entry = Resources::vdfsIndex().find_entry(name);
+    const phoenix::vdf_entry* entry = Resources::findFile(name);
     if(entry == nullptr)
       return nullptr;
-    auto reader = entry->open();
-    auto zmsh = phoenix::proto_mesh::parse(reader);
 
-    if(zmsh.sub_meshes.empty())
+    auto packed = AssetCache::mesh(*entry);
+    if(!packed)
       return nullptr;
-
-    PackedMesh packed(zmsh,PackedMesh::PK_Visual);
-    return std::unique_ptr<ProtoMesh>{new ProtoMesh(std::move(packed),name)};
+    return std::unique_ptr<ProtoMesh>{new ProtoMesh(std::move(*packed),name)};
     }
 
   if(FileExt::hasExt(name,"MMS") || FileExt::hasExt(name,"MMB")) {
     FileExt::exchangeExt(name,"MMS","MMB");
 
-    const phoenix::vdf_entry* entry = Resources::vdfsIndex().find_entry(name);
+    const phoenix::vdf_entry* entry = Resources::findFile(name);
     if(entry == nullptr)
       throw std::runtime_error("failed to open resource: " + name);
 
@@ -388,7 +402,7 @@ std::unique_ptr<ProtoMesh> Resources::implLoadMeshMain(std::string name) {
     if(anim==nullptr)
       return nullptr;
 
-    std::optional<phoenix::model_mesh> mdm {};
+    std::optional<PackedModel> mdm {};
 
     auto mesh   = std::string(anim->defaultMesh());
 
@@ -396,20 +410,18 @@ std::unique_ptr<ProtoMesh> Resources::implLoadMeshMain(std::string name) {
     FileExt::exchangeExt(mesh,"ASC",  "MDM");
 
     if(hasFile(mesh)) {
-      const phoenix::vdf_entry* entry = Resources::vdfsIndex().find_entry(mesh);
-      auto reader = entry->open();
-      mdm = phoenix::model_mesh::parse(reader);
+      const phoenix::vdf_entry* entry = Resources::findFile(mesh);
+      mdm = AssetCache::model(*entry);
       }
 
     if(anim->defaultMesh().empty())
       mesh = name;
     FileExt::assignExt(mesh,"MDH");
 
-    const phoenix::vdf_entry* entry = Resources::vdfsIndex().find_entry(mesh);
+    const phoenix::vdf_entry* entry = Resources::findFile(mesh);
     if (entry == nullptr)
         std::runtime_error("failed to open resource: " + mesh);
-    auto reader = entry->open();
-    auto mdh = phoenix::model_hierarchy::parse(reader);
+    auto mdh = AssetCache::hierarchy(*entry);
 
     std::unique_ptr<Skeleton> sk{new Skeleton(mdh,anim,name)};
     std::unique_ptr<ProtoMesh> t;
@@ -426,12 +438,11 @@ std::unique_ptr<ProtoMesh> Resources::implLoadMeshMain(std::string name) {
     if(!hasFile(name))
       return nullptr;
 
-    const phoenix::vdf_entry* entry = Resources::vdfsIndex().find_entry(name);
+    const phoenix::vdf_entry* entry = Resources::findFile(name);
     if(entry == nullptr)
       return nullptr;
 
-    auto reader = entry->open();
-    auto mdm = phoenix::model_mesh::parse(reader);
+    auto mdm = AssetCache::model(*entry);
     std::unique_ptr<ProtoMesh> t{new ProtoMesh(std::move(mdm),nullptr,name)};
     return t;
     }
@@ -440,7 +451,7 @@ std::unique_ptr<ProtoMesh> Resources::implLoadMeshMain(std::string name) {
     if(!hasFile(name))
       return nullptr;
 
-    const phoenix::vdf_entry* entry = Resources::vdfsIndex().find_entry(name);
+    const phoenix::vdf_entry* entry = Resources::findFile(name);
     if(entry == nullptr)
       throw std::runtime_error("failed to open resource: " + name);
     auto reader = entry->open();
@@ -458,62 +469,39 @@ std::unique_ptr<ProtoMesh> Resources::implLoadMeshMain(std::string name) {
   return nullptr;
   }
 
-PfxEmitterMesh* Resources::implLoadEmiterMesh(std::string_view name) {
+std::unique_ptr<PfxEmitterMesh> Resources::implLoadEmiterMesh(std::string_view name) {
   // TODO: reuse code from Resources::implLoadMeshMain
   auto cname = std::string(name);
-  auto it    = emiMeshCache.find(cname);
-  if(it!=emiMeshCache.end())
-    return it->second.get();
-
-  auto& ret = emiMeshCache[cname];
 
   if(FileExt::hasExt(cname,"3DS")) {
     FileExt::exchangeExt(cname,"3DS","MRM");
 
-    const phoenix::vdf_entry* entry = Resources::vdfsIndex().find_entry(cname);
+    const phoenix::vdf_entry* entry = Resources::findFile(cname);
     if (entry == nullptr) return nullptr;
-    auto reader = entry->open();
-    auto zmsh = phoenix::proto_mesh::parse(reader);
 
-    if(zmsh.sub_meshes.empty())
+    auto packed = AssetCache::mesh(*entry);
+    if(!packed)
       return nullptr;
-
-    PackedMesh packed(zmsh,PackedMesh::PK_Visual);
-    ret = std::unique_ptr<PfxEmitterMesh>(new PfxEmitterMesh(packed));
-    return ret.get();
+    return std::unique_ptr<PfxEmitterMesh>(new PfxEmitterMesh(*packed));
     }
 
   if(FileExt::hasExt(name,"MDM")) {
     if(!hasFile(name))
       return nullptr;
 
-    const phoenix::vdf_entry* entry = Resources::vdfsIndex().find_entry(cname);
+    const phoenix::vdf_entry* entry = Resources::findFile(cname);
     if(entry == nullptr)
       throw std::runtime_error("failed to open resource: " + cname);
     auto reader = entry->open();
     auto mdm = phoenix::model_mesh::parse(reader);
 
-    ret = std::unique_ptr<PfxEmitterMesh>(new PfxEmitterMesh(std::move(mdm)));
-    return ret.get();
+    return std::unique_ptr<PfxEmitterMesh>(new PfxEmitterMesh(std::move(mdm)));
     }
 
   return nullptr;
   }
 
-ProtoMesh* Resources::implDecalMesh(const phoenix::vob& vob) {
-  DecalK key;
-  key.mat         = Material(vob);
-  key.sX          = vob.visual_decal->dimension.x;
-  key.sY          = vob.visual_decal->dimension.y;
-  key.decal2Sided = vob.visual_decal->two_sided;
-
-  if(key.mat.tex==nullptr)
-    return nullptr;
-
-  auto it = decalMeshCache.find(key);
-  if(it!=decalMeshCache.end())
-    return it->second.get();
-
+std::unique_ptr<ProtoMesh> Resources::implDecalMesh(const DecalK& key) {
   Resources::Vertex vbo[8] = {
     {{-1.f, -1.f, 0.f},{0,0,-1},{0,1}, 0xFFFFFFFF},
     {{ 1.f, -1.f, 0.f},{0,0,-1},{1,1}, 0xFFFFFFFF},
@@ -536,11 +524,7 @@ ProtoMesh* Resources::implDecalMesh(const phoenix::vob& vob) {
     cibo = { 0,1,2, 0,2,3, 4,6,5, 4,7,6 }; else
     cibo = { 0,1,2, 0,2,3 };
 
-  std::unique_ptr<ProtoMesh> t{new ProtoMesh(key.mat, std::move(cvbo), std::move(cibo))};
-
-  auto ret = t.get();
-  decalMeshCache[key] = std::move(t);
-  return ret;
+  return std::unique_ptr<ProtoMesh>{new ProtoMesh(key.mat, std::move(cvbo), std::move(cibo))};
   }
 
 std::unique_ptr<Animation> Resources::implLoadAnimation(std::string name) {
@@ -550,7 +534,7 @@ std::unique_ptr<Animation> Resources::implLoadAnimation(std::string name) {
   if(Gothic::inst().version().game==2)
     FileExt::exchangeExt(name,"MDS","MSB");
 
-  const phoenix::vdf_entry* entry = Resources::vdfsIndex().find_entry(name);
+  const phoenix::vdf_entry* entry = Resources::findFile(name);
   if(entry == nullptr)
     return nullptr;
   phoenix::buffer reader = entry->open();
@@ -576,10 +560,12 @@ Tempest::Sound Resources::implLoadSoundBuffer(std::string_view name) {
   if(name.empty())
     return Tempest::Sound();
 
-  if(!getFileData(name,fBuff))
+  const phoenix::vdf_entry* entry = findFile(name);
+  if(entry==nullptr)
     return Tempest::Sound();
   try {
-    Tempest::MemReader rd(fBuff.data(),fBuff.size());
+    auto               data = entry->open();
+    Tempest::MemReader rd((uint8_t*)data.array(),data.limit());
     return Tempest::Sound(rd);
     }
   catch(...) {
@@ -637,10 +623,11 @@ GthFont &Resources::implLoadFont(std::string_view name, FontType type) {
       break;
     }
 
-  const phoenix::vdf_entry* entry = Resources::vdfsIndex().find_entry(fnt);
+  const phoenix::vdf_entry* entry = Resources::findFile(fnt);
   if(entry == nullptr)
     throw std::runtime_error("failed to open resource: " + std::string{fnt});
 
+  PinScope pin; // fonts are never released
   auto ptr   = std::make_unique<GthFont>(entry->open(),tex,color);
   GthFont* f = ptr.get();
   gothicFnt[std::make_pair(std::move(cname),type)] = std::move(ptr);
@@ -648,8 +635,61 @@ GthFont &Resources::implLoadFont(std::string_view name, FontType type) {
   }
 
 const Texture2d *Resources::loadTexture(std::string_view name) {
-  std::lock_guard<std::recursive_mutex> g(inst->sync);
-  return inst->implLoadTexture(inst->texCache,name);
+  if(name.empty())
+    return nullptr;
+  // same texture may be loaded by name of compiled one already
+  if(auto alias = compiledTexName(name); !alias.empty())
+    if(auto t = inst->texCache.find(alias))
+      return t;
+  return inst->texCache.get(std::string(name),[name](){
+    return inst->implLoadTexture(name);
+    });
+  }
+
+const Resources::AsyncTexture* Resources::loadTextureAsync(std::string_view name) {
+  if(name.empty())
+    return nullptr;
+  auto cname = std::string(name);
+  auto alias = compiledTexName(cname);
+  // lookup touches texture, so one on screen is not evicted
+  auto find  = [&cname,&alias]() -> const Texture2d* {
+    if(auto t = inst->texCache.find(cname))
+      return t;
+    return alias.empty() ? nullptr : inst->texCache.find(alias);
+    };
+  auto ret   = inst->asyncTexCache.get(cname,[&find](){
+    auto h = std::make_unique<AsyncTexture>();
+    h->tex.store(find());
+    return h;
+    });
+  if(ret==nullptr)
+    return nullptr;
+  if(ret->isReady())
+    find();
+  else if(!ret->queued.exchange(true))
+    inst->texQueue.push(std::move(cname));
+  return ret;
+  }
+
+size_t Resources::flushTextureUploads() {
+  return inst->texQueue.flush(TextureUploadBudget);
+  }
+
+void Resources::implUploadAsync(const std::string& name, Tempest::Pixmap&& pm) {
+  // texCache may have it already, if somebody did load it synchronously in the meantime
+  const Texture2d* t = texCache.get(name,[this,&pm](){
+    return implUploadTexture(pm);
+    });
+  if(auto h = asyncTexCache.find(name)) {
+    h->tex.store(t!=nullptr ? t : &fallback);
+    h->queued.store(false);
+    }
+  }
+
+const Tempest::Texture2d& Resources::AsyncTexture::get() const {
+  if(auto t = tex.load(std::memory_order_acquire))
+    return *t;
+  return Resources::fallbackTexture();
   }
 
 const Texture2d *Resources::loadTexture(std::string_view name, int32_t iv, int32_t ic) {
@@ -723,15 +763,21 @@ Material Resources::loadMaterial(const phoenix::material& src, bool enableAlphaT
 const ProtoMesh* Resources::loadMesh(std::string_view name) {
   if(name.size()==0)
     return nullptr;
-  std::lock_guard<std::recursive_mutex> g(inst->sync);
-  return inst->implLoadMesh(name);
+  auto cname = std::string(name);
+  return inst->aniMeshCache.get(cname,[&cname](){
+    auto t = inst->implLoadMeshMain(cname);
+    if(t==nullptr)
+      Log::e("unable to load mesh \"",cname,"\"");
+    return t;
+    });
   }
 
 const PfxEmitterMesh* Resources::loadEmiterMesh(std::string_view name) {
   if(name.empty())
     return nullptr;
-  std::lock_guard<std::recursive_mutex> g(inst->sync);
-  return inst->implLoadEmiterMesh(name);
+  return inst->emiMeshCache.get(std::string(name),[name](){
+    return inst->implLoadEmiterMesh(name);
+    });
   }
 
 const Skeleton* Resources::loadSkeleton(std::string_view name) {
@@ -743,16 +789,15 @@ const Skeleton* Resources::loadSkeleton(std::string_view name) {
 
 const Animation* Resources::loadAnimation(std::string_view name) {
   auto cname = std::string(name);
-
-  std::lock_guard<std::recursive_mutex> g(inst->sync);
-  auto& cache = inst->animCache;
-  auto it=cache.find(cname);
-  if(it!=cache.end())
-    return it->second.get();
-  auto t       = inst->implLoadAnimation(cname);
-  auto ret     = t.get();
-  cache[cname] = std::move(t);
-  return ret;
+  return inst->animCache.get(cname,[&cname](){
+    auto a = inst->implLoadAnimation(cname);
+    // lazy sequences are read after animation is cached: grow its size, as they come
+    if(a!=nullptr)
+      a->setLoadListener([cname,ptr=a.get()](size_t bytes){
+        inst->animCache.addBytes(cname,ptr,bytes);
+        });
+    return a;
+    });
   }
 
 Tempest::Sound Resources::loadSoundBuffer(std::string_view name) {
@@ -766,24 +811,31 @@ Dx8::PatternList Resources::loadDxMusic(std::string_view name) {
   }
 
 const ProtoMesh* Resources::decalMesh(const phoenix::vob& vob) {
-  std::lock_guard<std::recursive_mutex> g(inst->sync);
-  return inst->implDecalMesh(vob);
+  DecalK key;
+  key.mat         = Material(vob);
+  key.sX          = vob.visual_decal->dimension.x;
+  key.sY          = vob.visual_decal->dimension.y;
+  key.decal2Sided = vob.visual_decal->two_sided;
+
+  if(key.mat.tex==nullptr)
+    return nullptr;
+  return inst->decalMeshCache.get(key,[&key](){
+    return inst->implDecalMesh(key);
+    });
   }
 
 const Resources::VobTree* Resources::loadVobBundle(std::string_view name) {
-  std::lock_guard<std::recursive_mutex> g(inst->sync);
-  return inst->implLoadVobBundle(name);
+  return inst->zenCache.get(std::string(name),[name](){
+    return inst->implLoadVobBundle(name);
+    });
   }
 
-const Resources::VobTree* Resources::implLoadVobBundle(std::string_view filename) {
+std::unique_ptr<Resources::VobTree> Resources::implLoadVobBundle(std::string_view filename) {
   auto cname = std::string(filename);
-  auto i     = zenCache.find(cname);
-  if(i!=zenCache.end())
-    return i->second.get();
 
   std::vector<std::unique_ptr<phoenix::vob>> bundle;
   try {
-    const phoenix::vdf_entry* entry = Resources::vdfsIndex().find_entry(cname);
+    const phoenix::vdf_entry* entry = Resources::findFile(cname);
     if (entry == nullptr)
         throw std::runtime_error("failed to open resource: " + cname);
     auto reader = entry->open();
@@ -796,27 +848,127 @@ const Resources::VobTree* Resources::implLoadVobBundle(std::string_view filename
     Log::e("unable to load Zen-file: \"",cname,"\"");
     }
 
-  auto ret = zenCache.insert(std::make_pair(filename,std::make_unique<VobTree>(std::move(bundle))));
-  return ret.first->second.get();
+  return std::make_unique<VobTree>(std::move(bundle));
   }
 
 const AttachBinder *Resources::bindMesh(const ProtoMesh &anim, const Skeleton &s) {
-  std::lock_guard<std::recursive_mutex> g(inst->sync);
-
   if(anim.submeshId.size()==0){
     static AttachBinder empty;
     return &empty;
     }
-  BindK k = BindK(&s,&anim);
+  return inst->bindCache.get(BindK(&s,&anim),[&anim,&s](){
+    return std::unique_ptr<AttachBinder>(new AttachBinder(s,anim));
+    });
+  }
+
+void Resources::startCacheEpoch() {
+  CacheUsage::nextEpoch();
+  }
+
+void Resources::trimCaches() {
+  auto&  r     = *inst;
+  size_t freed = 0;
+  // meshes go first: they keep textures and animations referenced
+  freed += r.aniMeshCache.trim([](const std::string&, const ProtoMesh& m){ inst->dropBinders(m); });
+  freed += r.emiMeshCache.trim([](const std::string&, const PfxEmitterMesh&){});
+  freed += r.texCache    .trim([](const std::string&, const Texture2d& t){ inst->dropDecals(t); inst->dropAsync(t); });
+  freed += r.animCache   .trim([](const std::string&, const Animation&){});
+  freed += r.zenCache    .trim([](const std::string&, const VobTree&){});
+  if(freed>0)
+    Log::i("resources: evicted ",unsigned(freed/1024)," KiB");
+  }
+
+std::vector<AssetManifest::Entry> Resources::usedAssets(uint32_t epoch) {
+  std::vector<std::pair<uint32_t,AssetManifest::Entry>> used;
+  auto collect = [&used,epoch](auto& cache, AssetManifest::Kind kind) {
+    cache.forEachUsed(epoch,[&used,kind](const std::string& name, uint32_t order){
+      used.push_back({order,AssetManifest::Entry{kind,name}});
+      });
+    };
+  collect(inst->texCache,    AssetManifest::Texture);
+  collect(inst->aniMeshCache,AssetManifest::Mesh);
+  collect(inst->animCache,   AssetManifest::Animation);
+  std::sort(used.begin(),used.end(),[](const auto& l, const auto& r){
+    return l.first<r.first;
+    });
+
+  std::vector<AssetManifest::Entry> ret;
+  ret.reserve(used.size());
+  for(auto& u:used)
+    ret.push_back(std::move(u.second));
+  return ret;
+  }
+
+void Resources::dropDecals(const Texture2d& tex) {
+  decalMeshCache.eraseIf([&tex](const DecalK& k){
+    auto& fr = k.mat.frames;
+    return k.mat.tex==&tex || std::find(fr.begin(),fr.end(),&tex)!=fr.end();
+    },[](const DecalK&, const ProtoMesh& m){
+    inst->dropBinders(m);
+    });
+  }
+
+void Resources::dropAsync(const Texture2d& tex) {
+  // handles are never destroyed: reset them, next loadTextureAsync decodes texture again
+  asyncTexCache.forEach([&tex](const std::string&, AsyncTexture& h){
+    const Texture2d* t = &tex;
+    h.tex.compare_exchange_strong(t,nullptr);
+    });
+  }
+
+void Resources::dropBinders(const ProtoMesh& mesh) {
+  const Skeleton* sk = mesh.skeleton.get();
+  bindCache.eraseIf([&mesh,sk](const BindK& k){
+    return std::get<1>(k)==&mesh || (sk!=nullptr && std::get<0>(k)==sk);
+    },[](const BindK&, const AttachBinder&){});
+  }
 
-  auto it = inst->bindCache.find(k);
-  if(it!=inst->bindCache.end())
-    return it->second.get();
+size_t Resources::memoryUsage(const Texture2d& t) {
+  size_t px = size_t(t.w())*size_t(t.h());
+  switch(t.format()) {
+    case TextureFormat::DXT1: px = px/2; break;
+    case TextureFormat::DXT3:
+    case TextureFormat::DXT5: break;
+    default:                  px = px*4; break;
+    }
+  return px + px/3; // mip chain
+  }
+
+size_t Resources::memoryUsage(const ProtoMesh& m) {
+  return m.memoryUsage();
+  }
+
+size_t Resources::memoryUsage(const Animation& a) {
+  return a.memoryUsage();
+  }
+
+size_t Resources::memoryUsage(const PfxEmitterMesh& m) {
+  return m.memoryUsage();
+  }
+
+size_t Resources::memoryUsage(const VobTree& v) {
+  size_t ret = 0;
+  for(auto& i:v)
+    if(i!=nullptr)
+      ret += sizeof(phoenix::vob) + memoryUsage(i->children);
+  return ret;
+  }
+
+std::vector<ConcurrentCacheStats> Resources::cacheStats() {
+  return {
+    inst->texCache      .stats(),
+    inst->aniMeshCache  .stats(),
+    inst->decalMeshCache.stats(),
+    inst->animCache     .stats(),
+    inst->bindCache     .stats(),
+    inst->emiMeshCache  .stats(),
+    inst->zenCache      .stats(),
+    inst->asyncTexCache .stats(),
+    };
+  }
 
-  std::unique_ptr<AttachBinder> ret(new AttachBinder(s,anim));
-  auto p = ret.get();
-  inst->bindCache[k] = std::move(ret);
-  return p;
+TextureQueue::Stats Resources::textureQueueStats() {
+  return inst->texQueue.stats();
   }
 
 Tempest::VertexBuffer<Resources::Vertex> Resources::sphere(int passCount, float R){
@@ -9,10 +9,15 @@
 #include <phoenix/world/vob_tree.hh>
 
 #include <tuple>
+#include <atomic>
 #include <string_view>
 
 #include "graphics/material.h"
+#include "graphics/texturequeue.h"
 #include "sound/soundfx.h"
+#include "utils/assetmanifest.h"
+#include "utils/concurrentcache.h"
+#include "utils/vdfsindex.h"
 
 class StaticMesh;
 class ProtoMesh;
@@ -76,7 +81,24 @@ class Resources final {
       Tempest::Vec3 color;
       };
 
-    using VobTree = std::vector<std::unique_ptr<phoenix::vob>>;
+    using VobTree  = std::vector<std::unique_ptr<phoenix::vob>>;
+    // assets, looked up within this scope, are never evicted; for holders, that outlive world change
+    using PinScope = CacheUsage::PinScope;
+    // lookups within this scope load assets ahead of time, without marking them as used by the world
+    using PrefetchScope = CacheUsage::PrefetchScope;
+
+    // texture, that is decoded in background; fallbackTexture() is used until upload
+    class AsyncTexture final {
+      public:
+        const Tempest::Texture2d& get() const;
+        bool                      isReady() const { return tex.load(std::memory_order_acquire)!=nullptr; }
+
+      private:
+        std::atomic<const Tempest::Texture2d*> tex{nullptr};    // reset, when texture is evicted
+        std::atomic<bool>                      queued{false};
+
+      friend class Resources;
+      };
 
     static Tempest::Device&          device() { return inst->dev; }
     static const char*               renderer();
@@ -93,6 +115,9 @@ class Resources final {
     static const Tempest::Texture2d& fallbackBlack();
     static const Tempest::Texture2d* loadTexture(std::string_view name);
     static const Tempest::Texture2d* loadTexture(std::string_view name, int32_t v, int32_t c);
+    static const AsyncTexture*       loadTextureAsync(std::string_view name);
+    // uploads textures decoded by loadTextureAsync; call once per frame, before recording commands
+    static size_t                    flushTextureUploads();
     static       Tempest::Texture2d  loadTexturePm(const Tempest::Pixmap& pm);
     static auto                      loadTextureAnim(std::string_view name) -> std::vector<const Tempest::Texture2d*>;
     static       Material            loadMaterial(const phoenix::material& src, bool enableAlphaTest);
@@ -109,6 +134,16 @@ class Resources final {
 
     static const VobTree*            loadVobBundle(std::string_view name);
 
+    // assets, that are not looked up after this call, are considered unused, once world is loaded
+    static void                      startCacheEpoch();
+    // evicts least recently used assets, until every cache fits into budget; must not run concurrently with loading
+    static void                      trimCaches();
+    // textures, meshes and animations, used since `epoch`, in order of first use
+    static auto                      usedAssets(uint32_t epoch) -> std::vector<AssetManifest::Entry>;
+    // per-cache hit, lock contention and memory counters, since startup
+    static auto                      cacheStats() -> std::vector<ConcurrentCacheStats>;
+    static auto                      textureQueueStats() -> TextureQueue::Stats;
+
     template<class V>
     static Tempest::VertexBuffer<V>  vbo(const V* data,size_t sz){ return inst->dev.vbo(data,sz); }
 
@@ -129,8 +164,11 @@ class Resources final {
 
     static std::vector<uint8_t>      getFileData(std::string_view name);
     static bool                      getFileData(std::string_view name, std::vector<uint8_t>& dat);
+    // view into memory-mapped archive, no copy
     static phoenix::buffer           getFileBuffer(std::string_view name);
     static bool                      hasFile    (std::string_view fname);
+    // O(1) case-insensitive lookup in merged archives
+    static const phoenix::vdf_entry* findFile   (std::string_view fname);
 
     static const phoenix::vdf_file&  vdfsIndex();
 
@@ -139,6 +177,8 @@ class Resources final {
   private:
     static Resources* inst;
 
+    static constexpr size_t TextureUploadBudget = 4*1024*1024; // bytes per frame
+
     struct Archive {
       std::u16string name;
       int64_t        time=0;
@@ -159,25 +199,35 @@ class Resources final {
         }
       };
 
-    using TextureCache = std::unordered_map<std::string,std::unique_ptr<Tempest::Texture2d>>;
-
     int64_t               vdfTimestamp(const std::u16string& name);
     void                  detectVdf(std::vector<Archive>& ret, const std::u16string& root);
 
-    Tempest::Texture2d*   implLoadTexture(TextureCache& cache, std::string_view cname);
-    Tempest::Texture2d*   implLoadTexture(TextureCache& cache, std::string &&name, const phoenix::buffer& data);
-    ProtoMesh*            implLoadMesh(std::string_view name);
+    std::unique_ptr<Tempest::Texture2d> implLoadTexture(std::string_view cname);
+    std::unique_ptr<Tempest::Texture2d> implUploadTexture(const Tempest::Pixmap& pm);
+    static bool           implDecodeTexture(std::string_view cname, Tempest::Pixmap& out);
+    static bool           implDecodeTexture(const phoenix::buffer& data, Tempest::Pixmap& out);
+    void                  implUploadAsync(const std::string& name, Tempest::Pixmap&& pm);
     std::unique_ptr<ProtoMesh> implLoadMeshMain(std::string name);
     std::unique_ptr<Animation> implLoadAnimation(std::string name);
-    ProtoMesh*            implDecalMesh(const phoenix::vob& vob);
+    std::unique_ptr<ProtoMesh> implDecalMesh(const DecalK& key);
     Tempest::Sound        implLoadSoundBuffer(std::string_view name);
     Dx8::PatternList      implLoadDxMusic(std::string_view name);
     GthFont&              implLoadFont(std::string_view fname, FontType type);
-    PfxEmitterMesh*       implLoadEmiterMesh(std::string_view name);
-    const VobTree*        implLoadVobBundle(std::string_view name);
+    std::unique_ptr<PfxEmitterMesh> implLoadEmiterMesh(std::string_view name);
+    std::unique_ptr<VobTree>        implLoadVobBundle(std::string_view name);
 
     Tempest::VertexBuffer<Vertex> sphere(int passCount, float R);
 
+    void                  dropDecals  (const Tempest::Texture2d& tex);
+    void                  dropAsync   (const Tempest::Texture2d& tex);
+    void                  dropBinders (const ProtoMesh& mesh);
+
+    static size_t         memoryUsage(const Tempest::Texture2d& t);
+    static size_t         memoryUsage(const ProtoMesh& m);
+    static size_t         memoryUsage(const Animation& a);
+    static size_t         memoryUsage(const PfxEmitterMesh& m);
+    static size_t         memoryUsage(const VobTree& v);
+
     Tempest::Texture2d fallback, fbZero;
 
     using BindK  = std::tuple<const Skeleton*,const ProtoMesh*>;
@@ -199,23 +249,26 @@ class Resources final {
     Tempest::Device&                  dev;
     Tempest::SoundDevice              sound;
 
-    std::recursive_mutex              sync;
+    std::recursive_mutex              sync; // sound and music
     std::unique_ptr<Dx8::DirectMusic> dxMusic;
     phoenix::vdf_file                 gothicAssets {"Root"};
+    VdfsIndex                         vdfIndex;
 
-    std::vector<uint8_t>              fBuff, ddsBuf;
     Tempest::VertexBuffer<VertexFsq>  fsq;
 
-    TextureCache                                                      texCache;
+    // decals and binders are keyed by pointers: they go away with texture/mesh, they were made of
+    ConcurrentCache<std::string,Tempest::Texture2d>                   texCache       {"textures",   memoryUsage};
+    ConcurrentCache<std::string,AsyncTexture>                         asyncTexCache  {"async textures"};
 
-    std::unordered_map<std::string,std::unique_ptr<ProtoMesh>>        aniMeshCache;
-    std::unordered_map<DecalK,std::unique_ptr<ProtoMesh>,Hash>        decalMeshCache;
-    std::unordered_map<std::string,std::unique_ptr<Skeleton>>         skeletonCache;
-    std::unordered_map<std::string,std::unique_ptr<Animation>>        animCache;
-    std::unordered_map<BindK,std::unique_ptr<AttachBinder>,Hash>      bindCache;
-    std::unordered_map<std::string,std::unique_ptr<PfxEmitterMesh>>   emiMeshCache;
-    std::unordered_map<std::string,std::unique_ptr<VobTree>>          zenCache;
+    ConcurrentCache<std::string,ProtoMesh>                            aniMeshCache   {"meshes",     memoryUsage};
+    ConcurrentCache<DecalK,ProtoMesh,Hash>                            decalMeshCache {"decals",     memoryUsage};
+    ConcurrentCache<std::string,Animation>                            animCache      {"animations", memoryUsage};
+    ConcurrentCache<BindK,AttachBinder,Hash>                          bindCache      {"binders"};
+    ConcurrentCache<std::string,PfxEmitterMesh>                       emiMeshCache   {"emitters",   memoryUsage};
+    ConcurrentCache<std::string,VobTree>                              zenCache       {"bundles",    memoryUsage};
 
     std::recursive_mutex                                              syncFont;
     std::unordered_map<FontK,std::unique_ptr<GthFont>,Hash>           gothicFnt;
+
+    TextureQueue                                                      texQueue;
   };
@@ -13,7 +13,7 @@ ChapterScreen::ChapterScreen() {
   }
 
 void ChapterScreen::show(const Show& s) {
-  back = Resources::loadTexture(s.img);
+  img      = s.img;
   if(!active)
     Gothic::inst().pushPause();
   active   = true;
@@ -27,7 +27,11 @@ void ChapterScreen::show(const Show& s) {
   }
 
 void ChapterScreen::paintEvent(Tempest::PaintEvent &e) {
-  if(!active || !back)
+  if(!active)
+    return;
+  // resolved per frame: texture may be evicted and decoded again
+  auto back = Resources::loadTextureAsync(img);
+  if(back==nullptr)
     return;
 
   enum {
@@ -38,9 +42,12 @@ void ChapterScreen::paintEvent(Tempest::PaintEvent &e) {
   Painter p(e);
   int x = (w()-width )/2;
   int y = (h()-height)/2;
-  p.setBrush(*back);
-  p.drawRect(x,y,width,height,
-             0,0,back->w(),back->h());
+  if(back->isReady()) {
+    auto& tex = back->get();
+    p.setBrush(tex);
+    p.drawRect(x,y,width,height,
+               0,0,tex.w(),tex.h());
+    }
 
   {
   auto& fnt = Resources::font("font_old_20_white.tga",Resources::FontType::Normal);
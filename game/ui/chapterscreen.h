@@ -26,11 +26,10 @@ class ChapterScreen : public Tempest::Widget {
     void paintEvent(Tempest::PaintEvent& e);
 
   private:
-    const Tempest::Texture2d* back=nullptr;
-    bool                      active=false;
-    Tempest::Timer            timer;
+    bool           active=false;
+    Tempest::Timer timer;
 
-    std::string               title, subTitle;
+    std::string    img, title, subTitle;
 
-    void                      close();
+    void           close();
   };
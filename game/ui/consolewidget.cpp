@@ -61,6 +61,7 @@ ConsoleWidget::ConsoleWidget() {
   closeSk = Shortcut(*this,Event::M_NoModifier,Event::K_F2);
   closeSk.onActivated.bind(this,&ConsoleWidget::close);
 
+  Resources::PinScope pin; // ui outlives world
   background = Resources::loadTexture("CONSOLE.TGA");
 
   marvin.print.bind(this,&ConsoleWidget::printLine);
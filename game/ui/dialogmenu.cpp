@@ -41,6 +41,7 @@ bool DialogMenu::Pipe::isFinished() {
 
 DialogMenu::DialogMenu(InventoryMenu &trade)
   :trade(trade), pipe(*this) {
+  Resources::PinScope pin; // ui outlives world
   tex     = Resources::loadTexture("DLG_CHOICE.TGA");
   ambient = Resources::loadTexture("DLG_AMBIENT.TGA");
 
@@ -8,9 +8,18 @@
 
 using namespace Tempest;
 
+static const Texture2d* pageBackground(std::string_view img) {
+  // pages are big images: decoded in background, page shows up once uploaded
+  auto t = Resources::loadTextureAsync(img);
+  if(t==nullptr || !t->isReady() || &t->get()==&Resources::fallbackTexture())
+    return nullptr;
+  return &t->get();
+  }
+
 DocumentMenu::DocumentMenu(const KeyCodec& key)
   :keycodec(key) {
   setFocusPolicy(NoFocus);
+  Resources::PinScope pin; // ui outlives world
   cursor = Resources::loadTexture("U.TGA");
   }
 
@@ -51,7 +60,7 @@ void DocumentMenu::paintEvent(PaintEvent &e) {
 
   float mw = 0, mh = 0;
   for(auto& i:document.pages){
-    auto back = Resources::loadTexture((i.flg&F_Backgr) ? i.img : document.img);
+    auto back = pageBackground((i.flg&F_Backgr) ? i.img : document.img);
     if(!back)
       continue;
     mw += float(back->w());
@@ -71,7 +80,7 @@ void DocumentMenu::paintEvent(PaintEvent &e) {
       fnt = &Resources::font(document.font);
     if(fnt==nullptr)
       fnt = &Resources::font();
-    auto back = Resources::loadTexture((i.flg&F_Backgr) ? i.img : document.img);
+    auto back = pageBackground((i.flg&F_Backgr) ? i.img : document.img);
     if(!back)
       continue;
     auto& mgr = (i.flg&F_Margin) ? i.margins : document.margins;
@@ -266,6 +266,7 @@ GameMenu::GameMenu(MenuRoot &owner, KeyCodec& keyCodec, phoenix::vm &vm, std::st
 
   textBuf.reserve(64);
 
+  Resources::PinScope pin; // menus are reopened in any world
   auto* menuSectionSymbol = vm.find_symbol_by_name(menuSection);
   if (menuSectionSymbol != nullptr) {
     menu = vm.init_instance<phoenix::c_menu>(menuSectionSymbol);
@@ -77,6 +77,7 @@ struct InventoryMenu::RansackPage : InventoryMenu::Page {
 
 InventoryMenu::InventoryMenu(const KeyCodec& key)
   :keycodec(key) {
+  Resources::PinScope pin; // ui outlives world
   slot = Resources::loadTexture("INV_SLOT.TGA");
   selT = Resources::loadTexture("INV_SLOT_HIGHLIGHTED.TGA");
   selU = Resources::loadTexture("INV_SLOT_EQUIPPED.TGA");
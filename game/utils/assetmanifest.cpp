@@ -0,0 +1,98 @@
+#include "assetmanifest.h"
+
+#include <Tempest/File>
+#include <Tempest/Log>
+
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+
+#include "utils/cachedir.h"
+#include "utils/cacheio.h"
+
+namespace {
+
+struct ManifestHeader {
+  char     magic[4] = {'O','G','A','M'};
+  uint32_t version  = 1;
+  uint32_t count    = 0;
+  };
+
+}
+
+std::string AssetManifest::key(std::string_view world) {
+  size_t cut = world.find_last_of("\\/");
+  if(cut!=std::string_view::npos)
+    world = world.substr(cut+1);
+
+  std::string ret;
+  for(auto c:world)
+    ret.push_back(char(std::tolower(c)));
+  return ret;
+  }
+
+std::filesystem::path AssetManifest::path(std::string_view world) {
+  auto dir = CacheDir::dir("manifest");
+  if(dir.empty())
+    return dir;
+  return dir/(key(world) + ".bin");
+  }
+
+AssetManifest AssetManifest::load(std::string_view world) {
+  const auto src = path(world);
+  if(src.empty())
+    return AssetManifest();
+
+  std::vector<uint8_t> file;
+  try {
+    Tempest::RFile fin(src.u16string().c_str());
+    file.resize(fin.size());
+    if(fin.read(file.data(),file.size())!=file.size())
+      return AssetManifest();
+    }
+  catch(...) {
+    return AssetManifest();
+    }
+
+  CacheReader rd;
+  rd.begin = file.data();
+  rd.at    = rd.begin;
+  rd.end   = rd.begin + file.size();
+
+  ManifestHeader ref, hdr;
+  if(!rd.read(hdr) || std::memcmp(hdr.magic,ref.magic,4)!=0 || hdr.version!=ref.version)
+    return AssetManifest();
+  // kind and length of name per entry, at least
+  if(hdr.count>size_t(rd.end-rd.at)/(sizeof(Kind)+sizeof(uint32_t)))
+    return AssetManifest();
+
+  AssetManifest ret;
+  ret.entries.resize(hdr.count);
+  for(auto& e:ret.entries) {
+    if(!rd.read(e.kind) || e.kind>Sound || !rd.readStr(e.name))
+      return AssetManifest();
+    }
+  return ret;
+  }
+
+void AssetManifest::save(std::string_view world) const {
+  CacheWriter    wr;
+  ManifestHeader hdr;
+  hdr.count = uint32_t(entries.size());
+  wr.write(hdr);
+  for(auto& e:entries) {
+    wr.write(e.kind);
+    wr.writeStr(e.name);
+    }
+
+  const auto dst = path(world);
+  if(dst.empty())
+    return;
+  try {
+    Tempest::WFile fout(dst.u16string().c_str());
+    fout.write(wr.data.data(),wr.data.size());
+    }
+  catch(...) {
+    Tempest::Log::e("asset manifest: unable to write \"",dst.string(),"\"");
+    }
+  }
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Assets, that world did look up, in order of first use. Stored per world in "manifest" of cache directory,
+// to be prefetched on next visit.
+class AssetManifest final {
+  public:
+    enum Kind : uint8_t {
+      Texture,
+      Mesh,
+      Animation,
+      Sound,
+      };
+
+    struct Entry final {
+      Kind        kind = Texture;
+      std::string name;
+      };
+
+    std::vector<Entry> entries;
+
+    bool               isEmpty() const { return entries.empty(); }
+
+    // empty manifest, if world was never recorded or file is broken
+    static AssetManifest load(std::string_view world);
+    void                 save(std::string_view world) const;
+    // file name of world in lower case: "NEWWORLD\NEWWORLD.ZEN" and "newworld.zen" is same world
+    static std::string   key(std::string_view world);
+
+  private:
+    static auto          path(std::string_view world) -> std::filesystem::path;
+  };
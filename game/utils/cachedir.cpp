@@ -0,0 +1,100 @@
+#include "cachedir.h"
+
+#include <Tempest/Platform>
+#include <Tempest/Log>
+
+#ifdef __WINDOWS__
+#include <windows.h>
+#include <shlobj.h>
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "commandline.h"
+
+namespace fs = std::filesystem;
+
+static fs::path platformRoot() {
+#if defined(__WINDOWS__)
+  WCHAR path[MAX_PATH]={};
+  if(FAILED(SHGetFolderPathW(NULL, CSIDL_LOCAL_APPDATA, NULL, 0, path)))
+    return fs::path();
+  return fs::path(path)/"OpenGothic"/"cache";
+#elif defined(__OSX__)
+  if(auto home = std::getenv("HOME"))
+    return fs::path(home)/"Library"/"Caches"/"OpenGothic";
+  return fs::path();
+#else
+  if(auto xdg = std::getenv("XDG_CACHE_HOME"); xdg!=nullptr && xdg[0]!='\0')
+    return fs::path(xdg)/"OpenGothic";
+  if(auto home = std::getenv("HOME"))
+    return fs::path(home)/".cache"/"OpenGothic";
+  return fs::path();
+#endif
+  }
+
+const fs::path& CacheDir::root() {
+  static const fs::path ret = []() {
+    auto cmd = CommandLine::inst().cachePath();
+    auto p   = cmd.empty() ? platformRoot() : fs::path(cmd);
+    if(p.empty())
+      Tempest::Log::e("cache: no writable location, on-disk caches are disabled"); else
+      Tempest::Log::i("cache: \"",p.string(),"\"");
+    return p;
+    }();
+  return ret;
+  }
+
+fs::path CacheDir::dir(std::string_view name) {
+  if(root().empty())
+    return fs::path();
+  auto            ret = root()/name;
+  std::error_code ec;
+  fs::create_directories(ret,ec);
+  if(ec)
+    return fs::path();
+  return ret;
+  }
+
+void CacheDir::trim(const fs::path& d, uint64_t maxBytes) {
+  if(maxBytes==0 || d.empty())
+    return;
+
+  struct File {
+    fs::path           path;
+    fs::file_time_type time;
+    uint64_t           size = 0;
+    };
+
+  std::error_code   ec;
+  std::vector<File> files;
+  uint64_t          total = 0;
+  for(auto& e:fs::directory_iterator(d,ec)) {
+    if(!e.is_regular_file(ec))
+      continue;
+    File f;
+    f.path = e.path();
+    f.time = e.last_write_time(ec);
+    f.size = e.file_size(ec);
+    if(ec)
+      continue;
+    total += f.size;
+    files.push_back(std::move(f));
+    }
+  if(total<=maxBytes)
+    return;
+
+  std::sort(files.begin(),files.end(),[](const File& l, const File& r){
+    return l.time<r.time;
+    });
+  uint64_t freed = 0;
+  for(auto& f:files) {
+    if(total-freed<=maxBytes)
+      break;
+    if(fs::remove(f.path,ec))
+      freed += f.size;
+    }
+  Tempest::Log::i("cache: removed ",int(freed/(1024*1024))," MiB of old files from \"",d.filename().string(),"\"");
+  }
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+// Location of on-disk caches: landscape collision, packed assets and asset manifests.
+// Per-user cache directory of the platform by default; `-cache <path>` on command line overrides it.
+namespace CacheDir {
+  // empty, if there is no known writable location: caches are not stored then
+  const std::filesystem::path& root();
+  // sub-directory of cache root, created on demand; empty on failure
+  std::filesystem::path        dir(std::string_view name);
+  // removes least recently written files of `d`, until total size is below `maxBytes`; 0 - unlimited
+  void                         trim(const std::filesystem::path& d, uint64_t maxBytes);
+  }
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Raw binary layout of on-disk caches. Data is written in native endianness:
+// every cache header carries enough sizes/versions, to reject files from another build.
+struct CacheWriter {
+  std::vector<uint8_t> data;
+
+  void write(const void* v, size_t sz) {
+    auto p = reinterpret_cast<const uint8_t*>(v);
+    data.insert(data.end(),p,p+sz);
+    }
+  template<class T>
+  void write(const T& v) {
+    static_assert(std::is_trivially_copyable<T>::value);
+    write(&v,sizeof(v));
+    }
+  void writeStr(std::string_view s) {
+    write(uint32_t(s.size()));
+    write(s.data(),s.size());
+    }
+  template<class T>
+  void writeVec(const std::vector<T>& v) {
+    static_assert(std::is_trivially_copyable<T>::value);
+    write(uint32_t(v.size()));
+    write(v.data(),v.size()*sizeof(T));
+    }
+  // align to 16 bytes from beginning of the file, for in-place bvh
+  void align() {
+    data.resize((data.size()+15)/16*16);
+    }
+  };
+
+struct CacheReader {
+  const uint8_t* begin = nullptr;
+  const uint8_t* at    = nullptr;
+  const uint8_t* end   = nullptr;
+
+  bool read(void* v, size_t sz) {
+    if(size_t(end-at)<sz)
+      return false;
+    if(sz>0)
+      std::memcpy(v,at,sz);
+    at += sz;
+    return true;
+    }
+  template<class T>
+  bool read(T& v) {
+    static_assert(std::is_trivially_copyable<T>::value);
+    return read(&v,sizeof(v));
+    }
+  bool readStr(std::string& s) {
+    uint32_t len = 0;
+    if(!read(len) || size_t(end-at)<len)
+      return false;
+    s.assign(reinterpret_cast<const char*>(at),len);
+    at += len;
+    return true;
+    }
+  template<class T>
+  bool readVec(std::vector<T>& v) {
+    static_assert(std::is_trivially_copyable<T>::value);
+    uint32_t count = 0;
+    if(!read(count) || size_t(end-at)/sizeof(T)<count)
+      return false;
+    v.resize(count);
+    return read(v.data(),count*sizeof(T));
+    }
+  void align() {
+    at = begin + (size_t(at-begin)+15)/16*16;
+    if(at>end)
+      at = end;
+    }
+  };
@@ -0,0 +1,75 @@
+#include "concurrentcache.h"
+
+std::atomic<uint32_t>        CacheUsage::epochId{0};
+std::atomic<uint32_t>        CacheUsage::useId{0};
+std::atomic<uint32_t>        CacheUsage::releaseId{0};
+
+static thread_local std::vector<CacheUsage::Node*> loadStack;
+static thread_local uint32_t                       pinDepth = 0;
+static thread_local uint32_t                       prefetchDepth = 0;
+
+CacheUsage::PinScope::PinScope() {
+  ++pinDepth;
+  }
+
+CacheUsage::PinScope::~PinScope() {
+  --pinDepth;
+  }
+
+CacheUsage::PrefetchScope::PrefetchScope() {
+  ++prefetchDepth;
+  }
+
+CacheUsage::PrefetchScope::~PrefetchScope() {
+  --prefetchDepth;
+  }
+
+void CacheUsage::nextEpoch() {
+  epochId.fetch_add(1,std::memory_order_acq_rel);
+  }
+
+bool CacheUsage::isPrefetching() {
+  return prefetchDepth>0;
+  }
+
+bool CacheUsage::isLoading() {
+  return !loadStack.empty();
+  }
+
+void CacheUsage::touch(Node& n) {
+  const uint32_t e = epoch();
+  n.lastUse = e;
+  if(prefetchDepth==0 && (n.useEpoch!=e || n.firstUse==0)) {
+    n.useEpoch = e;
+    n.firstUse = useId.fetch_add(1,std::memory_order_relaxed)+1;
+    }
+  if(pinDepth>0)
+    n.pinned = true;
+  }
+
+void CacheUsage::beginLoad(Node& n) {
+  loadStack.push_back(&n);
+  }
+
+void CacheUsage::endLoad(Node& n) {
+  if(!loadStack.empty() && loadStack.back()==&n)
+    loadStack.pop_back();
+  }
+
+void CacheUsage::addDependency(Node& dep) {
+  if(loadStack.empty())
+    return;
+  auto& deps = loadStack.back()->deps;
+  if(std::find(deps.begin(),deps.end(),&dep)!=deps.end())
+    return;
+  deps.push_back(&dep);
+  dep.refs.fetch_add(1,std::memory_order_acq_rel);
+  }
+
+void CacheUsage::release(Node& n) {
+  if(!n.deps.empty())
+    releaseId.fetch_add(1,std::memory_order_acq_rel);
+  for(auto d:n.deps)
+    d->refs.fetch_sub(1,std::memory_order_acq_rel);
+  n.deps.clear();
+  }
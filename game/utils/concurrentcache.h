@@ -0,0 +1,455 @@
+#pragma once
+
+#include <mutex>
+#include <future>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+#include <Tempest/Log>
+
+struct ConcurrentCacheStats final {
+  const char* name       = "";
+  size_t      size       = 0;
+  size_t      pinned     = 0;
+  size_t      bytes      = 0;
+  size_t      budget     = 0; // 0 - unlimited
+  uint64_t    evicted    = 0;
+  uint64_t    lookups    = 0;
+  uint64_t    hits       = 0;
+  uint64_t    contended  = 0; // shard mutex was held by other thread
+  uint64_t    lockWaitNs = 0;
+  uint64_t    loadWaits  = 0; // key was loading on other thread
+  uint64_t    loadWaitNs = 0;
+  };
+
+// Usage tracking, shared by every ConcurrentCache.
+// Each lookup stamps entry with current epoch; epoch is advanced, once every holder of old entries is gone (world change).
+// Holders, that outlive world change (ui, fonts, definitions), are expected to look assets up within PinScope:
+// such entries are pinned and never evicted.
+// Lookups made while other entry is loading on same thread, make that entry depend on them: dependencies stay,
+// until dependent entry is evicted.
+// Lookups within PrefetchScope keep entry alive for current epoch, but don't count as use: see ConcurrentCache::forEachUsed.
+class CacheUsage final {
+  public:
+    struct Node final {
+      std::atomic<uint32_t> refs{0};  // number of entries, that depend on this one
+      std::vector<Node*>    deps;     // written only while entry is loading
+      uint32_t              lastUse  = 0;
+      uint32_t              useEpoch = 0; // last epoch, entry was used in (not prefetched)
+      uint32_t              firstUse = 0; // order of first use within useEpoch; 0 - never used
+      bool                  pinned   = false;
+      size_t                bytes    = 0;
+      };
+
+    class PinScope final {
+      public:
+        PinScope();
+        ~PinScope();
+        PinScope(const PinScope&) = delete;
+        PinScope& operator = (const PinScope&) = delete;
+      };
+
+    class PrefetchScope final {
+      public:
+        PrefetchScope();
+        ~PrefetchScope();
+        PrefetchScope(const PrefetchScope&) = delete;
+        PrefetchScope& operator = (const PrefetchScope&) = delete;
+      };
+
+    static uint32_t epoch() { return epochId.load(std::memory_order_acquire); }
+    static void     nextEpoch();
+    static bool     isPrefetching();
+    // true, while this thread runs a `load` of some ConcurrentCache::get
+    static bool     isLoading();
+    // advances, when some entry drops its dependencies: entries it depended on may become evictable
+    static uint32_t releases() { return releaseId.load(std::memory_order_acquire); }
+
+  private:
+    static void     touch(Node& n);
+    static void     beginLoad(Node& n);
+    static void     endLoad(Node& n);
+    static void     addDependency(Node& dep);
+    static void     release(Node& n);
+
+    static std::atomic<uint32_t>        epochId;
+    static std::atomic<uint32_t>        useId;
+    static std::atomic<uint32_t>        releaseId;
+
+  template<class K, class V, class Hash, class Eq>
+  friend class ConcurrentCache;
+  };
+
+// Sharded cache of objects, that live until cache is destroyed or evicted by `trim`.
+// Lookups of different keys don't block each other; concurrent requests of same key wait for single load.
+template<class K, class V, class Hash = std::hash<K>, class Eq = std::equal_to<K>>
+class ConcurrentCache final {
+  public:
+    using Stats  = ConcurrentCacheStats;
+    using SizeOf = size_t(*)(const V&);
+
+    explicit ConcurrentCache(const char* name, SizeOf sizeOf = nullptr):name(name), sizeOf(sizeOf){}
+
+    // returns cached value or stores result of `load()` (std::unique_ptr<V>, may be null);
+    // exception from `load` is forwarded to every waiter and nothing is cached.
+    // `load` must not wait on Workers tasks: a waiting worker runs other jobs meanwhile, and those may request
+    // the key in flight - on same thread that yields null, on helper threads it deadlocks
+    template<class F>
+    V*     get(const K& key, const F& load);
+    // value, if it's loaded already; doesn't wait for in-flight load
+    V*     find(const K& key);
+
+    // grows size of loaded entry, if `key` still maps to `value`: for values, that load parts on demand
+    void   addBytes(const K& key, const V* value, size_t n);
+
+    void   setBudget(size_t bytes) { budget = bytes; }
+    bool   isOverBudget() const { return budget>0 && bytes.load(std::memory_order_relaxed)>budget; }
+    // evicts least recently used entries, that are not pinned, not referenced and not used in current epoch,
+    // until cache fits into budget; `onEvict(key,value)` is called before value is destroyed. Returns freed bytes.
+    // Once nothing is evictable, calls are no-op until next epoch or until some dependency is released
+    template<class F>
+    size_t trim(const F& onEvict);
+    // drops every loaded entry, that matches `pred(key)`; entries, that other entries depend on, must not match
+    template<class P, class F>
+    size_t eraseIf(const P& pred, const F& onEvict);
+    // calls `f(key,firstUse)` for every loaded, non-null entry, that was used since `epoch`; shard lock is held during call
+    template<class F>
+    void   forEachUsed(uint32_t epoch, const F& f);
+    // calls `f(key,value)` for every loaded, non-null entry; shard lock is held during call
+    template<class F>
+    void   forEach(const F& f);
+
+    size_t size();
+    Stats  stats();
+
+  private:
+    struct Entry {
+      std::unique_ptr<V>     value;
+      std::shared_future<V*> inFlight; // valid while value is loading
+      std::thread::id        loader;
+      CacheUsage::Node       usage;
+      };
+
+    struct alignas(64) Shard {
+      std::mutex                          sync;
+      std::unordered_map<K,Entry,Hash,Eq> data;
+      };
+
+    static constexpr size_t shardCount = 16;
+
+    Shard&                       shard(const K& key);
+    std::unique_lock<std::mutex> lock(Shard& s);
+    static bool                  isStale(const Entry& e, uint32_t epoch);
+    static uint64_t              nsSince(std::chrono::steady_clock::time_point t);
+
+    const char*           name   = "";
+    SizeOf                sizeOf = nullptr;
+    size_t                budget = 0;
+    Shard                 shards[shardCount];
+
+    // state of last trim, that ran out of candidates
+    bool                  trimExhausted = false;
+    uint32_t              trimEpoch     = 0;
+    uint32_t              trimReleases  = 0;
+
+    std::atomic<size_t>   bytes{0};
+    std::atomic<uint64_t> evicted{0};
+    std::atomic<uint64_t> lookups{0}, hits{0};
+    std::atomic<uint64_t> contended{0}, lockWaitNs{0};
+    std::atomic<uint64_t> loadWaits{0}, loadWaitNs{0};
+  };
+
+template<class K, class V, class Hash, class Eq>
+template<class F>
+V* ConcurrentCache<K,V,Hash,Eq>::get(const K& key, const F& load) {
+  lookups.fetch_add(1,std::memory_order_relaxed);
+
+  auto&                           s = shard(key);
+  std::shared_future<V*>          pending;
+  std::optional<std::promise<V*>> promise;
+  Entry*                          loading = nullptr;
+  {
+    auto g  = lock(s);
+    auto it = s.data.find(key);
+    if(it==s.data.end()) {
+      promise.emplace();
+      auto& e    = s.data[key];
+      e.inFlight = promise->get_future().share();
+      e.loader   = std::this_thread::get_id();
+      CacheUsage::touch(e.usage);
+      loading    = &e;
+      }
+    else if(!it->second.inFlight.valid()) {
+      hits.fetch_add(1,std::memory_order_relaxed);
+      CacheUsage::touch(it->second.usage);
+      CacheUsage::addDependency(it->second.usage);
+      return it->second.value.get();
+      }
+    else if(it->second.loader==std::this_thread::get_id()) {
+      // asset depends on itself; waiting would never end
+      if constexpr(std::is_convertible_v<const K&,std::string_view>)
+        Tempest::Log::e("cache \"",name,"\": recursive load of \"",std::string_view(key),"\"");
+      else
+        Tempest::Log::e("cache \"",name,"\": recursive load");
+      return nullptr;
+      }
+    else {
+      pending = it->second.inFlight;
+      }
+  }
+
+  if(pending.valid()) {
+    const auto time0 = std::chrono::steady_clock::now();
+    pending.wait();
+    loadWaits .fetch_add(1,std::memory_order_relaxed);
+    loadWaitNs.fetch_add(nsSince(time0),std::memory_order_relaxed);
+    V* ret = pending.get();
+    {
+      auto g  = lock(s);
+      auto it = s.data.find(key);
+      if(it!=s.data.end() && !it->second.inFlight.valid()) {
+        CacheUsage::touch(it->second.usage);
+        CacheUsage::addDependency(it->second.usage);
+        }
+    }
+    return ret;
+    }
+
+  // only loader erases in-flight entry, so `loading` stays valid
+  std::unique_ptr<V> value;
+  CacheUsage::beginLoad(loading->usage);
+  try {
+    value = load();
+    }
+  catch(...) {
+    CacheUsage::endLoad(loading->usage);
+    CacheUsage::release(loading->usage);
+    {
+      auto g = lock(s);
+      s.data.erase(key);
+    }
+    promise->set_exception(std::current_exception());
+    throw;
+    }
+  CacheUsage::endLoad(loading->usage);
+
+  V*           ret = value.get();
+  const size_t sz  = (ret!=nullptr && sizeOf!=nullptr) ? sizeOf(*ret) : 0;
+  {
+    auto g = lock(s);
+    loading->value       = std::move(value);
+    loading->inFlight    = std::shared_future<V*>();
+    loading->usage.bytes = sz;
+    CacheUsage::addDependency(loading->usage);
+  }
+  bytes.fetch_add(sz,std::memory_order_relaxed);
+  promise->set_value(ret);
+  return ret;
+  }
+
+template<class K, class V, class Hash, class Eq>
+V* ConcurrentCache<K,V,Hash,Eq>::find(const K& key) {
+  auto& s  = shard(key);
+  auto  g  = lock(s);
+  auto  it = s.data.find(key);
+  if(it==s.data.end() || it->second.inFlight.valid())
+    return nullptr;
+  CacheUsage::touch(it->second.usage);
+  return it->second.value.get();
+  }
+
+template<class K, class V, class Hash, class Eq>
+void ConcurrentCache<K,V,Hash,Eq>::addBytes(const K& key, const V* value, size_t n) {
+  auto& s  = shard(key);
+  auto  g  = lock(s);
+  auto  it = s.data.find(key);
+  if(it==s.data.end() || it->second.inFlight.valid() || it->second.value.get()!=value)
+    return;
+  it->second.usage.bytes += n;
+  bytes.fetch_add(n,std::memory_order_relaxed);
+  }
+
+template<class K, class V, class Hash, class Eq>
+template<class F>
+size_t ConcurrentCache<K,V,Hash,Eq>::trim(const F& onEvict) {
+  if(!isOverBudget())
+    return 0;
+
+  const uint32_t epoch = CacheUsage::epoch();
+  if(trimExhausted && trimEpoch==epoch && trimReleases==CacheUsage::releases())
+    return 0;
+
+  struct Candidate {
+    uint32_t lastUse = 0;
+    size_t   shard   = 0;
+    K        key;
+    };
+
+  std::vector<Candidate> cand;
+  for(size_t i=0; i<shardCount; ++i) {
+    auto g = lock(shards[i]);
+    for(auto& [k,e]:shards[i].data)
+      if(isStale(e,epoch))
+        cand.push_back(Candidate{e.usage.lastUse,i,k});
+    }
+  std::stable_sort(cand.begin(),cand.end(),[](const Candidate& l, const Candidate& r){
+    return l.lastUse<r.lastUse;
+    });
+
+  size_t freed = 0;
+  for(auto& c:cand) {
+    if(!isOverBudget())
+      break;
+    std::unique_ptr<V> victim;
+    {
+      auto& s  = shards[c.shard];
+      auto  g  = lock(s);
+      auto  it = s.data.find(c.key);
+      if(it==s.data.end() || !isStale(it->second,epoch))
+        continue;
+      victim = std::move(it->second.value);
+      freed += it->second.usage.bytes;
+      bytes.fetch_sub(it->second.usage.bytes,std::memory_order_relaxed);
+      CacheUsage::release(it->second.usage);
+      s.data.erase(it);
+    }
+    evicted.fetch_add(1,std::memory_order_relaxed);
+    if(victim!=nullptr)
+      onEvict(c.key,*victim);
+    }
+
+  trimExhausted = isOverBudget();
+  trimEpoch     = epoch;
+  trimReleases  = CacheUsage::releases();
+  return freed;
+  }
+
+template<class K, class V, class Hash, class Eq>
+template<class P, class F>
+size_t ConcurrentCache<K,V,Hash,Eq>::eraseIf(const P& pred, const F& onEvict) {
+  size_t count = 0;
+  for(auto& s:shards) {
+    std::vector<std::pair<K,std::unique_ptr<V>>> victims;
+    {
+      auto g = lock(s);
+      for(auto it=s.data.begin(); it!=s.data.end();) {
+        if(it->second.inFlight.valid() || !pred(it->first)) {
+          ++it;
+          continue;
+          }
+        bytes.fetch_sub(it->second.usage.bytes,std::memory_order_relaxed);
+        CacheUsage::release(it->second.usage);
+        victims.emplace_back(it->first,std::move(it->second.value));
+        it = s.data.erase(it);
+        }
+    }
+    for(auto& [k,v]:victims)
+      if(v!=nullptr)
+        onEvict(k,*v);
+    count += victims.size();
+    }
+  evicted.fetch_add(count,std::memory_order_relaxed);
+  return count;
+  }
+
+template<class K, class V, class Hash, class Eq>
+template<class F>
+void ConcurrentCache<K,V,Hash,Eq>::forEachUsed(uint32_t epoch, const F& f) {
+  for(auto& s:shards) {
+    auto g = lock(s);
+    for(auto& [k,e]:s.data)
+      if(e.value!=nullptr && e.usage.firstUse!=0 && e.usage.useEpoch>=epoch)
+        f(k,e.usage.firstUse);
+    }
+  }
+
+template<class K, class V, class Hash, class Eq>
+template<class F>
+void ConcurrentCache<K,V,Hash,Eq>::forEach(const F& f) {
+  for(auto& s:shards) {
+    auto g = lock(s);
+    for(auto& [k,e]:s.data)
+      if(e.value!=nullptr)
+        f(k,*e.value);
+    }
+  }
+
+template<class K, class V, class Hash, class Eq>
+size_t ConcurrentCache<K,V,Hash,Eq>::size() {
+  size_t ret = 0;
+  for(auto& s:shards) {
+    auto g = lock(s);
+    ret += s.data.size();
+    }
+  return ret;
+  }
+
+template<class K, class V, class Hash, class Eq>
+ConcurrentCacheStats ConcurrentCache<K,V,Hash,Eq>::stats() {
+  Stats st;
+  st.name       = name;
+  for(auto& s:shards) {
+    auto g = lock(s);
+    st.size += s.data.size();
+    for(auto& [k,e]:s.data)
+      if(e.usage.pinned)
+        st.pinned++;
+    }
+  st.bytes      = bytes     .load(std::memory_order_relaxed);
+  st.budget     = budget;
+  st.evicted    = evicted   .load(std::memory_order_relaxed);
+  st.lookups    = lookups   .load(std::memory_order_relaxed);
+  st.hits       = hits      .load(std::memory_order_relaxed);
+  st.contended  = contended .load(std::memory_order_relaxed);
+  st.lockWaitNs = lockWaitNs.load(std::memory_order_relaxed);
+  st.loadWaits  = loadWaits .load(std::memory_order_relaxed);
+  st.loadWaitNs = loadWaitNs.load(std::memory_order_relaxed);
+  return st;
+  }
+
+template<class K, class V, class Hash, class Eq>
+typename ConcurrentCache<K,V,Hash,Eq>::Shard& ConcurrentCache<K,V,Hash,Eq>::shard(const K& key) {
+  // some hashes are plain pointers: mix high bits in, to not end up in single shard
+  uint64_t h = uint64_t(Hash()(key));
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  return shards[h%shardCount];
+  }
+
+template<class K, class V, class Hash, class Eq>
+std::unique_lock<std::mutex> ConcurrentCache<K,V,Hash,Eq>::lock(Shard& s) {
+  std::unique_lock<std::mutex> g(s.sync,std::try_to_lock);
+  if(g.owns_lock())
+    return g;
+  const auto time0 = std::chrono::steady_clock::now();
+  g.lock();
+  contended .fetch_add(1,std::memory_order_relaxed);
+  lockWaitNs.fetch_add(nsSince(time0),std::memory_order_relaxed);
+  return g;
+  }
+
+template<class K, class V, class Hash, class Eq>
+bool ConcurrentCache<K,V,Hash,Eq>::isStale(const Entry& e, uint32_t epoch) {
+  return !e.inFlight.valid() &&
+         !e.usage.pinned &&
+         e.usage.lastUse<epoch &&
+         e.usage.refs.load(std::memory_order_acquire)==0;
+  }
+
+template<class K, class V, class Hash, class Eq>
+uint64_t ConcurrentCache<K,V,Hash,Eq>::nsSince(std::chrono::steady_clock::time_point t) {
+  auto dt = std::chrono::steady_clock::now()-t;
+  return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(dt).count());
+  }
@@ -0,0 +1,59 @@
+#include "memoryinfo.h"
+
+#include <Tempest/Platform>
+
+#if defined(__WINDOWS__)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__OSX__) || defined(__IOS__)
+#include <sys/resource.h>
+#include <mach/mach.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#include <cstdio>
+#endif
+
+size_t MemoryInfo::peakRss() {
+#if defined(__WINDOWS__)
+  PROCESS_MEMORY_COUNTERS pmc = {};
+  if(!GetProcessMemoryInfo(GetCurrentProcess(),&pmc,sizeof(pmc)))
+    return 0;
+  return size_t(pmc.PeakWorkingSetSize);
+#else
+  rusage usage = {};
+  if(getrusage(RUSAGE_SELF,&usage)!=0)
+    return 0;
+#if defined(__OSX__) || defined(__IOS__)
+  return size_t(usage.ru_maxrss);      // bytes
+#else
+  return size_t(usage.ru_maxrss)*1024; // kilobytes
+#endif
+#endif
+  }
+
+size_t MemoryInfo::currentRss() {
+#if defined(__WINDOWS__)
+  PROCESS_MEMORY_COUNTERS pmc = {};
+  if(!GetProcessMemoryInfo(GetCurrentProcess(),&pmc,sizeof(pmc)))
+    return 0;
+  return size_t(pmc.WorkingSetSize);
+#elif defined(__OSX__) || defined(__IOS__)
+  mach_task_basic_info_data_t info  = {};
+  mach_msg_type_number_t      count = MACH_TASK_BASIC_INFO_COUNT;
+  if(task_info(mach_task_self(),MACH_TASK_BASIC_INFO,reinterpret_cast<task_info_t>(&info),&count)!=KERN_SUCCESS)
+    return 0;
+  return size_t(info.resident_size);
+#else
+  // second field of statm: resident pages
+  FILE* f = std::fopen("/proc/self/statm","r");
+  if(f==nullptr)
+    return 0;
+  unsigned long size = 0, resident = 0;
+  const int cnt = std::fscanf(f,"%lu %lu",&size,&resident);
+  std::fclose(f);
+  if(cnt!=2)
+    return 0;
+  return size_t(resident)*size_t(sysconf(_SC_PAGESIZE));
+#endif
+  }
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstddef>
+
+namespace MemoryInfo {
+  // peak resident set size of the process, in bytes; 0 if platform doesn't report it
+  size_t peakRss();
+  // current resident set size of the process, in bytes; 0 if platform doesn't report it
+  size_t currentRss();
+  }
@@ -0,0 +1,49 @@
+#include "vdfsindex.h"
+
+static char upper(char c) {
+  return ('a'<=c && c<='z') ? char(c-'a'+'A') : c;
+  }
+
+VdfsIndex::VdfsIndex(const phoenix::vdf_file& vdf) {
+  add(vdf.entries);
+  }
+
+template<class Level>
+void VdfsIndex::add(const Level& level) {
+  // same order as find_entry: entries of a directory first, then nested directories
+  for(auto& i:level) {
+    std::string name = i.name;
+    for(auto& c:name)
+      c = upper(c);
+    files.try_emplace(std::move(name),&i);
+    }
+  for(auto& i:level)
+    if(i.is_directory())
+      add(i.children);
+  }
+
+const phoenix::vdf_entry* VdfsIndex::find(std::string_view name) const {
+  auto it = files.find(name);
+  if(it==files.end())
+    return nullptr;
+  return it->second;
+  }
+
+size_t VdfsIndex::Hash::operator()(std::string_view s) const {
+  // FNV-1a over upper-case characters
+  uint64_t h = 0xcbf29ce484222325ull;
+  for(char c:s) {
+    h ^= uint8_t(upper(c));
+    h *= 0x100000001b3ull;
+    }
+  return size_t(h);
+  }
+
+bool VdfsIndex::Eq::operator()(std::string_view a, std::string_view b) const {
+  if(a.size()!=b.size())
+    return false;
+  for(size_t i=0; i<a.size(); ++i)
+    if(upper(a[i])!=upper(b[i]))
+      return false;
+  return true;
+  }
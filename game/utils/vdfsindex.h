@@ -0,0 +1,45 @@
+#pragma once
+
+#include <phoenix/vdfs.hh>
+
+#include <unordered_map>
+#include <string_view>
+#include <cstdint>
+#include <string>
+
+// Flat index of merged vdf archives: file name (case-insensitive) -> entry.
+// Built once, after every archive is merged; resolves same name the way vdf_file::find_entry does -
+// entries of a directory shadow ones of nested directories. Lookups don't allocate.
+class VdfsIndex final {
+  public:
+    VdfsIndex() = default;
+    explicit VdfsIndex(const phoenix::vdf_file& vdf);
+
+    const phoenix::vdf_entry* find(std::string_view name) const;
+    size_t                    size() const { return files.size(); }
+
+    template<class F>
+    void                      forEach(const F& f) const;
+
+  private:
+    struct Hash {
+      using is_transparent = void;
+      size_t operator()(std::string_view s) const;
+      };
+
+    struct Eq {
+      using is_transparent = void;
+      bool operator()(std::string_view a, std::string_view b) const;
+      };
+
+    template<class Level>
+    void add(const Level& level);
+
+    std::unordered_map<std::string,const phoenix::vdf_entry*,Hash,Eq> files;
+  };
+
+template<class F>
+void VdfsIndex::forEach(const F& f) const {
+  for(auto& [name,e]:files)
+    f(std::string_view(name),*e);
+  }
@@ -1,8 +1,12 @@
 #include "workers.h"
+#include "utils/concurrentcache.h"
 #include "utils/string_frm.h"
 
 #include <Tempest/Log>
 
+#include <cassert>
+#include <chrono>
+
 #if defined(_MSC_VER)
 #include <windows.h>
 
@@ -37,22 +41,160 @@ void setThreadName(const char* threadName){
 void setThreadName(const char* threadName){ (void)threadName; }
 #endif
 
+#if defined(_MSC_VER)
+static void setThreadAffinity(size_t core) {
+  SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << (core%(sizeof(DWORD_PTR)*8)));
+  }
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+
+static void setThreadAffinity(size_t core) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(core%CPU_SETSIZE, &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  }
+#else
+static void setThreadAffinity(size_t core) { (void)core; }
+#endif
+
 using namespace Tempest;
 
+static thread_local size_t workerId = size_t(-1);
+
+static size_t           setupThreads = 0;
+static bool             setupPin     = false;
+static std::atomic_bool instCreated{false};
+
+static uint64_t nanoTime() {
+  auto t = std::chrono::steady_clock::now().time_since_epoch();
+  return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(t).count());
+  }
+
+void Workers::WorkQueue::push(Job* j) {
+  std::lock_guard<std::mutex> guard(sync);
+  if(size==ring.size()) {
+    std::vector<Job*> r(std::max<size_t>(64,ring.size()*2));
+    for(size_t i=0; i<size; ++i)
+      r[i] = ring[(head+i)%ring.size()];
+    ring = std::move(r);
+    head = 0;
+    }
+  ring[(head+size)%ring.size()] = j;
+  ++size;
+  }
+
+Workers::Job* Workers::WorkQueue::pop() {
+  std::lock_guard<std::mutex> guard(sync);
+  if(size==0)
+    return nullptr;
+  --size;
+  return ring[(head+size)%ring.size()];
+  }
+
+Workers::Job* Workers::WorkQueue::steal() {
+  std::lock_guard<std::mutex> guard(sync);
+  if(size==0)
+    return nullptr;
+  auto ret = ring[head];
+  head = (head+1)%ring.size();
+  --size;
+  return ret;
+  }
+
+size_t Workers::WorkQueue::remove(const Job* j) {
+  std::lock_guard<std::mutex> guard(sync);
+  size_t kept = 0;
+  for(size_t i=0; i<size; ++i) {
+    auto x = ring[(head+i)%ring.size()];
+    if(x!=j) {
+      ring[(head+kept)%ring.size()] = x;
+      ++kept;
+      }
+    }
+  const size_t ret = size-kept;
+  size = kept;
+  return ret;
+  }
+
+void Workers::AsyncJob::run(Workers& owner) {
+  auto keepAlive = std::move(self);
+  func();
+  func = nullptr;
+
+  std::vector<std::shared_ptr<AsyncJob>> nx;
+  {
+    std::lock_guard<std::mutex> guard(sync);
+    done.store(true,std::memory_order_release);
+    nx = std::move(next);
+  }
+  done.notify_all();
+  owner.jobs.fetch_add(1,std::memory_order_relaxed);
+
+  for(auto& i:nx)
+    if(i->pending.fetch_sub(1)==1) {
+      i->self = i;
+      owner.schedule(i.get(),1);
+      }
+  }
+
+void Workers::ParallelJob::exec() {
+  try {
+    body(ctx);
+    }
+  catch(...) {
+    std::lock_guard<std::mutex> guard(errSync);
+    if(error==nullptr)
+      error = std::current_exception();
+    }
+  }
+
+void Workers::ParallelJob::run(Workers& owner) {
+  exec();
+  // NOTE: job is owned by waiting thread, and may be destroyed right after this decrement
+  if(active.fetch_sub(1)==1 && owner.joinWaiters.load()>0) {
+    std::lock_guard<std::mutex> guard(owner.joinSync);
+    owner.joinWait.notify_all();
+    }
+  }
+
+bool Workers::Task::isDone() const {
+  return job==nullptr || job->done.load(std::memory_order_acquire);
+  }
+
+void Workers::Task::wait() const {
+  if(job!=nullptr)
+    Workers::inst().waitFor(*job);
+  }
+
 Workers::Workers() {
-  size_t id=0;
-  for(auto& i:th) {
-    i = std::thread([this,id]() noexcept {
+  instCreated.store(true);
+
+  threadCount = setupThreads;
+  pinThreads  = setupPin;
+  if(threadCount==0) {
+    // calling thread participates in parallel work
+    threadCount = std::max<size_t>(1,std::thread::hardware_concurrency());
+    threadCount = std::max<size_t>(1,threadCount-1);
+    }
+
+  queue.reset(new WorkQueue[threadCount]);
+  th.resize(threadCount);
+  for(size_t id=0; id<threadCount; ++id) {
+    th[id] = std::thread([this,id]() noexcept {
       threadFunc(id);
       });
-    ++id;
     }
+  Log::i("Workers: ",int(threadCount)," threads",(pinThreads ? ", pinned" : ""));
   }
 
 Workers::~Workers() {
-  running   = false;
-  workTasks = MAX_THREADS;
-  execWork();
+  running.store(false);
+  {
+    std::lock_guard<std::mutex> guard(sleepSync);
+    workWait.notify_all();
+  }
   for(auto& i:th)
     i.join();
   }
@@ -62,52 +204,205 @@ Workers &Workers::inst() {
   return w;
   }
 
+void Workers::setup(size_t threads, bool pinThreads) {
+  if(instCreated.load()) {
+    Log::e("Workers: setup must be called before first use");
+    return;
+    }
+  setupThreads = threads;
+  setupPin     = pinThreads;
+  }
+
+Workers::Stats Workers::stats() {
+  auto& w = inst();
+  Stats s;
+  s.calls       = w.calls.load();
+  s.inlineCalls = w.inlineCalls.load();
+  s.jobs        = w.jobs.load();
+  s.steals      = w.steals.load();
+  s.reclaimed   = w.reclaimed.load();
+  s.dispatchNs  = w.dispatchNs.load();
+  s.joinNs      = w.joinNs.load();
+  s.foreignNs   = w.foreignNs.load();
+  return s;
+  }
+
+size_t Workers::maxThreads() {
+  return inst().threadCount+1;
+  }
+
+void Workers::wait(std::initializer_list<Task> tasks) {
+  for(auto& i:tasks)
+    i.wait();
+  }
+
+void Workers::wait(const std::vector<Task>& tasks) {
+  for(auto& i:tasks)
+    i.wait();
+  }
+
 void Workers::threadFunc(size_t id) {
   {
   string_frm tname("Workers [",int(id),"]");
   setThreadName(tname.c_str());
   }
-
-  while(true) {
-    {
-    std::unique_lock<std::mutex> lck(sync);
-    while(!workInc[id])
-      workWait.wait(lck);
-    workInc[id]=false;
+  if(pinThreads) {
+    // core 0 is left for main thread
+    setThreadAffinity(id+1);
     }
+  workerId = id;
+
+  while(running.load(std::memory_order_acquire)) {
+    if(auto job = takeJob(id)) {
+      job->run(*this);
+      continue;
+      }
 
-    if(!running) {
-      workDone.fetch_add(1);
-      return;
+    bool hasWork = false;
+    for(int i=0; i<64 && !hasWork; ++i) {
+      hasWork = pendingJobs.load()>0;
+      if(!hasWork)
+        std::this_thread::yield();
       }
+    if(hasWork)
+      continue;
+
+    std::unique_lock<std::mutex> lck(sleepSync);
+    sleeping.fetch_add(1);
+    workWait.wait(lck,[this](){ return pendingJobs.load()>0 || !running.load(); });
+    sleeping.fetch_sub(1);
+    }
+  }
+
+Workers::Task Workers::spawn(const Task* deps, size_t depsCount, std::function<void()>&& func) {
+  auto job  = std::make_shared<AsyncJob>();
+  job->func = std::move(func);
+
+  for(size_t i=0; i<depsCount; ++i) {
+    auto& d = deps[i].job;
+    if(d==nullptr)
+      continue;
+    std::lock_guard<std::mutex> guard(d->sync);
+    if(d->done.load())
+      continue;
+    job->pending.fetch_add(1);
+    d->next.push_back(job);
+    }
+
+  if(job->pending.fetch_sub(1)==1) {
+    job->self = job;
+    schedule(job.get(),1);
+    }
+  return Task(std::move(job));
+  }
+
+void Workers::schedule(Job* job, size_t count) {
+  const size_t id = workerId;
+  for(size_t i=0; i<count; ++i) {
+    if(id<threadCount && i==0)
+      queue[id].push(job); else
+      queue[nextQueue.fetch_add(1)%threadCount].push(job);
+    }
 
-    size_t b = std::min((id  )*batchSize, workSize);
-    size_t e = std::min((id+1)*batchSize, workSize);
-    // Log::d("worker: id = ",id," [",b, ", ",e,"]");
+  pendingJobs.fetch_add(int32_t(count));
+  if(sleeping.load()>0) {
+    std::lock_guard<std::mutex> guard(sleepSync);
+    if(count==1)
+      workWait.notify_one(); else
+      workWait.notify_all();
+    }
+  }
 
-    if(b!=e) {
-      void* d = workSet + b*workEltSize;
-      workFunc(d,e-b);
+Workers::Job* Workers::takeJob(size_t self) {
+  if(self<threadCount) {
+    if(auto j = queue[self].pop()) {
+      pendingJobs.fetch_sub(1);
+      return j;
       }
+    }
 
-    if(size_t(workDone.fetch_add(1)+1)==workTasks)
-      std::this_thread::yield();
+  const size_t start = (self<threadCount) ? self+1 : nextQueue.load();
+  for(size_t i=0; i<threadCount; ++i) {
+    size_t victim = (start+i)%threadCount;
+    if(victim==self)
+      continue;
+    if(auto j = queue[victim].steal()) {
+      pendingJobs.fetch_sub(1);
+      steals.fetch_add(1,std::memory_order_relaxed);
+      return j;
+      }
     }
+  return nullptr;
   }
 
-void Workers::execWork() {
-  {
-    std::unique_lock<std::mutex> lck(sync);
-    for(size_t i=0; i<workTasks; ++i)
-      workInc[i]=true;
-    workWait.notify_all();
+bool Workers::runPending() {
+  if(auto job = takeJob(workerId)) {
+    job->run(*this);
+    return true;
+    }
+  return false;
   }
-  std::this_thread::yield();
 
-  while(true) {
-    int expect = int(workTasks);
-    if(workDone.compare_exchange_strong(expect,0,std::memory_order::acq_rel))
-      break;
-    std::this_thread::yield();
+size_t Workers::reclaim(const Job* job) {
+  size_t ret = 0;
+  for(size_t i=0; i<threadCount; ++i)
+    ret += queue[i].remove(job);
+  if(ret>0) {
+    pendingJobs.fetch_sub(int32_t(ret));
+    reclaimed.fetch_add(ret,std::memory_order_relaxed);
     }
+  return ret;
+  }
+
+void Workers::waitFor(AsyncJob& job) {
+  // see ConcurrentCache::get: jobs run meanwhile may request asset, that this thread is loading
+  assert(!CacheUsage::isLoading());
+  const bool isWorker = (workerId<threadCount);
+  if(!isWorker) {
+    // non-worker threads (main thread) never pick up unrelated jobs: those may run for long.
+    // Awaited job itself is taken back and executed here, if no worker has started it yet
+    if(job.pending.load()==0 && reclaim(&job)>0)
+      job.run(*this);
+    while(!job.done.load(std::memory_order_acquire))
+      job.done.wait(false,std::memory_order_acquire);
+    return;
+    }
+  while(!job.done.load(std::memory_order_acquire)) {
+    // other jobs may still appear for this thread to help with
+    const uint64_t t0 = nanoTime();
+    if(runPending())
+      foreignNs.fetch_add(nanoTime()-t0,std::memory_order_relaxed); else
+      std::this_thread::yield();
+    }
+  }
+
+void Workers::runParallel(ParallelJob& job, size_t helpers) {
+  const uint64_t t0 = nanoTime();
+  job.active.store(helpers);
+  schedule(&job,helpers);
+
+  const uint64_t t1 = nanoTime();
+  // exceptions are caught: job lives on this stack and must not unwind, while helpers still reference it
+  job.exec();
+
+  // by now whole range is taken; helper entries, that are still queued, have nothing left to do.
+  // Caller runs nothing but this job: unrelated jobs in queues may take arbitrary long
+  const uint64_t t2      = nanoTime();
+  const size_t   dropped = reclaim(&job);
+  if(dropped>0)
+    job.active.fetch_sub(dropped);
+  if(job.active.load()>0) {
+    std::unique_lock<std::mutex> lck(joinSync);
+    joinWaiters.fetch_add(1);
+    joinWait.wait(lck,[&job](){ return job.active.load()==0; });
+    joinWaiters.fetch_sub(1);
+    }
+  const uint64_t t3 = nanoTime();
+
+  calls     .fetch_add(1,    std::memory_order_relaxed);
+  dispatchNs.fetch_add(t1-t0,std::memory_order_relaxed);
+  joinNs    .fetch_add(t3-t2,std::memory_order_relaxed);
+
+  if(job.error!=nullptr)
+    std::rethrow_exception(job.error);
   }
@@ -3,35 +3,100 @@
 #include <thread>
 #include <mutex>
 #include <vector>
+#include <memory>
 #include <functional>
 #include <atomic>
 #include <algorithm>
 #include <condition_variable>
+#include <exception>
+#include <initializer_list>
 #include <new>
 
 class Workers final {
+  private:
+    struct Job;
+    struct AsyncJob;
+
   public:
     Workers();
     ~Workers();
 
+    // handle to a scheduled job; cheap to copy
+    class Task final {
+      public:
+        Task() = default;
+
+        bool isDone() const;
+        void wait() const;
+
+        explicit operator bool() const { return job!=nullptr; }
+
+      private:
+        Task(std::shared_ptr<AsyncJob> job):job(std::move(job)){}
+        std::shared_ptr<AsyncJob> job;
+
+      friend class Workers;
+      };
+
+    struct Stats final {
+      uint64_t calls       = 0; // parallelFor/parallelTasks dispatched to the pool
+      uint64_t inlineCalls = 0; // too small to dispatch, executed by caller
+      uint64_t jobs        = 0; // async jobs executed
+      uint64_t steals      = 0;
+      uint64_t reclaimed   = 0; // helper entries, taken back unstarted by caller
+      uint64_t dispatchNs  = 0; // call entry -> caller starts own share of work
+      uint64_t joinNs      = 0; // caller done -> last helper done
+      uint64_t foreignNs   = 0; // waiting workers, running unrelated jobs meanwhile
+      };
+
+    // Must be called before first use; threads==0 - autodetect
+    static void setup(size_t threads, bool pinThreads);
+    static auto stats() -> Stats;
+
+    // Schedule `func` to run once every task in `deps` is done.
+    template<class F>
+    static Task async(F&& func) {
+      return inst().spawn(nullptr,0,std::function<void()>(std::forward<F>(func)));
+      }
+
+    template<class F>
+    static Task async(std::initializer_list<Task> deps, F&& func) {
+      return inst().spawn(deps.begin(),deps.size(),std::function<void()>(std::forward<F>(func)));
+      }
+
+    template<class F>
+    static Task async(const std::vector<Task>& deps, F&& func) {
+      return inst().spawn(deps.data(),deps.size(),std::function<void()>(std::forward<F>(func)));
+      }
+
+    // continuation: `func` runs after `t`
+    template<class F>
+    static Task then(const Task& t, F&& func) {
+      return inst().spawn(&t,1,std::function<void()>(std::forward<F>(func)));
+      }
+
+    static void wait(std::initializer_list<Task> tasks);
+    static void wait(const std::vector<Task>& tasks);
+
     template<class T,class F>
     static void parallelFor(T* b, T* e, const F& func) {
-      inst().runParallelFor(b,std::distance(b,e),std::thread::hardware_concurrency(),func);
+      inst().runParallelFor(b,size_t(std::distance(b,e)),size_t(-1),16,func);
       }
 
     template<class T,class F>
     static void parallelFor(std::vector<T>& data, const F& func) {
-      inst().runParallelFor(data.data(),data.size(),std::thread::hardware_concurrency(),func);
+      inst().runParallelFor(data.data(),data.size(),size_t(-1),16,func);
       }
 
     template<class T,class F>
     static void parallelFor(std::vector<T>& data, size_t maxTh, const F& func) {
-      inst().runParallelFor(data.data(),data.size(),maxTh,func);
+      inst().runParallelFor(data.data(),data.size(),maxTh,16,func);
       }
 
     template<class T,class F>
     static void parallelTasks(std::vector<T>& data, const F& func) {
-      inst().runParallelFor2(data.data(),data.size(),std::thread::hardware_concurrency(),func);
+      const size_t increment = (64+sizeof(T)-1)/sizeof(T);
+      inst().runParallelFor(data.data(),data.size(),size_t(-1),increment,func);
       }
 
     template<class F>
@@ -39,92 +104,139 @@ class Workers final {
       inst().runParallelTasks<F>(taskCount,func);
       }
 
-    static uint8_t maxThreads() {
-      uint32_t th = std::thread::hardware_concurrency();
-      if(th>MAX_THREADS)
-        return MAX_THREADS;
-      return uint8_t(th);
-      }
+    // number of threads, that may execute parallel work, including caller
+    static size_t maxThreads();
 
   private:
-    enum { MAX_THREADS=16 };
+    struct Job {
+      virtual ~Job() = default;
+      virtual void run(Workers& owner) = 0;
+      };
+
+    struct AsyncJob final : Job {
+      std::function<void()>                  func;
+      std::atomic<uint32_t>                  pending{1};
+      std::atomic<bool>                      done{false};
+      std::mutex                             sync;
+      std::vector<std::shared_ptr<AsyncJob>> next;
+      std::shared_ptr<AsyncJob>              self; // keeps job alive, while it's in queue
+
+      void run(Workers& owner) override;
+      };
+
+    // Stack-allocated job, queued once per helper thread; no heap allocation per dispatch.
+    struct ParallelJob final : Job {
+      void*               ctx  = nullptr;
+      void              (*body)(void* ctx) = nullptr;
+      std::atomic<size_t> active{0};
+      std::mutex          errSync;
+      std::exception_ptr  error; // first exception, thrown by body on any thread
+
+      void run(Workers& owner) override;
+      void exec();
+      };
+
+    // Per-thread deque: owner pushes and pops at the back, thieves take from the front.
+    struct alignas(64) WorkQueue final {
+      std::mutex        sync;
+      std::vector<Job*> ring;
+      size_t            head = 0;
+      size_t            size = 0;
+
+      void push(Job* j);
+      Job* pop();
+      Job* steal();
+      // take back queued, not started entries of `j`
+      size_t remove(const Job* j);
+      };
 
     void threadFunc(size_t id);
-    void execWork();
+    auto spawn(const Task* deps, size_t depsCount, std::function<void()>&& func) -> Task;
+    void schedule(Job* job, size_t count);
+    auto takeJob(size_t self) -> Job*;
+    bool runPending();
+    size_t reclaim(const Job* job);
+    void waitFor(AsyncJob& job);
+    void runParallel(ParallelJob& job, size_t helpers);
     static Workers& inst();
 
-    template<class T,class F>
-    void runParallelFor(T* data, size_t sz, size_t maxTh, const F& func) {
-      workSet     = reinterpret_cast<uint8_t*>(data);
-      workSize    = sz;
-      workEltSize = sizeof(T);
-
-      workFunc = [&func](void* data,size_t sz) {
-        T* tdata = reinterpret_cast<T*>(data);
-        for(size_t i=0;i<sz;++i)
-          func(tdata[i]);
-        };
-
-      if(maxTh>MAX_THREADS)
-        workTasks = MAX_THREADS; else
-        workTasks = maxTh;
-
-      batchSize = std::max<size_t>(16,(sz+workTasks-1)/workTasks);
-      execWork();
+    // guided scheduling: chunks shrink as the range runs out, to balance the tail
+    static bool nextRange(std::atomic<size_t>& cursor, size_t sz, size_t minBatch, size_t th, size_t& b, size_t& e) {
+      b = cursor.load(std::memory_order_relaxed);
+      while(true) {
+        if(b>=sz)
+          return false;
+        e = std::min(sz, b+std::max(minBatch,(sz-b)/(2*th)));
+        if(cursor.compare_exchange_weak(b,e,std::memory_order_relaxed))
+          return true;
+        }
       }
 
     template<class T,class F>
-    void runParallelFor2(T* data, size_t sz, size_t maxTh, const F& func) {
-      workTasks   = std::min<size_t>(MAX_THREADS, sz);
-      workTasks   = std::min<size_t>(workTasks,  maxTh);
-      workSize    = workTasks;
-      batchSize   = 1;
-      workEltSize = 0;
-
-      workSet     = reinterpret_cast<uint8_t*>(data);
-      taskDone.store(0);
-      workFunc = [this, &func, sz](void* data, size_t /*sz*/) {
-        T* tdata = reinterpret_cast<T*>(data);
-        const size_t increment = (64+sizeof(T)-1)/sizeof(T);
-        while(true) {
-          size_t id = taskDone.fetch_add(increment);
-          for(size_t i=0;i<increment;++i) {
-            if(id+i<sz)
-              func(tdata[id+i]);
-            }
-
-          if(id+increment>=sz)
-            break;
+    void runParallelFor(T* data, size_t sz, size_t maxTh, size_t minBatch, const F& func) {
+      const size_t th = std::min(std::min(maxTh,threadCount+1),(sz+minBatch-1)/minBatch);
+      if(th<=1) {
+        inlineCalls.fetch_add(1,std::memory_order_relaxed);
+        for(size_t i=0; i<sz; ++i)
+          func(data[i]);
+        return;
+        }
+
+      std::atomic<size_t> cursor{0};
+      auto body = [data,sz,minBatch,th,&cursor,&func]() {
+        size_t b = 0, e = 0;
+        while(nextRange(cursor,sz,minBatch,th,b,e)) {
+          for(size_t i=b; i<e; ++i)
+            func(data[i]);
           }
         };
-      execWork();
+      ParallelJob job;
+      job.ctx  = &body;
+      job.body = [](void* ctx){ (*reinterpret_cast<decltype(body)*>(ctx))(); };
+      runParallel(job,th-1);
       }
 
     template<class F>
     void runParallelTasks(size_t taskCount, const F& func) {
-      workTasks   = taskCount;
-      workSize    = taskCount;
-      batchSize   = 1;
-      workSet     = nullptr;
-      workEltSize = 1;
-      workFunc = [&func](void* data, size_t sz) {
-        func(reinterpret_cast<uintptr_t>(data));
+      const size_t th = std::min(taskCount,threadCount+1);
+      if(th<=1) {
+        inlineCalls.fetch_add(1,std::memory_order_relaxed);
+        for(size_t i=0; i<taskCount; ++i)
+          func(uintptr_t(i));
+        return;
+        }
+
+      std::atomic<size_t> cursor{0};
+      auto body = [taskCount,&cursor,&func]() {
+        while(true) {
+          size_t id = cursor.fetch_add(1);
+          if(id>=taskCount)
+            break;
+          func(uintptr_t(id));
+          }
         };
-      execWork();
+      ParallelJob job;
+      job.ctx  = &body;
+      job.body = [](void* ctx){ (*reinterpret_cast<decltype(body)*>(ctx))(); };
+      runParallel(job,th-1);
       }
 
-    std::thread                       th     [MAX_THREADS];
-    bool                              workInc[MAX_THREADS] = {};
+    size_t                            threadCount = 0;
+    bool                              pinThreads  = false;
+    std::vector<std::thread>          th;
+    std::unique_ptr<WorkQueue[]>      queue;
+    std::atomic<size_t>               nextQueue{0};
 
-    bool                              running=true;
+    std::atomic_bool                  running{true};
+    std::atomic<int32_t>              pendingJobs{0};
+    std::atomic<int32_t>              sleeping{0};
+    std::mutex                        sleepSync;
+    std::condition_variable           workWait;
 
-    uint8_t*                          workSet=nullptr;
-    size_t                            workSize=0, batchSize=0, workEltSize=0;
-    size_t                            workTasks=0;
-    std::function<void(void*,size_t)> workFunc;
+    std::atomic<int32_t>              joinWaiters{0};
+    std::mutex                        joinSync;
+    std::condition_variable           joinWait;
 
-    std::mutex                        sync;
-    std::condition_variable           workWait;
-    std::atomic_int                   workDone{0};
-    std::atomic_int                   taskDone{0};
+    std::atomic<uint64_t>             calls{0}, inlineCalls{0}, jobs{0}, steals{0}, reclaimed{0};
+    std::atomic<uint64_t>             dispatchNs{0}, joinNs{0}, foreignNs{0};
   };
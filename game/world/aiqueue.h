@@ -38,6 +38,7 @@ class AiQueue {
     void     pushBack (AiAction&& a);
     void     pushFront(AiAction&& a);
     AiAction pop();
+    auto     front() const -> const AiAction& { return aiActions.front(); }
     int      aiOutputOrderId() const;
 
     void     onWldItemRemoved(const Item& itm);
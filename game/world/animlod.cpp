@@ -0,0 +1,91 @@
+#include "animlod.h"
+
+#include "graphics/worldview.h"
+
+#include <algorithm>
+
+using namespace Tempest;
+
+// distances are in centimeters
+static constexpr float    closeRange   = 1000; // full rate, even when out of view: shadows and sounds nearby
+static constexpr float    fullRange    = 2500;
+static constexpr float    reducedRange = 5000;
+// bounding sphere, for visibility test; a bit bigger than largest monsters
+static constexpr float    boundRadius  = 600;
+
+void AnimLod::beginFrame(const WorldView& wview, bool e) {
+  // camera and frustums are from previous frame, what is fine with margin of `boundRadius`
+  auto& sg = wview.sceneGlobals();
+  auto  vi = sg.view;
+  vi.inverse();
+
+  enabled = e;
+  camPos  = Vec3(vi.at(3,0),vi.at(3,1),vi.at(3,2));
+  view[0] = sg.frustrum[SceneGlobals::V_Main];
+  view[1] = sg.frustrum[SceneGlobals::V_Shadow0];
+  }
+
+void AnimLod::endFrame() {
+  Stats st;
+  for(size_t i=0; i<L_Count; ++i)
+    st.count[i] = cnt.count[i].exchange(0);
+  st.evaluated = cnt.evaluated.exchange(0);
+  st.skipped   = cnt.skipped.exchange(0);
+  st.culled    = cnt.culled.exchange(0);
+
+  const uint64_t ns = cnt.evalNs.exchange(0);
+  if(st.evaluated>0) {
+    const double cost = double(ns)/double(st.evaluated);
+    avgNs = (avgNs==0 ? cost : avgNs*0.95 + cost*0.05);
+    }
+  const double lerp = double(cnt.lerpNs.exchange(0));
+  st.evalUs  = ns/1000;
+  st.savedUs = uint64_t(std::max(0.0,avgNs*double(st.skipped)-lerp)/1000.0);
+  last = st;
+  }
+
+AnimLod::Level AnimLod::level(const Vec3& pos, bool force) const {
+  if(!enabled || force)
+    return L_Full;
+
+  const float dist = (pos-camPos).quadLength();
+  if(dist<closeRange*closeRange)
+    return L_Full;
+  if(!view[0].testPoint(pos,boundRadius) && !view[1].testPoint(pos,boundRadius))
+    return L_Culled;
+  if(dist<fullRange*fullRange)
+    return L_Full;
+  if(dist<reducedRange*reducedRange)
+    return L_Reduced;
+  return L_Far;
+  }
+
+uint64_t AnimLod::interval(Level lvl) {
+  switch(lvl) {
+    case L_Full:    return 0;
+    case L_Reduced: return 50;
+    case L_Far:     return 100;
+    case L_Culled:  return 250;
+    case L_Count:   break;
+    }
+  return 0;
+  }
+
+bool AnimLod::isDue(Level lvl, const Slot& s, uint64_t tickCount) {
+  if(lvl!=L_Culled && s.poseDirty)
+    return true; // became visible: don't show stale pose
+  return s.lastEval+interval(lvl)<=tickCount;
+  }
+
+void AnimLod::commit(Level lvl, bool evaluated, bool uploadSkipped, std::chrono::nanoseconds time) {
+  cnt.count[lvl].fetch_add(1,std::memory_order_relaxed);
+  if(evaluated) {
+    cnt.evaluated.fetch_add(1,std::memory_order_relaxed);
+    cnt.evalNs.fetch_add(uint64_t(time.count()),std::memory_order_relaxed);
+    } else {
+    cnt.skipped.fetch_add(1,std::memory_order_relaxed);
+    cnt.lerpNs.fetch_add(uint64_t(time.count()),std::memory_order_relaxed);
+    }
+  if(uploadSkipped)
+    cnt.culled.fetch_add(1,std::memory_order_relaxed);
+  }
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <Tempest/Vec>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "graphics/dynamic/frustrum.h"
+
+class WorldView;
+
+// Level of detail for skeletal animation: poses of objects, that are far away or out of view, are evaluated
+// less often. Culled objects keep evaluating pose (for bones, attaches and physics), but don't upload it.
+class AnimLod final {
+  public:
+    enum Level : uint8_t {
+      L_Full,    // close, or visible and near: every frame
+      L_Reduced, // visible, mid range
+      L_Far,     // visible, far away
+      L_Culled,  // not visible in main view and near shadow cascade
+      L_Count
+      };
+
+    struct Stats final {
+      uint32_t count[L_Count] = {};
+      uint32_t evaluated      = 0;
+      uint32_t skipped        = 0; // poses with lod interval not passed yet
+      uint32_t culled         = 0; // pose uploads, skipped for culled objects
+      uint64_t evalUs         = 0; // cpu time spent on pose evaluation, all threads
+      uint64_t savedUs        = 0; // skipped poses, at average cost of evaluation, minus cost of blending
+      };
+
+    // per-object state
+    struct Slot final {
+      uint64_t lastEval  = 0;
+      bool     poseDirty = false; // evaluated or moved while culled, not uploaded yet
+      bool     culled    = false; // level of last update
+      bool     moved     = false; // bones follow new object matrix, attaches don't yet
+      };
+
+    void     beginFrame(const WorldView& view, bool enabled);
+    void     endFrame();
+
+    // `force` - keep full rate, regardless of distance (player)
+    Level    level(const Tempest::Vec3& pos, bool force) const;
+    static uint64_t interval(Level lvl);
+    static bool     isDue(Level lvl, const Slot& s, uint64_t tickCount);
+
+    // `time` - cpu time of evaluation, or of blending for skipped pose
+    void     commit(Level lvl, bool evaluated, bool uploadSkipped, std::chrono::nanoseconds time);
+    auto     stats() const -> const Stats& { return last; }
+
+  private:
+    struct Counters final {
+      std::atomic<uint32_t> count[L_Count] = {};
+      std::atomic<uint32_t> evaluated{0};
+      std::atomic<uint32_t> skipped{0};
+      std::atomic<uint32_t> culled{0};
+      std::atomic<uint64_t> evalNs{0};
+      std::atomic<uint64_t> lerpNs{0};
+      };
+
+    bool          enabled = true;
+    Tempest::Vec3 camPos;
+    Frustrum      view[2];
+    Counters      cnt;
+    Stats         last;
+    double        avgNs = 0;
+  };
@@ -0,0 +1,176 @@
+#include "bsprooms.h"
+
+#include <unordered_map>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+void BspRooms::build(const phoenix::bsp_tree& tree) {
+  bsp = &tree;
+  leafRoom.assign(tree.nodes.size(),NoRoom);
+  shared.clear();
+
+  std::unordered_map<std::string_view,uint32_t> interned;
+  std::vector<std::vector<uint32_t>>            leafSectors(tree.nodes.size());
+  for(size_t i=0; i<tree.sectors.size(); ++i) {
+    auto& sec = tree.sectors[i];
+    if(sec.name.empty())
+      continue;
+    auto  id  = interned.emplace(sec.name,uint32_t(i)).first->second;
+    for(auto r:sec.node_indices) {
+      if(r>=tree.leaf_node_indices.size())
+        continue;
+      size_t idx = tree.leaf_node_indices[r];
+      if(idx>=tree.nodes.size())
+        continue;
+      auto& ls = leafSectors[idx];
+      if(std::find(ls.begin(),ls.end(),id)==ls.end())
+        ls.push_back(id);
+      }
+    }
+
+  for(size_t i=0; i<leafSectors.size(); ++i) {
+    auto& ls = leafSectors[i];
+    if(ls.size()==1)
+      leafRoom[i] = ls[0];
+    else if(ls.size()>1)
+      leafRoom[i] = SharedRoom;
+    }
+  buildShared(leafSectors);
+  }
+
+void BspRooms::buildShared(const std::vector<std::vector<uint32_t>>& leafSectors) {
+  auto& nodes = bsp->nodes;
+  auto  bbox  = [&nodes](size_t id) {
+    auto& b = nodes[id].bbox;
+    return Bbox{{b.min.x,b.min.y,b.min.z},{b.max.x,b.max.y,b.max.z}};
+    };
+
+  // own leaves of every sector, that takes part in a shared leaf
+  std::unordered_map<uint32_t,std::vector<uint32_t>> own;
+  for(size_t i=0; i<leafSectors.size(); ++i)
+    if(leafSectors[i].size()>1)
+      for(auto id:leafSectors[i])
+        own[id];
+  for(size_t i=0; i<leafRoom.size(); ++i) {
+    if(leafRoom[i]>=SharedRoom)
+      continue;
+    if(auto it = own.find(leafRoom[i]); it!=own.end())
+      it->second.push_back(uint32_t(i));
+    }
+
+  // 1cm of tolerance: neighbour leaves share a face
+  const float eps = 1.f;
+  for(size_t i=0; i<leafSectors.size(); ++i) {
+    if(leafSectors[i].size()<=1)
+      continue;
+    const Bbox sh = bbox(i);
+    auto&      cn = shared[uint32_t(i)];
+    for(auto id:leafSectors[i]) {
+      Candidate c;
+      c.room = id;
+      for(auto l:own[id]) {
+        const Bbox b = bbox(l);
+        if(b.min.x<=sh.max.x+eps && sh.min.x<=b.max.x+eps &&
+           b.min.y<=sh.max.y+eps && sh.min.y<=b.max.y+eps &&
+           b.min.z<=sh.max.z+eps && sh.min.z<=b.max.z+eps)
+          c.near.push_back(b);
+        }
+      if(!c.near.empty())
+        cn.push_back(std::move(c));
+      }
+    }
+  }
+
+uint32_t BspRooms::roomAt(const Tempest::Vec3& p) const {
+  float margin = 0;
+  return roomOfLeaf(leafAt(p,margin),p);
+  }
+
+uint32_t BspRooms::roomAt(const Tempest::Vec3& p, Cache& cache) const {
+  if(cache.leaf==uint32_t(-1) || (p-cache.pos).quadLength()>=cache.margin*cache.margin) {
+    cache.pos  = p;
+    cache.leaf = leafAt(p,cache.margin);
+    }
+  return roomOfLeaf(cache.leaf,p);
+  }
+
+void BspRooms::roomAt(const Tempest::Vec3* p, size_t count, uint32_t* out) const {
+  // points of a batch are usually close to each other: share the cache
+  Cache cache;
+  for(size_t i=0; i<count; ++i)
+    out[i] = roomAt(p[i],cache);
+  }
+
+std::string_view BspRooms::name(uint32_t id) const {
+  if(bsp==nullptr || id>=bsp->sectors.size())
+    return "";
+  return bsp->sectors[id].name;
+  }
+
+uint32_t BspRooms::leafAt(const Tempest::Vec3& p, float& margin) const {
+  margin = std::numeric_limits<float>::max();
+  if(bsp==nullptr || bsp->nodes.empty())
+    return uint32_t(-1);
+
+  auto&    nodes = bsp->nodes;
+  uint32_t id    = 0;
+  while(true) {
+    auto& node = nodes[id];
+    if(node.front_index>=nodes.size() && node.back_index>=nodes.size())
+      break;
+
+    const auto  v    = node.plane;
+    const float sgn  = v.x*p.x + v.y*p.y + v.z*p.z - v.w;
+    const float len  = std::sqrt(v.x*v.x + v.y*v.y + v.z*v.z);
+    uint32_t    next = (sgn>0) ? node.front_index : node.back_index;
+    if(len>0) {
+      // 1cm of tolerance for rounding in plane equation
+      margin = std::min(margin, std::max(0.f, std::abs(sgn)/len - 1.f));
+      }
+    if(next>=nodes.size())
+      break;
+    id = next;
+    }
+  return id;
+  }
+
+uint32_t BspRooms::roomOfLeaf(uint32_t leaf, const Tempest::Vec3& p) const {
+  if(leaf>=leafRoom.size())
+    return NoRoom;
+  auto& bbox = bsp->nodes[leaf].bbox;
+  if(bbox.min.x <= p.x && p.x <bbox.max.x &&
+     bbox.min.y <= p.y && p.y <bbox.max.y &&
+     bbox.min.z <= p.z && p.z <bbox.max.z) {
+    if(leafRoom[leaf]==SharedRoom)
+      return roomOfShared(leaf,p);
+    return leafRoom[leaf];
+    }
+  return NoRoom;
+  }
+
+uint32_t BspRooms::roomOfShared(uint32_t leaf, const Tempest::Vec3& p) const {
+  auto it = shared.find(leaf);
+  if(it==shared.end())
+    return NoRoom;
+
+  uint32_t ret  = NoRoom;
+  float    dist = std::numeric_limits<float>::max();
+  for(auto& c:it->second) {
+    for(auto& b:c.near) {
+      const float d = b.qDist(p);
+      if(d<dist || (d==dist && c.room<ret)) {
+        ret  = c.room;
+        dist = d;
+        }
+      }
+    }
+  return ret;
+  }
+
+float BspRooms::Bbox::qDist(const Tempest::Vec3& p) const {
+  const float dx = std::max({min.x-p.x, 0.f, p.x-max.x});
+  const float dy = std::max({min.y-p.y, 0.f, p.y-max.y});
+  const float dz = std::max({min.z-p.z, 0.f, p.z-max.z});
+  return dx*dx + dy*dy + dz*dz;
+  }
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Tempest/Point>
+#include <phoenix/world/bsp_tree.hh>
+
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// BSP leaf -> sector lookup. Sector id is index of the first sector with the same name.
+// Leaf, shared by more than one sector (doorway between rooms), goes to the sector, which own leaves are closest to the point.
+class BspRooms final {
+  public:
+    static constexpr uint32_t NoRoom = uint32_t(-1);
+
+    // Per-object cache: leaf is reused, while the point stays closer to it, than to any splitting plane on the way.
+    struct Cache final {
+      Tempest::Vec3 pos;
+      uint32_t      leaf   = uint32_t(-1);
+      float         margin = 0;
+      };
+
+    void             build(const phoenix::bsp_tree& bsp);
+
+    uint32_t         roomAt(const Tempest::Vec3& p) const;
+    uint32_t         roomAt(const Tempest::Vec3& p, Cache& cache) const;
+    void             roomAt(const Tempest::Vec3* p, size_t count, uint32_t* out) const;
+    std::string_view name(uint32_t id) const;
+
+  private:
+    static constexpr uint32_t SharedRoom = NoRoom-1;
+
+    struct Bbox final {
+      Tempest::Vec3 min, max;
+      float         qDist(const Tempest::Vec3& p) const;
+      };
+
+    // sector of shared leaf, with own leaves, that touch it
+    struct Candidate final {
+      uint32_t          room = NoRoom;
+      std::vector<Bbox> near;
+      };
+
+    const phoenix::bsp_tree*                            bsp = nullptr;
+    std::vector<uint32_t>                               leafRoom;
+    std::unordered_map<uint32_t,std::vector<Candidate>> shared;
+
+    void             buildShared(const std::vector<std::vector<uint32_t>>& leafSectors);
+    uint32_t         leafAt(const Tempest::Vec3& p, float& margin) const;
+    uint32_t         roomOfLeaf(uint32_t leaf, const Tempest::Vec3& p) const;
+    uint32_t         roomOfShared(uint32_t leaf, const Tempest::Vec3& p) const;
+  };
@@ -3,18 +3,19 @@
 
 #include "game/serialize.h"
 
+std::atomic<uint32_t> FpLock::lockEpoch{0};
+
 FpLock::FpLock() {
   }
 
 FpLock::FpLock(const WayPoint &p)
   :pt(&p){
-  pt->useCount++;
+  inc();
   }
 
 FpLock::FpLock(const WayPoint *p)
   :pt(p){
-  if(pt)
-    pt->useCount++;
+  inc();
   }
 
 FpLock::FpLock(FpLock &&other)
@@ -23,13 +24,11 @@ FpLock::FpLock(FpLock &&other)
   }
 
 FpLock::~FpLock() {
-  if(pt)
-    pt->useCount--;
+  dec();
   }
 
 FpLock &FpLock::operator=(FpLock &&other) {
-  if(pt)
-    pt->useCount--;
+  dec();
   pt = other.pt;
   other.pt=nullptr;
   return *this;
@@ -37,10 +36,23 @@ FpLock &FpLock::operator=(FpLock &&other) {
 
 void FpLock::load(Serialize &fin) {
   fin.read(pt);
-  if(pt)
-    pt->useCount++;
+  inc();
   }
 
 void FpLock::save(Serialize &fout) const {
   fout.write(pt);
   }
+
+void FpLock::inc() {
+  if(pt==nullptr)
+    return;
+  pt->useCount++;
+  lockEpoch.fetch_add(1,std::memory_order_relaxed);
+  }
+
+void FpLock::dec() {
+  if(pt==nullptr)
+    return;
+  pt->useCount--;
+  lockEpoch.fetch_add(1,std::memory_order_relaxed);
+  }
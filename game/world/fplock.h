@@ -1,5 +1,8 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+
 class WayPoint;
 class Serialize;
 
@@ -16,6 +19,14 @@ class FpLock final {
     void load(Serialize& fin);
     void save(Serialize& fout) const;
 
+    // bumped on any lock/unlock: think-phase freepoint lookups are dropped, if it changed
+    static uint32_t epoch() { return lockEpoch.load(std::memory_order_relaxed); }
+
   private:
+    void inc();
+    void dec();
+
     const WayPoint* pt=nullptr;
+
+    static std::atomic<uint32_t> lockEpoch;
   };
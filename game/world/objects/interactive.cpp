@@ -187,8 +187,8 @@ void Interactive::setVisual(const phoenix::vob& vob) {
   setAnim(Interactive::Active); // setup default anim
   }
 
-void Interactive::updateAnimation(uint64_t dt) {
-  if(visual.updateAnimation(nullptr,world,dt))
+void Interactive::updateAnimation(uint64_t dt, AnimLod* lod) {
+  if(visual.updateAnimation(nullptr,world,dt,lod))
     animChanged = true;
   }
 
@@ -39,7 +39,7 @@ class Interactive : public Vob {
     void                postValidate();
 
     void                resetPositionToTA(int32_t state);
-    void                updateAnimation(uint64_t dt);
+    void                updateAnimation(uint64_t dt, AnimLod* lod = nullptr);
     void                tick(uint64_t dt);
 
     std::string_view    tag() const;
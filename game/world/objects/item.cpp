@@ -137,14 +137,12 @@ void Item::setAsEquiped(bool e) {
     itSlot=NSLOT;
   }
 
-void Item::setPhysicsEnable(World& world) {
+void Item::setPhysicsEnable(World&) {
   setPhysicsEnable(view);
-  world.invalidateVobIndex();
   }
 
 void Item::setPhysicsDisable() {
   physic = DynamicWorld::Item();
-  world.invalidateVobIndex();
   }
 
 void Item::setPhysicsEnable(const MeshObjects::Mesh& view) {
@@ -314,6 +312,4 @@ void Item::updateMatrix() {
 void Item::moveEvent() {
   view  .setObjMatrix(transform());
   physic.setObjMatrix(transform());
-  if(!isDynamic())
-    world.invalidateVobIndex();
   }
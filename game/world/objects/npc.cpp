@@ -239,6 +239,7 @@ void Npc::load(Serialize &fin, size_t id) {
   fin.read(x,y,z,angle,sz);
   fin.read(wlkMode,trGuild,talentsSk,talentsVl,refuseTalkMilis);
   durtyTranform = TR_Pos|TR_Rot|TR_Scale;
+  roomCache     = BspRooms::Cache();
 
   fin.read(permAttitude,tmpAttitude);
   fin.read(perceptionTime,perceptionNextTime);
@@ -355,6 +356,7 @@ bool Npc::setPosition(float ix, float iy, float iz) {
   z = iz;
   durtyTranform |= TR_Pos;
   physic.setPosition(Vec3{x,y,z});
+  owner.updateNpcIndex(*this);
   return true;
   }
 
@@ -367,6 +369,7 @@ void Npc::setViewPosition(const Tempest::Vec3& pos) {
   y = pos.y;
   z = pos.z;
   durtyTranform |= TR_Pos;
+  owner.updateNpcIndex(*this);
   }
 
 int Npc::aiOutputOrderId() const {
@@ -403,6 +406,7 @@ void Npc::setDirection(float x, float /*y*/, float z) {
 void Npc::setDirection(float rotation) {
   angle = rotation;
   durtyTranform |= TR_Rot;
+  owner.invalidateSense();
   }
 
 void Npc::setDirectionY(float rotation) {
@@ -491,6 +495,7 @@ bool Npc::resetPositionToTA() {
     if(p!=nullptr)
       at=p;
     }
+  roomCache = BspRooms::Cache();
   setPosition (at->x, at->y, at->z);
   setDirection(at->dirX,at->dirY,at->dirZ);
   owner.script().fixNpcPosition(*this,0,0);
@@ -518,6 +523,7 @@ void Npc::setProcessPolicy(ProcessPolicy t) {
 
 void Npc::setWalkMode(WalkBit m) {
   wlkMode = m;
+  owner.invalidateSense();
   }
 
 bool Npc::isPlayer() const {
@@ -566,6 +572,7 @@ bool Npc::checkHealth(bool onChange,bool allowUnconscious) {
   }
 
 void Npc::onNoHealth(bool death, HitSound sndMask) {
+  owner.invalidateSense();
   invent.switchActiveWeapon(*this,Item::NSLOT);
   visual.dropWeapon(*this);
   dropTorch();
@@ -1173,6 +1180,7 @@ bool Npc::isMonster() const {
 
 void Npc::setTrueGuild(int32_t g) {
   trGuild = g;
+  owner.invalidateSense();
   }
 
 int32_t Npc::trueGuild() const {
@@ -1207,6 +1215,7 @@ int32_t Npc::diveTime() const {
 
 void Npc::setAttitude(Attitude att) {
   permAttitude = att;
+  owner.invalidateSense();
   }
 
 bool Npc::isFriend() const {
@@ -1215,6 +1224,7 @@ bool Npc::isFriend() const {
 
 void Npc::setTempAttitude(Attitude att) {
   tmpAttitude = att;
+  owner.invalidateSense();
   }
 
 bool Npc::implPointAt(const Tempest::Vec3& to) {
@@ -1626,14 +1636,14 @@ bool Npc::implAiFlee(uint64_t dt) {
   const WayPoint* wp      = nullptr;
   const float     maxDist = 5*100; // 5 meters
 
-  owner.findWayPoint(position(),[&](const WayPoint& p) {
+  owner.findWayPoints(position()+Tempest::Vec3(0,translateY(),0),maxDist,[&](const WayPoint& p) {
     if(p.useCounter()>0 || qDistTo(&p)>maxDist*maxDist)
-      return false;
+      return;
+    if(wp!=nullptr && oth.qDistTo(&p)<=oth.qDistTo(wp))
+      return;
     if(!canSeeNpc(p.x,p.y+10,p.z,true))
-      return false;
-    if(wp==nullptr || oth.qDistTo(&p)>oth.qDistTo(wp))
-      wp = &p;
-    return false;
+      return;
+    wp = &p;
     });
 
   if(go2.flag!=GT_Flee && go2.flag!=GT_No) {
@@ -1782,7 +1792,19 @@ void Npc::takeDamage(Npc& other, const Bullet* b, const CollideMask bMask, int32
 Npc *Npc::updateNearestEnemy() {
   if(aiPolicy!=ProcessPolicy::AiNormal)
     return nullptr;
+  if(hasPercSense())
+    nearestEnemy = (percSense.enemy!=nullptr && !percSense.enemy->isDown()) ? percSense.enemy : nullptr; else
+    nearestEnemy = findNearestEnemy();
+  return nearestEnemy;
+  }
+
+Npc* Npc::updateNearestBody() {
+  if(aiPolicy!=ProcessPolicy::AiNormal)
+    return nullptr;
+  return hasPercSense() ? percSense.body : findNearestBody();
+  }
 
+Npc* Npc::findNearestEnemy() const {
   Npc*  ret  = nullptr;
   float dist = std::numeric_limits<float>::max();
   if(nearestEnemy!=nullptr &&
@@ -1801,14 +1823,10 @@ Npc *Npc::updateNearestEnemy() {
       dist = d;
       }
     });
-  nearestEnemy = ret;
-  return nearestEnemy;
+  return ret;
   }
 
-Npc* Npc::updateNearestBody() {
-  if(aiPolicy!=ProcessPolicy::AiNormal)
-    return nullptr;
-
+Npc* Npc::findNearestBody() const {
   Npc*  ret  = nullptr;
   float dist = std::numeric_limits<float>::max();
 
@@ -2042,7 +2060,8 @@ void Npc::nextAiAction(AiQueue& queue, uint64_t dt) {
         queue.pushFront(std::move(act));
         break;
         }
-      auto fp = owner.findNextFreePoint(*this,act.s0);
+      auto fp = hasMovePlan(queue,act) ? movePlan.nextFp : owner.findNextFreePoint(*this,act.s0);
+      movePlan.time = uint64_t(-1);
       if(fp!=nullptr) {
         currentFp       = nullptr;
         currentFpLock   = FpLock(*fp);
@@ -2057,7 +2076,10 @@ void Npc::nextAiAction(AiQueue& queue, uint64_t dt) {
         break;
         }
       if(wayPath.last()!=act.point) {
-        wayPath     = owner.wayTo(*this,*act.point);
+        if(hasMovePlan(queue,act))
+          wayPath = std::move(movePlan.path); else
+          wayPath = owner.wayTo(*this,*act.point);
+        movePlan.time = uint64_t(-1);
         auto wpoint = wayPath.pop();
 
         if(wpoint!=nullptr) {
@@ -2211,6 +2233,7 @@ void Npc::nextAiAction(AiQueue& queue, uint64_t dt) {
         }
       break;
     case AI_Teleport: {
+      roomCache = BspRooms::Cache();
       setPosition(act.point->x,act.point->y,act.point->z);
       setDirection(act.point->dirX,act.point->dirY,act.point->dirZ);
       if(isPlayer()) {
@@ -2458,6 +2481,7 @@ bool Npc::startState(ScriptFn id, std::string_view wp, gtime endTime, bool noFin
     // workaround for Pedro removal script
     auto& point = owner.deadPoint();
     attachToPoint(nullptr);
+    roomCache = BspRooms::Cache();
     setPosition(point.position());
     }
 
@@ -3523,6 +3547,72 @@ void Npc::startDialog(Npc& pl) {
     setOther(&pl);
   }
 
+void Npc::perceptionPrepare(const Npc& pl) {
+  // NOTE: called from worker threads - must not modify anything, except percSense
+  percSense = PercSense();
+  if(isPlayer() || processPolicy()!=Npc::AiNormal)
+    return;
+  if(hasPerc(PERC_ASSESSPLAYER))
+    percSense.player = canSenseNpc(pl,false);
+  if(hasPerc(PERC_ASSESSENEMY))
+    percSense.enemy = findNearestEnemy();
+  if(hasPerc(PERC_ASSESSBODY))
+    percSense.body = findNearestBody();
+  percSense.time   = owner.tickCount();
+  percSense.epoch  = owner.senseStamp();
+  percSense.senses = senseSettings();
+  }
+
+bool Npc::hasPercSense() const {
+  // results are dropped, once earlier commits moved, killed or turned someone - same as serial evaluation
+  return percSense.time==owner.tickCount() && percSense.epoch==owner.senseStamp() && percSense.senses==senseSettings();
+  }
+
+void Npc::movePlanPrepare() {
+  // NOTE: called from worker threads - must not modify anything, except movePlan
+  movePlan = MovePlan();
+  if(isPlayer() || aiQueue.size()==0)
+    return;
+
+  auto& act = aiQueue.front();
+  switch(act.act) {
+    case AI_GoToNextFp:
+      movePlan.fp     = act.s0;
+      movePlan.nextFp = owner.findNextFreePoint(*this,act.s0);
+      break;
+    case AI_GoToPoint:
+      if(act.point==nullptr || wayPath.last()==act.point)
+        return;
+      movePlan.point  = act.point;
+      movePlan.path   = owner.wayTo(*this,*act.point);
+      break;
+    default:
+      return;
+    }
+  movePlan.act     = act.act;
+  movePlan.pos     = position();
+  movePlan.posY    = translateY();
+  movePlan.head    = visual.mapHeadBone();
+  movePlan.cur     = currentWayPoint();
+  movePlan.senses  = senseSettings();
+  movePlan.fpEpoch = FpLock::epoch();
+  movePlan.time    = owner.tickCount();
+  }
+
+bool Npc::hasMovePlan(const AiQueue& queue, const AiQueue::AiAction& act) const {
+  // plan is dropped, once earlier commits (or own tick) changed anything lookup depends on - same as serial evaluation
+  const MovePlan& p = movePlan;
+  if(&queue!=&aiQueue || p.time!=owner.tickCount() || p.act!=act.act)
+    return false;
+  if(p.pos!=position() || p.posY!=translateY() || p.head!=visual.mapHeadBone())
+    return false;
+  if(p.cur!=currentWayPoint() || p.senses!=senseSettings())
+    return false;
+  if(act.act==AI_GoToNextFp)
+    return p.fp==act.s0 && p.fpEpoch==FpLock::epoch();
+  return p.point==act.point;
+  }
+
 bool Npc::perceptionProcess(Npc &pl) {
   static bool disable=false;
   if(disable)
@@ -3538,7 +3628,8 @@ bool Npc::perceptionProcess(Npc &pl) {
     }
 
   const float quadDist = pl.qDistTo(*this);
-  if(aiQueue.size()==0 && hasPerc(PERC_ASSESSPLAYER) && canSenseNpc(pl,false)!=SensesBit::SENSE_NONE) {
+  const auto  plSense  = hasPercSense() ? percSense.player : canSenseNpc(pl,false);
+  if(aiQueue.size()==0 && hasPerc(PERC_ASSESSPLAYER) && plSense!=SensesBit::SENSE_NONE) {
     if(perceptionProcess(pl,nullptr,quadDist,PERC_ASSESSPLAYER)) {
       ret = true;
       }
@@ -3564,6 +3655,7 @@ bool Npc::perceptionProcess(Npc &pl) {
 
   if(aiQueue.size()==0)
     perceptionNextTime = owner.tickCount()+perceptionTime;
+  percSense.time = uint64_t(-1);
 
   // TODO: rotate to player
   // if(currentLookAt==nullptr && owner.script().hasImportantInfo(*this,pl,1)) {
@@ -3911,39 +4003,65 @@ bool Npc::canSeeNpc(float tx, float ty, float tz, bool freeLos) const {
   }
 
 SensesBit Npc::canSenseNpc(const Npc &oth, bool freeLos, float extRange) const {
+  const auto q = senseQuery(oth,freeLos,extRange);
+  return senseResult(q, q.ray && owner.physic()->ray(q.from,q.to).hasCol);
+  }
+
+SensesBit Npc::canSenseNpc(float tx, float ty, float tz, bool freeLos, bool isNoisy, float extRange) const {
+  const auto q = senseQuery(tx,ty,tz,freeLos,isNoisy,extRange);
+  return senseResult(q, q.ray && owner.physic()->ray(q.from,q.to).hasCol);
+  }
+
+Npc::SenseQuery Npc::senseQuery(const Npc& oth, bool freeLos, float extRange) const {
   const auto mid     = oth.bounds().midTr;
   const bool isNoisy = (oth.bodyState()&BodyState::BS_SNEAK)==0;
-  return canSenseNpc(mid.x,mid.y,mid.z,freeLos,isNoisy,extRange);
+  return senseQuery(mid.x,mid.y,mid.z,freeLos,isNoisy,extRange);
   }
 
-SensesBit Npc::canSenseNpc(float tx, float ty, float tz, bool freeLos, bool isNoisy, float extRange) const {
-  DynamicWorld* w = owner.physic();
+Npc::SenseQuery Npc::senseQuery(float tx, float ty, float tz, bool freeLos, bool isNoisy, float extRange) const {
   static const double ref = std::cos(100*M_PI/180.0); // spec requires +-100 view angle range
 
+  SenseQuery q;
   const float range = float(hnpc->senses_range)+extRange;
   if(qDistTo(tx,ty,tz)>range*range)
-    return SensesBit::SENSE_NONE;
+    return q;
 
-  SensesBit ret=SensesBit::SENSE_NONE;
-  if(owner.roomAt({tx,ty,tz})==owner.roomAt({x,y,z})) {
-    ret = ret | SensesBit::SENSE_SMELL;
+  if(owner.roomIdAt({tx,ty,tz})==owner.roomIdAt({x,y,z},roomCache)) {
+    q.sense = q.sense | SensesBit::SENSE_SMELL;
     if(isNoisy)
-      ret = ret | SensesBit::SENSE_HEAR;
+      q.sense = q.sense | SensesBit::SENSE_HEAR;
     }
 
-  // npc eyesight height
-  auto head = visual.mapHeadBone();
+  // no ray, if npc can't see at all
+  if((SensesBit(hnpc->senses)&SensesBit::SENSE_SEE)==SensesBit::SENSE_NONE)
+    return q;
   if(!freeLos) {
     float dx  = x-tx, dz=z-tz;
     float dir = angleDir(dx,dz);
     float da  = float(M_PI)*(visual.viewDirection()-dir)/180.f;
-    if(double(std::cos(da))<=ref)
-      if(!w->ray(head, Vec3(tx,ty,tz)).hasCol)
-        ret = ret | SensesBit::SENSE_SEE;
+    q.ray = double(std::cos(da))<=ref;
     } else {
-    if(!w->ray(head, Vec3(tx,ty,tz)).hasCol)
-      ret = ret | SensesBit::SENSE_SEE;
+    q.ray = true;
+    }
+  if(q.ray) {
+    // npc eyesight height
+    q.from = visual.mapHeadBone();
+    q.to   = Vec3(tx,ty,tz);
     }
+  return q;
+  }
+
+Npc::SenseSettings Npc::senseSettings() const {
+  SenseSettings s;
+  s.senses = hnpc->senses;
+  s.range  = hnpc->senses_range;
+  return s;
+  }
+
+SensesBit Npc::senseResult(const SenseQuery& q, bool rayHit) const {
+  SensesBit ret = q.sense;
+  if(q.ray && !rayHit)
+    ret = ret | SensesBit::SENSE_SEE;
   return ret & SensesBit(hnpc->senses);
   }
 
@@ -4029,7 +4147,7 @@ void Npc::updateTransform() {
   updateAnimation(0);
   }
 
-void Npc::updateAnimation(uint64_t dt) {
+void Npc::updateAnimation(uint64_t dt, AnimLod* lod) {
   if(durtyTranform) {
     const auto ground = groundNormal();
     if(lastGroundNormal!=ground) {
@@ -4058,7 +4176,7 @@ void Npc::updateAnimation(uint64_t dt) {
     durtyTranform = 0;
     }
 
-  bool syncAtt = visual.updateAnimation(this,owner,dt);
+  bool syncAtt = visual.updateAnimation(this,owner,dt,lod);
   if(syncAtt)
     visual.syncAttaches();
   }
@@ -14,6 +14,7 @@
 #include "world/aiqueue.h"
 #include "world/fplock.h"
 #include "world/waypath.h"
+#include "world/bsprooms.h"
 
 #include <cstdint>
 #include <string>
@@ -70,6 +71,21 @@ class Npc final {
       CS_Cast_Last   = 47,
       };
 
+    // canSenseNpc, split at line-of-sight test: rays of many queries can be traced as one batch
+    struct SenseQuery final {
+      SensesBit     sense = SensesBit::SENSE_NONE; // smell and hearing
+      bool          ray   = false;                 // sight is up to ray from `from` to `to`
+      Tempest::Vec3 from, to;
+      };
+
+    // sense settings of script instance: scripts write them directly, so think-phase results are checked against them
+    struct SenseSettings final {
+      int32_t senses = 0;
+      int32_t range  = 0;
+      bool operator == (const SenseSettings& o) const { return senses==o.senses && range==o.range; }
+      bool operator != (const SenseSettings& o) const { return !(*this==o); }
+      };
+
     using Anim = AnimationSolver::Anim;
 
     Npc(World &owner, size_t instance, std::string_view waypoint);
@@ -127,7 +143,7 @@ class Npc final {
     float      qDistTo(const Interactive& p) const;
     float      qDistTo(const Item& p) const;
 
-    void       updateAnimation(uint64_t dt);
+    void       updateAnimation(uint64_t dt, AnimLod* lod = nullptr);
     void       updateTransform();
 
     std::string_view displayName() const;
@@ -276,6 +292,8 @@ class Npc final {
     void      setPerceptionEnable (PercType t, size_t fn);
     void      setPerceptionDisable(PercType t);
 
+    void      perceptionPrepare(const Npc& pl);
+    void      movePlanPrepare();
     bool      perceptionProcess(Npc& pl);
     bool      perceptionProcess(Npc& pl, Npc *victum, float quadDist, PercType perc);
     bool      hasPerc(PercType perc) const;
@@ -366,6 +384,10 @@ class Npc final {
     bool      canSeeNpc(float x,float y,float z,bool freeLos) const;
     auto      canSenseNpc(const Npc& oth,bool freeLos, float extRange=0.f) const -> SensesBit;
     auto      canSenseNpc(float x,float y,float z,bool freeLos,bool isNoisy,float extRange=0.f) const -> SensesBit;
+    auto      senseQuery (const Npc& oth,bool freeLos, float extRange=0.f) const -> SenseQuery;
+    auto      senseQuery (float x,float y,float z,bool freeLos,bool isNoisy,float extRange=0.f) const -> SenseQuery;
+    auto      senseSettings() const -> SenseSettings;
+    auto      senseResult(const SenseQuery& q, bool rayHit) const -> SensesBit;
 
     bool      canSeeItem(const Item& it,bool freeLos) const;
 
@@ -423,6 +445,32 @@ class Npc final {
       ScriptFn func;
       };
 
+    // sensing results of think-phase, valid only within the tick, sense-epoch and sense settings they were evaluated with
+    struct PercSense final {
+      SensesBit     player = SensesBit::SENSE_NONE;
+      Npc*          enemy  = nullptr;
+      Npc*          body   = nullptr;
+      uint64_t      time   = uint64_t(-1);
+      uint32_t      epoch  = 0;
+      SenseSettings senses;
+      };
+
+    // route or freepoint for front action of aiQueue, looked up in think-phase
+    struct MovePlan final {
+      Action          act     = AI_None;
+      const WayPoint* point   = nullptr;
+      std::string     fp;
+      const WayPoint* nextFp  = nullptr;
+      WayPath         path;
+      // inputs of lookup: plan is dropped, once any of them changed until commit
+      Tempest::Vec3   pos, head;
+      float           posY    = 0;
+      const WayPoint* cur     = nullptr;
+      SenseSettings   senses;
+      uint32_t        fpEpoch = 0;
+      uint64_t        time    = uint64_t(-1);
+      };
+
     struct GoTo final {
       GoToHint         flag = GoToHint::GT_No;
       Npc*             npc  = nullptr;
@@ -476,6 +524,10 @@ class Npc final {
     void      commitDamage();
     Npc*      updateNearestEnemy();
     Npc*      updateNearestBody();
+    Npc*      findNearestEnemy() const;
+    Npc*      findNearestBody() const;
+    bool      hasPercSense() const;
+    bool      hasMovePlan(const AiQueue& queue, const AiQueue::AiAction& act) const;
     bool      checkHealth(bool onChange, bool forceKill);
     void      onNoHealth(bool death, HitSound sndMask);
     bool      hasAutoroll() const;
@@ -533,6 +585,10 @@ class Npc final {
     uint64_t                       perceptionTime    =0;
     uint64_t                       perceptionNextTime=0;
     Perc                           perception[PERC_Count];
+    PercSense                      percSense;
+    MovePlan                       movePlan;
+    // own position only; perception think-phase gives each npc to one thread. Reset, when npc is placed directly (load, teleport)
+    mutable BspRooms::Cache        roomCache;
 
     // inventory
     Inventory                      invent;
@@ -102,22 +102,8 @@ void Vob::recalculateTransform() {
     } else {
     pos = local;
     }
-  if(old!=position() && !isDynamic()) {
-    switch(vobType) {
-      case phoenix::vob_type::oCMOB:
-      case phoenix::vob_type::oCMobBed:
-      case phoenix::vob_type::oCMobDoor:
-      case phoenix::vob_type::oCMobInter:
-      case phoenix::vob_type::oCMobContainer:
-      case phoenix::vob_type::oCMobSwitch:
-      case phoenix::vob_type::oCMobLadder:
-      case phoenix::vob_type::oCMobWheel:
-        world.invalidateVobIndex();
-        break;
-      default:
-        break;
-      }
-    }
+  if(old!=position())
+    world.updateVobIndex(*this);
   moveEvent();
   for(auto& i:child) {
     i->recalculateTransform();
@@ -8,6 +8,7 @@
 #include <Tempest/Point>
 
 #include "utils/workers.h"
+#include "spatialgrid.h"
 
 class Vob;
 
@@ -15,10 +16,13 @@ class BaseSpaceIndex {
   public:
     void   clear();
     size_t size() const { return arr.size(); }
+    // re-read positions of all objects, i.e. after loading a savegame
     void   invalidate();
+    // re-read position of a single object; no-op, if `v` is not in this index
+    void   move(const Vob* v);
 
   protected:
-    BaseSpaceIndex() = default;
+    BaseSpaceIndex();
     void               add(Vob* v);
     void               del(Vob* v);
     bool               hasObject(const Vob* v) const;
@@ -30,14 +34,8 @@ class BaseSpaceIndex {
     Vob*const*         data() const { return arr.data(); }
 
   private:
-    std::vector<Vob*>  arr;
-    std::vector<Vob*>  index;
-    std::vector<Vob*>  dynamic;
-
-    void               buildIndex();
-    void               buildIndex(Vob** v, size_t cnt, uint8_t depth);
-    void               sort(Vob** v, size_t cnt, uint8_t component);
-    void               implFind(Vob** v, size_t cnt, uint8_t depth, const Tempest::Vec3& p, float R, const void* ctx, void(*func)(const void*, Vob*));
+    std::vector<Vob*> arr;
+    SpatialGrid<Vob>  grid; // also maps object to its slot in `arr`
   };
 
 template<class Func>
@@ -0,0 +1,179 @@
+#include "spatialgrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+BaseSpatialGrid::BaseSpatialGrid(float cellSize)
+  :cellSize(cellSize) {
+  }
+
+void BaseSpatialGrid::clear() {
+  cells.clear();
+  loc.clear();
+  }
+
+void BaseSpatialGrid::insert(void* obj, const Tempest::Vec3& pos, uint32_t order) {
+  if(loc.find(obj)!=loc.end()) {
+    move(obj,pos);
+    reorder(obj,order);
+    return;
+    }
+  auto  key  = cellKey(pos);
+  auto& cell = cells[key];
+  loc[obj] = Loc{key,uint32_t(cell.size())};
+  cell.push_back(Entry{obj,pos,order});
+  }
+
+void BaseSpatialGrid::remove(const void* obj) {
+  auto it = loc.find(obj);
+  if(it==loc.end())
+    return;
+  detach(it->second);
+  loc.erase(it);
+  }
+
+void BaseSpatialGrid::move(const void* obj, const Tempest::Vec3& pos) {
+  auto it = loc.find(obj);
+  if(it==loc.end())
+    return;
+
+  auto  key = cellKey(pos);
+  auto& l   = it->second;
+  if(l.cell==key) {
+    cells[key][l.id].pos = pos;
+    return;
+    }
+
+  const Entry e = cells[l.cell][l.id];
+  detach(l);
+
+  auto& cell = cells[key];
+  l = Loc{key,uint32_t(cell.size())};
+  cell.push_back(Entry{e.obj,pos,e.order});
+  }
+
+void BaseSpatialGrid::reorder(const void* obj, uint32_t order) {
+  auto it = loc.find(obj);
+  if(it==loc.end())
+    return;
+  auto& l = it->second;
+  cells[l.cell][l.id].order = order;
+  }
+
+bool BaseSpatialGrid::hasObject(const void* obj) const {
+  return obj!=nullptr && loc.find(obj)!=loc.end();
+  }
+
+bool BaseSpatialGrid::orderOf(const void* obj, uint32_t& order) const {
+  auto it = loc.find(obj);
+  if(it==loc.end())
+    return false;
+  auto& l = it->second;
+  order = cells.find(l.cell)->second[l.id].order;
+  return true;
+  }
+
+void BaseSpatialGrid::detach(const Loc& l) {
+  auto it = cells.find(l.cell);
+  if(it==cells.end())
+    return;
+  auto& cell = it->second;
+  if(l.id+1u<cell.size()) {
+    cell[l.id] = cell.back();
+    loc[cell[l.id].obj].id = l.id;
+    }
+  cell.pop_back();
+  if(cell.empty())
+    cells.erase(it);
+  }
+
+int32_t BaseSpatialGrid::cellCoord(float v) const {
+  return int32_t(std::floor(v/cellSize));
+  }
+
+uint64_t BaseSpatialGrid::cellKey(const Tempest::Vec3& pos) const {
+  return cellKey(cellCoord(pos.x),cellCoord(pos.z));
+  }
+
+uint64_t BaseSpatialGrid::cellKey(int32_t cx, int32_t cz) {
+  return (uint64_t(uint32_t(cx))<<32) | uint64_t(uint32_t(cz));
+  }
+
+bool BaseSpatialGrid::isCellInCone(int32_t cx, int32_t cz, const Tempest::Vec3& p, const Cone& cone) const {
+  const float vx  = (float(cx)+0.5f)*cellSize - p.x;
+  const float vz  = (float(cz)+0.5f)*cellSize - p.z;
+  const float len = std::sqrt(vx*vx+vz*vz);
+  const float rc  = cellSize*0.7072f; // radius of bounding circle of the cell
+  if(len<=rc)
+    return true;
+  const float cosA = std::clamp((vx*cone.dir.x + vz*cone.dir.y)/len, -1.f, 1.f);
+  return std::acos(cosA) <= cone.ang + std::asin(rc/len);
+  }
+
+void BaseSpatialGrid::find(const Tempest::Vec3& p, float R, const void* ctx, void (*func)(const void*, void*)) const {
+  implFind(p,R,nullptr,ctx,func);
+  }
+
+void BaseSpatialGrid::find(const Tempest::Vec3& p, float R, const Tempest::Vec2& dir, float cosAng,
+                           const void* ctx, void (*func)(const void*, void*)) const {
+  if(cosAng<=-1.f) {
+    implFind(p,R,nullptr,ctx,func);
+    return;
+    }
+  Cone cone;
+  cone.dir = dir;
+  cone.ang = std::acos(std::clamp(cosAng,-1.f,1.f));
+  implFind(p,R,&cone,ctx,func);
+  }
+
+void BaseSpatialGrid::implFind(const Tempest::Vec3& p, float R, const Cone* cone,
+                               const void* ctx, void (*func)(const void*, void*)) const {
+  if(cells.empty() || !(R>0))
+    return;
+
+  const float   qR  = R*R;
+  const int32_t cx0 = cellCoord(p.x-R), cx1 = cellCoord(p.x+R);
+  const int32_t cz0 = cellCoord(p.z-R), cz1 = cellCoord(p.z+R);
+
+  // cells are visited in hash order: matches are reported, once all are known.
+  // Copies, not pointers into cells: callback may insert or move objects, which reallocates cells.
+  // Buffer is shared by nested queries of same thread: each one owns the tail, starting at `base`
+  thread_local std::vector<Hit> hit;
+  const size_t base = hit.size();
+  auto visit = [&](int32_t cx, int32_t cz, const std::vector<Entry>& cell) {
+    if(cone!=nullptr && !isCellInCone(cx,cz,p,*cone))
+      return;
+    for(auto& e:cell)
+      if((e.pos-p).quadLength()<qR)
+        hit.push_back({e.order,e.obj});
+    };
+  auto report = [&]() {
+    std::sort(hit.begin()+ptrdiff_t(base),hit.end(),[](const Hit& l, const Hit& r){ return l.order<r.order; });
+    const size_t end = hit.size();
+    for(size_t i=base; i<end; ++i)
+      func(ctx,hit[i].obj);
+    hit.resize(base);
+    };
+
+  const uint64_t area = uint64_t(int64_t(cx1)-cx0+1)*uint64_t(int64_t(cz1)-cz0+1);
+  if(area>cells.size()) {
+    // large radius: cheaper to walk over populated cells
+    for(auto& [key,cell]:cells) {
+      const int32_t cx = int32_t(uint32_t(key>>32));
+      const int32_t cz = int32_t(uint32_t(key));
+      if(cx<cx0 || cx1<cx || cz<cz0 || cz1<cz)
+        continue;
+      visit(cx,cz,cell);
+      }
+    report();
+    return;
+    }
+
+  for(int32_t cx=cx0; cx<=cx1; ++cx)
+    for(int32_t cz=cz0; cz<=cz1; ++cz) {
+      auto it = cells.find(cellKey(cx,cz));
+      if(it!=cells.end())
+        visit(cx,cz,it->second);
+      }
+  report();
+  }
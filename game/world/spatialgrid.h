@@ -0,0 +1,117 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include <Tempest/Point>
+
+// Uniform hash grid on XZ plane. Objects are moved between cells incrementally,
+// so keeping it in sync costs one hash lookup per position change.
+// Each object carries `order` - its index in owner's array: queries report objects in that order,
+// same as linear scan over the array would, independent of cell layout.
+class BaseSpatialGrid {
+  public:
+    void   clear();
+    size_t size() const { return loc.size(); }
+
+  protected:
+    explicit BaseSpatialGrid(float cellSize);
+
+    void   insert (void* obj, const Tempest::Vec3& pos, uint32_t order);
+    void   remove (const void* obj);
+    void   move   (const void* obj, const Tempest::Vec3& pos);
+    void   reorder(const void* obj, uint32_t order);
+    bool   hasObject(const void* obj) const;
+    // false, if `obj` is not in grid
+    bool   orderOf(const void* obj, uint32_t& order) const;
+
+    // objects with (pos-p).quadLength()<R*R, by ascending order. Matches are collected before first callback:
+    // callback may insert or move objects (not reported then), but must not destroy objects, that are yet to be reported
+    void   find(const Tempest::Vec3& p, float R, const void* ctx, void (*func)(const void*, void*)) const;
+    // same, but cells outside of XZ-cone (dir - normalized, cosAng - cosine of half angle) are skipped
+    void   find(const Tempest::Vec3& p, float R, const Tempest::Vec2& dir, float cosAng,
+                const void* ctx, void (*func)(const void*, void*)) const;
+
+  private:
+    struct Entry {
+      void*         obj   = nullptr;
+      Tempest::Vec3 pos;
+      uint32_t      order = 0;
+      };
+
+    struct Hit {
+      uint32_t order = 0;
+      void*    obj   = nullptr;
+      };
+
+    struct Loc {
+      uint64_t cell = 0;
+      uint32_t id   = 0;
+      };
+
+    struct Cone {
+      Tempest::Vec2 dir;
+      float         ang = 0; // half angle, radians
+      };
+
+    int32_t            cellCoord(float v) const;
+    uint64_t           cellKey(const Tempest::Vec3& pos) const;
+    static uint64_t    cellKey(int32_t cx, int32_t cz);
+    bool               isCellInCone(int32_t cx, int32_t cz, const Tempest::Vec3& p, const Cone& cone) const;
+    void               detach(const Loc& l);
+    void               implFind(const Tempest::Vec3& p, float R, const Cone* cone,
+                                const void* ctx, void (*func)(const void*, void*)) const;
+
+    const float                                     cellSize;
+    std::unordered_map<uint64_t,std::vector<Entry>> cells;
+    std::unordered_map<const void*,Loc>             loc;
+  };
+
+
+template<class T>
+class SpatialGrid final : public BaseSpatialGrid {
+  public:
+    explicit SpatialGrid(float cellSize):BaseSpatialGrid(cellSize){}
+
+    void insert(T* v, const Tempest::Vec3& pos, uint32_t order) {
+      BaseSpatialGrid::insert(v,pos,order);
+      }
+
+    void remove(const T* v) {
+      BaseSpatialGrid::remove(v);
+      }
+
+    void move(const T* v, const Tempest::Vec3& pos) {
+      BaseSpatialGrid::move(v,pos);
+      }
+
+    void reorder(const T* v, uint32_t order) {
+      BaseSpatialGrid::reorder(v,order);
+      }
+
+    bool hasObject(const T* v) const {
+      return BaseSpatialGrid::hasObject(v);
+      }
+
+    bool orderOf(const T* v, uint32_t& order) const {
+      return BaseSpatialGrid::orderOf(v,order);
+      }
+
+    template<class Func>
+    void find(const Tempest::Vec3& p, float R, const Func& f) const {
+      BaseSpatialGrid::find(p,R,&f,[](const void* ctx, void* v){
+        auto& f = *reinterpret_cast<const Func*>(ctx);
+        f(*reinterpret_cast<T*>(v));
+        });
+      }
+
+    template<class Func>
+    void find(const Tempest::Vec3& p, float R, const Tempest::Vec2& dir, float cosAng, const Func& f) const {
+      BaseSpatialGrid::find(p,R,dir,cosAng,&f,[](const void* ctx, void* v){
+        auto& f = *reinterpret_cast<const Func*>(ctx);
+        f(*reinterpret_cast<T*>(v));
+        });
+      }
+  };
+
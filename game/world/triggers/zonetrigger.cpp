@@ -1,5 +1,8 @@
 #include <phoenix/vobs/trigger.hh>
 
+#include <algorithm>
+#include <cmath>
+
 #include "zonetrigger.h"
 
 #include "world/objects/npc.h"
@@ -9,9 +12,36 @@ ZoneTrigger::ZoneTrigger(Vob* parent, World &world, const phoenix::vobs::trigger
   :AbstractTrigger(parent,world,trig,flags){
   levelName = trig.level_name;
   startVobName = trig.start_vob;
+
+  auto& b    = trig.bbox;
+  zoneCenter = Tempest::Vec3(b.max.x+b.min.x,b.max.y+b.min.y,b.max.z+b.min.z)*0.5f;
+  zoneExtent = Tempest::Vec3(b.max.x-b.min.x,b.max.y-b.min.y,b.max.z-b.min.z)*0.5f;
+  // watch for player to come close, to prefetch next world; player, who has just arrived through this zone, must leave it first
+  enableTicks();
   }
 
 void ZoneTrigger::onIntersect(Npc &n) {
   if(n.isPlayer())
     world.triggerChangeWorld(levelName, startVobName);
   }
+
+void ZoneTrigger::tick(uint64_t dt) {
+  AbstractTrigger::tick(dt);
+
+  static const float prefetchDistance = 3000; // 30 meters
+  auto pl = world.player();
+  if(pl==nullptr)
+    return;
+  auto  pos = pl->position();
+  float dx  = std::max(std::abs(pos.x-zoneCenter.x)-zoneExtent.x, 0.f);
+  float dy  = std::max(std::abs(pos.y-zoneCenter.y)-zoneExtent.y, 0.f);
+  float dz  = std::max(std::abs(pos.z-zoneCenter.z)-zoneExtent.z, 0.f);
+  if(dx*dx+dy*dy+dz*dz>prefetchDistance*prefetchDistance) {
+    armed = true;
+    return;
+    }
+  if(!armed)
+    return;
+  world.prefetchWorld(levelName);
+  disableTicks();
+  }
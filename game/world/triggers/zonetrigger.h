@@ -7,8 +7,11 @@ class ZoneTrigger : public AbstractTrigger {
     ZoneTrigger(Vob* parent, World& world, const phoenix::vobs::trigger_change_level& data, Flags flags);
 
     void onIntersect(Npc& n) override;
+    void tick(uint64_t dt) override;
 
   private:
-    std::string levelName;
-    std::string startVobName;
+    std::string   levelName;
+    std::string   startVobName;
+    Tempest::Vec3 zoneCenter, zoneExtent;
+    bool          armed = false;
   };
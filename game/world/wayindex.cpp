@@ -0,0 +1,57 @@
+#include "wayindex.h"
+
+using namespace Tempest;
+
+WayIndex::WayIndex(std::vector<const WayPoint*> pt)
+  :points(std::move(pt)) {
+  if(points.empty())
+    return;
+  nodes.reserve(2*(points.size()/leafSize+1));
+  nodes.emplace_back();
+  nodes[0].end = uint32_t(points.size());
+  build(0);
+  }
+
+float WayIndex::qDist(const Vec3& p, const Vec3& lo, const Vec3& hi) {
+  const float dx = std::max(0.f, std::max(lo.x-p.x, p.x-hi.x));
+  const float dy = std::max(0.f, std::max(lo.y-p.y, p.y-hi.y));
+  const float dz = std::max(0.f, std::max(lo.z-p.z, p.z-hi.z));
+  return dx*dx+dy*dy+dz*dz;
+  }
+
+void WayIndex::build(uint32_t id) {
+  const uint32_t b = nodes[id].begin;
+  const uint32_t e = nodes[id].end;
+
+  Vec3 lo = points[b]->position(), hi = lo;
+  for(uint32_t i=b+1; i<e; ++i) {
+    auto p = points[i]->position();
+    lo = Vec3(std::min(lo.x,p.x),std::min(lo.y,p.y),std::min(lo.z,p.z));
+    hi = Vec3(std::max(hi.x,p.x),std::max(hi.y,p.y),std::max(hi.z,p.z));
+    }
+  nodes[id].lo = lo;
+  nodes[id].hi = hi;
+  if(e-b<=leafSize)
+    return;
+
+  // split by median of the longest axis
+  const Vec3 ext  = hi-lo;
+  const int  axis = (ext.x>=ext.y && ext.x>=ext.z) ? 0 : (ext.y>=ext.z ? 1 : 2);
+  const uint32_t mid = b+(e-b)/2;
+  auto coord = [axis](const WayPoint* w) {
+    return axis==0 ? w->x : (axis==1 ? w->y : w->z);
+    };
+  std::nth_element(points.begin()+b,points.begin()+mid,points.begin()+e,[&coord](const WayPoint* l, const WayPoint* r){
+    return coord(l)<coord(r);
+    });
+
+  const uint32_t child = uint32_t(nodes.size());
+  nodes[id].child = child;
+  nodes.resize(nodes.size()+2);
+  nodes[child  ].begin = b;
+  nodes[child  ].end   = mid;
+  nodes[child+1].begin = mid;
+  nodes[child+1].end   = e;
+  build(child);
+  build(child+1);
+  }
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <Tempest/Point>
+
+#include "waypoint.h"
+
+// Static k-d tree over waypoints. Positions must not change after construction.
+class WayIndex final {
+  public:
+    WayIndex() = default;
+    explicit WayIndex(std::vector<const WayPoint*> points);
+
+    size_t size() const { return points.size(); }
+
+    // Visits points in ascending order of score, until `filter` accepts one.
+    // `metric(lo,hi)` - lower bound of score within a box, `metric(point)` - score of point;
+    // infinity rejects box/point. Equal scores are resolved in favor of lower address.
+    template<class Metric, class Filter>
+    const WayPoint* nearest(const Metric& metric, const Filter& filter) const;
+
+    // all points with (pos-p).quadLength()<=R*R
+    template<class Func>
+    void find(const Tempest::Vec3& p, float R, const Func& func) const;
+
+    static float qDist(const Tempest::Vec3& p, const Tempest::Vec3& lo, const Tempest::Vec3& hi);
+
+  private:
+    struct Node {
+      Tempest::Vec3 lo, hi;
+      uint32_t      begin = 0;
+      uint32_t      end   = 0;
+      uint32_t      child = 0; // left child, right is child+1; 0 - leaf
+      };
+
+    struct Item {
+      float     score = 0;
+      bool      point = false;
+      uintptr_t ref   = 0;     // node id or WayPoint*
+
+      bool operator > (const Item& other) const {
+        if(score!=other.score)
+          return score>other.score;
+        if(point!=other.point)
+          return point; // expand nodes first, they may hold a tie with lower address
+        return ref>other.ref;
+        }
+      };
+
+    static constexpr uint32_t leafSize = 8;
+
+    void build(uint32_t id);
+
+    std::vector<Node>            nodes;
+    std::vector<const WayPoint*> points;
+  };
+
+template<class Metric, class Filter>
+const WayPoint* WayIndex::nearest(const Metric& metric, const Filter& filter) const {
+  constexpr float inf = std::numeric_limits<float>::infinity();
+  if(nodes.empty())
+    return nullptr;
+
+  // take scratch heap of this thread; filter is allowed to query index again
+  static thread_local std::vector<Item> scratch;
+  std::vector<Item> heap;
+  std::swap(heap,scratch);
+  heap.clear();
+
+  auto push = [&heap](float score, bool point, uintptr_t ref) {
+    if(!(score<inf))
+      return;
+    heap.push_back(Item{score,point,ref});
+    std::push_heap(heap.begin(),heap.end(),std::greater<Item>());
+    };
+
+  const WayPoint* ret = nullptr;
+  push(metric(nodes[0].lo,nodes[0].hi),false,0);
+  while(!heap.empty()) {
+    std::pop_heap(heap.begin(),heap.end(),std::greater<Item>());
+    const Item it = heap.back();
+    heap.pop_back();
+
+    if(it.point) {
+      auto& w = *reinterpret_cast<const WayPoint*>(it.ref);
+      if(filter(w)) {
+        ret = &w;
+        break;
+        }
+      continue;
+      }
+
+    auto& n = nodes[it.ref];
+    if(n.child==0) {
+      for(uint32_t i=n.begin; i<n.end; ++i)
+        push(metric(*points[i]),true,reinterpret_cast<uintptr_t>(points[i]));
+      } else {
+      auto& l = nodes[n.child];
+      auto& r = nodes[n.child+1];
+      push(metric(l.lo,l.hi),false,n.child);
+      push(metric(r.lo,r.hi),false,n.child+1);
+      }
+    }
+
+  std::swap(heap,scratch);
+  return ret;
+  }
+
+template<class Func>
+void WayIndex::find(const Tempest::Vec3& p, float R, const Func& func) const {
+  if(nodes.empty())
+    return;
+
+  const float qR        = R*R;
+  uint32_t    stk[64]   = {};
+  size_t      stkSize   = 0;
+  stk[stkSize++] = 0;
+  while(stkSize>0) {
+    auto& n = nodes[stk[--stkSize]];
+    if(qDist(p,n.lo,n.hi)>qR)
+      continue;
+    if(n.child!=0) {
+      stk[stkSize++] = n.child;
+      stk[stkSize++] = n.child+1;
+      continue;
+      }
+    for(uint32_t i=n.begin; i<n.end; ++i) {
+      auto& w = *points[i];
+      if((w.position()-p).quadLength()<=qR)
+        func(w);
+      }
+    }
+  }
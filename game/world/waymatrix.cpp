@@ -35,12 +35,10 @@ WayMatrix::WayMatrix(World &world, const phoenix::way_net &dat)
   for(auto& i:wayPoints)
     if(i.name.find("START")!=std::string::npos)
       startPoints.push_back(i);
-
-  stk[0].reserve(256);
-  stk[1].reserve(256);
   }
 
 void WayMatrix::buildIndex() {
+  invalidatePathCache();
   indexPoints.clear();
   adjustWaypoints(wayPoints);
   adjustWaypoints(freePoints);
@@ -49,12 +47,6 @@ void WayMatrix::buildIndex() {
     return a->name<b->name;
     });
 
-  for(auto& i:freePoints)
-    fpInd.push_back(&i);
-  std::sort(fpInd.begin(),fpInd.end(),[](const WayPoint* a,const WayPoint* b){
-    return a->x<b->x;
-    });
-
   for(auto& i:edges){
     if(i.a<wayPoints.size() && i.b<wayPoints.size()){
       auto& a = wayPoints[i.a ];
@@ -64,58 +56,51 @@ void WayMatrix::buildIndex() {
       b.connect(a);
       }
     }
-  }
+  buildGraph();
 
-const WayPoint *WayMatrix::findWayPoint(const Vec3& at, const Vec3& to, const std::function<bool(const WayPoint&)>& filter) const {
-  const WayPoint* ret =nullptr;
-  float           dist=std::numeric_limits<float>::max();
-  for(auto& w:wayPoints) {
-    if(!filter(w))
-      continue;
-    auto  dp0 = at-w.position();
-    float l0  = dp0.quadLength();
+  std::vector<const WayPoint*> wp(wayPoints.size());
+  for(size_t i=0; i<wayPoints.size(); ++i)
+    wp[i] = &wayPoints[i];
+  wayIndex  = WayIndex(std::move(wp));
+  nextIndex = WayIndex(std::vector<const WayPoint*>(indexPoints.begin(),indexPoints.end()));
 
-    auto  dp1 = to-w.position();
-    float l1  = dp1.quadLength();
+  std::lock_guard<std::mutex> guard(fpSync);
+  fpIndex.clear();
+  }
 
-    float l = l0 + std::min<float>(l1,150*150);
-    if(l<dist){
-      ret  = &w;
-      dist = l;
+void WayMatrix::buildGraph() {
+  graphOffset.resize(wayPoints.size()+1);
+  graphPos.resize(wayPoints.size());
+  graphEdges.clear();
+  for(size_t i=0; i<wayPoints.size(); ++i) {
+    auto& w = wayPoints[i];
+    graphOffset[i] = uint32_t(graphEdges.size());
+    graphPos[i]    = w.position();
+    for(auto& c:w.connections()) {
+      Edge e;
+      e.to  = uint32_t(std::distance<const WayPoint*>(wayPoints.data(),c.point));
+      // exact length, so euclidean heuristic stays admissible (Conn::len is truncated)
+      e.len = (c.point->position()-w.position()).length();
+      graphEdges.push_back(e);
       }
     }
-  return ret;
-  }
-
-const WayPoint *WayMatrix::findFreePoint(const Vec3& at, std::string_view name, const std::function<bool(const WayPoint&)>& filter) const {
-  auto&  index = findFpIndex(name);
-  return findFreePoint(at.x,at.y,at.z,index,filter);
+  graphOffset[wayPoints.size()] = uint32_t(graphEdges.size());
   }
 
 const WayPoint *WayMatrix::findNextPoint(const Vec3& at) const {
-  const WayPoint* ret   = nullptr;
-  float           dist  = distanceThreshold;
-
-  dist*=dist;
-  for(auto pw:indexPoints){
-    auto& w  = *pw;
-    auto  dp = w.position()-at;
-    float l  = dp.quadLength();
-
-    if(l<dist && dp.z*dp.z<300*300 && !w.isLocked()){
-      ret  = &w;
-      dist = l;
-      }
-    }
-  return ret;
+  return nextIndex.nearest(RangeMetric{at,distanceThreshold*distanceThreshold},[](const WayPoint& w){
+    return !w.isLocked();
+    });
   }
 
 void WayMatrix::addFreePoint(const Vec3& pos, const Vec3& dir, std::string_view name) {
   freePoints.emplace_back(pos,dir,name);
+  invalidatePathCache();
   }
 
 void WayMatrix::addStartPoint(const Vec3& pos, const Vec3& dir, std::string_view name) {
   startPoints.emplace_back(pos,dir,name);
+  invalidatePathCache();
   }
 
 const WayPoint &WayMatrix::startPoint() const {
@@ -183,67 +168,84 @@ void WayMatrix::marchPoints(DbgPainter &p) const {
   }
 
 void WayMatrix::adjustWaypoints(std::vector<WayPoint> &wp) {
-  for(auto& w:wp) {
-    w.y = world.physic()->landRay(w.position()).v.y;
-    indexPoints.push_back(&w);
+  std::vector<Vec3>                        pos(wp.size());
+  std::vector<DynamicWorld::RayLandResult> land(wp.size());
+  for(size_t i=0; i<wp.size(); ++i)
+    pos[i] = wp[i].position();
+  world.physic()->landRay(pos.data(),pos.size(),land.data());
+
+  for(size_t i=0; i<wp.size(); ++i) {
+    wp[i].y = land[i].v.y;
+    indexPoints.push_back(&wp[i]);
     }
   }
 
-const WayMatrix::FpIndex &WayMatrix::findFpIndex(std::string_view name) const {
-  auto it = std::lower_bound(fpIndex.begin(),fpIndex.end(),name,[](FpIndex& l, std::string_view r){
-    return l.key<r;
-    });
-  if(it!=fpIndex.end() && it->key==name){
-    return *it;
-    }
+const WayIndex& WayMatrix::findFpIndex(std::string_view name) const {
+  std::lock_guard<std::mutex> guard(fpSync);
+  auto it = fpIndex.find(name);
+  if(it!=fpIndex.end())
+    return it->second;
+
+  std::vector<const WayPoint*> index;
+  for(auto& w:freePoints)
+    if(w.checkName(name))
+      index.push_back(&w);
+  // references to unordered_map values are stable on rehash
+  return fpIndex.emplace(std::string(name),WayIndex(std::move(index))).first->second;
+  }
 
-  FpIndex id;
-  id.key = name;
-  for(auto& w:freePoints){
-    if(!w.checkName(name))
-      continue;
-    id.index.push_back(&w);
+WayPath WayMatrix::wayTo(const WayPoint& begin, const WayPoint& end) const {
+  static thread_local Query q;
+
+  const intptr_t beginId = std::distance<const WayPoint*>(wayPoints.data(),&begin);
+  const intptr_t endId   = std::distance<const WayPoint*>(wayPoints.data(),&end);
+  if(beginId<0 || size_t(beginId)>=wayPoints.size() || endId<0 || size_t(endId)>=wayPoints.size())
+    return wayTo(begin,end,q);
+
+  const uint64_t key = (uint64_t(beginId)<<32) | uint64_t(endId);
+  {
+  std::lock_guard<std::mutex> guard(pathSync);
+  auto it = pathCache.find(key);
+  if(it!=pathCache.end()) {
+    pathStats.hits++;
+    pathLru.splice(pathLru.begin(),pathLru,it->second);
+    return it->second->path;
     }
-  // TODO: good index, not sort by 'x' :)
-  std::sort(id.index.begin(),id.index.end(),[](const WayPoint* a,const WayPoint* b){
-    return a->x<b->x;
-    });
-
-  it = fpIndex.insert(it,std::move(id));
-  return *it;
+  pathStats.misses++;
   }
 
-const WayPoint *WayMatrix::findFreePoint(float x, float y, float z, const FpIndex& ind,
-                                         const std::function<bool(const WayPoint&)>& filter) const {
-  float R = distanceThreshold;
-  auto b = std::lower_bound(ind.index.begin(),ind.index.end(), x-R ,[](const WayPoint *a, float b){
-    return a->x<b;
-    });
-  auto e = std::upper_bound(ind.index.begin(),ind.index.end(), x+R ,[](float a,const WayPoint *b){
-    return a<b->x;
-    });
-
-  const WayPoint* ret=nullptr;
-  auto  count = std::distance(b,e);(void) count;
-  float dist  = R*R;
-  for(auto i=b;i!=e;++i){
-    auto& w  = **i;
-    float dx = w.x-x;
-    float dy = w.y-y;
-    float dz = w.z-z;
-    float l  = dx*dx+dy*dy+dz*dz;
-    if(l>dist || dz*dz>300*300)
-      continue;
-    if(!filter(w))
-      continue;
-    ret  = &w;
-    dist = l;
+  WayPath ret = wayTo(begin,end,q);
+
+  std::lock_guard<std::mutex> guard(pathSync);
+  if(pathCache.find(key)!=pathCache.end())
+    return ret; // computed concurrently by other thread
+  pathLru.push_front(CachedPath{key,ret});
+  pathCache[key] = pathLru.begin();
+  if(pathLru.size()>pathCacheSize) {
+    pathCache.erase(pathLru.back().key);
+    pathLru.pop_back();
+    pathStats.evictions++;
     }
   return ret;
   }
 
-WayPath WayMatrix::wayTo(const WayPoint& begin, const WayPoint& end) const {
-  intptr_t endId = std::distance<const WayPoint*>(&wayPoints[0],&end);
+auto WayMatrix::pathCacheStats() const -> PathCacheStats {
+  std::lock_guard<std::mutex> guard(pathSync);
+  auto ret = pathStats;
+  ret.size = pathLru.size();
+  return ret;
+  }
+
+void WayMatrix::invalidatePathCache() {
+  std::lock_guard<std::mutex> guard(pathSync);
+  pathLru.clear();
+  pathCache.clear();
+  }
+
+WayPath WayMatrix::wayTo(const WayPoint& begin, const WayPoint& end, Query& q) const {
+  q.expanded = 0;
+
+  intptr_t endId = std::distance<const WayPoint*>(wayPoints.data(),&end);
   if(endId<0 || size_t(endId)>=wayPoints.size()){
     if(end.name.find("FP_")==0) {
       WayPath ret;
@@ -253,57 +255,66 @@ WayPath WayMatrix::wayTo(const WayPoint& begin, const WayPoint& end) const {
     return WayPath();
     }
 
-  pathGen++;
-  if(pathGen==1){
+  intptr_t beginId = std::distance<const WayPoint*>(wayPoints.data(),&begin);
+  if(beginId<0 || size_t(beginId)>=wayPoints.size() || graphOffset.size()!=wayPoints.size()+1)
+    return WayPath();
+
+  if(q.gen.size()!=wayPoints.size()) {
+    q.cost  .assign(wayPoints.size(),0);
+    q.parent.assign(wayPoints.size(),0);
+    q.gen   .assign(wayPoints.size(),0);
+    q.generation = 0;
+    }
+  q.generation++;
+  if(q.generation==0) {
     // new cycle
-    for(auto& i:wayPoints)
-      i.pathGen=0;
+    std::fill(q.gen.begin(),q.gen.end(),0);
+    q.generation = 1;
     }
-  begin.pathLen = 0;
-  begin.pathGen = pathGen;
-
-  std::vector<const WayPoint*> *front=&stk[0], *back=&stk[1];
-  stk[0].clear();
-  stk[1].clear();
-
-  front->push_back(&begin);
-
-  while(end.pathGen!=pathGen && front->size()>0){
-    for(auto& wp:*front){
-      int32_t l0 = wp->pathLen;
-
-      for(auto i:wp->connections()){
-        auto& w  = *i.point;
-        int32_t l1 = l0+i.len;
-        if(w.pathGen!=pathGen || w.pathLen>l1){
-          w.pathLen = l1;
-          w.pathGen = pathGen;
-          back->push_back(&w);
-          }
-        }
+
+  const uint32_t gen = q.generation;
+  const uint32_t src = uint32_t(beginId);
+  const uint32_t dst = uint32_t(endId);
+  const Vec3     tg  = graphPos[dst];
+  auto  cmp = [](const Query::Open& a, const Query::Open& b){ return a.f>b.f; };
+
+  q.open.clear();
+  q.cost  [src] = 0;
+  q.parent[src] = src;
+  q.gen   [src] = gen;
+  q.open.push_back({(graphPos[src]-tg).length(),0,src});
+
+  while(!q.open.empty()) {
+    std::pop_heap(q.open.begin(),q.open.end(),cmp);
+    const auto cur = q.open.back();
+    q.open.pop_back();
+    if(cur.g>q.cost[cur.id])
+      continue; // stale entry
+    q.expanded++;
+    if(cur.id==dst)
+      break;
+
+    for(uint32_t e=graphOffset[cur.id]; e<graphOffset[cur.id+1]; ++e) {
+      auto&       edge = graphEdges[e];
+      const float g    = cur.g+edge.len;
+      if(q.gen[edge.to]==gen && q.cost[edge.to]<=g)
+        continue;
+      q.gen   [edge.to] = gen;
+      q.cost  [edge.to] = g;
+      q.parent[edge.to] = cur.id;
+      q.open.push_back({g+(graphPos[edge.to]-tg).length(),g,edge.to});
+      std::push_heap(q.open.begin(),q.open.end(),cmp);
       }
-    std::swap(front,back);
-    back->clear();
     }
 
+  if(q.gen[dst]!=gen)
+    return WayPath();
+
   WayPath ret;
   ret.add(end);
-  const WayPoint* current = &end;
-  while(current!=&begin) {
-    int32_t l0 = current->pathLen, l1=l0;
-
-    const WayPoint* next=nullptr;
-    for(auto i:current->connections()){
-      if(i.point->pathGen==pathGen && i.point->pathLen+i.len<=l0 && i.point->pathLen<l1){
-        next = i.point;
-        l1   = i.point->pathLen;
-        }
-      }
-    if(next==nullptr)
-      return WayPath();
-    ret.add(*next);
-    current=next;
+  for(uint32_t i=dst; i!=src;) {
+    i = q.parent[i];
+    ret.add(wayPoints[i]);
     }
-
   return ret;
   }
@@ -6,10 +6,14 @@
 #include <phoenix/world/way_net.hh>
 
 #include <vector>
-#include <functional>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <string>
 
 #include "waypath.h"
 #include "waypoint.h"
+#include "wayindex.h"
 
 class World;
 class DbgPainter;
@@ -18,9 +22,41 @@ class WayMatrix final {
   public:
     WayMatrix(World& owner,const phoenix::way_net& dat);
 
-    const WayPoint* findWayPoint (const Tempest::Vec3& at, const Tempest::Vec3& to, const std::function<bool(const WayPoint&)>& filter) const;
-    const WayPoint* findFreePoint(const Tempest::Vec3& at, std::string_view name, const std::function<bool(const WayPoint&)>& filter) const;
+    // Scratch data of path request. Each thread has its own by default, so requests may run concurrently.
+    class Query final {
+      public:
+        size_t expanded = 0; // nodes taken from open list by the last request
+
+      private:
+        struct Open {
+          float    f  = 0;
+          float    g  = 0;
+          uint32_t id = 0;
+          };
+        std::vector<float>    cost;
+        std::vector<uint32_t> parent;
+        std::vector<uint32_t> gen;
+        std::vector<Open>     open;
+        uint32_t              generation = 0;
+
+      friend class WayMatrix;
+      };
+
+    struct PathCacheStats final {
+      uint64_t hits      = 0;
+      uint64_t misses    = 0;
+      uint64_t evictions = 0;
+      size_t   size      = 0;
+      };
+
+    // filters are tested in ascending order of distance, until one accepts a point
+    template<class Filter>
+    const WayPoint* findWayPoint (const Tempest::Vec3& at, const Tempest::Vec3& to, const Filter& filter) const;
+    template<class Filter>
+    const WayPoint* findFreePoint(const Tempest::Vec3& at, std::string_view name, const Filter& filter) const;
     const WayPoint* findNextPoint(const Tempest::Vec3& at) const;
+    template<class Func>
+    void            findWayPoints(const Tempest::Vec3& at, float R, const Func& func) const;
 
     void            addFreePoint (const Tempest::Vec3& pos, const Tempest::Vec3& dir, std::string_view name);
     void            addStartPoint(const Tempest::Vec3& pos, const Tempest::Vec3& dir, std::string_view name);
@@ -33,6 +69,15 @@ class WayMatrix final {
     void            marchPoints(DbgPainter& p) const;
 
     WayPath         wayTo(const WayPoint &begin, const WayPoint& end) const;
+    // bypasses path cache
+    WayPath         wayTo(const WayPoint &begin, const WayPoint& end, Query& q) const;
+    auto            pathCacheStats() const -> PathCacheStats;
+
+    size_t          wayPointsCount() const { return wayPoints.size(); }
+    const WayPoint& wayPoint(size_t i) const { return wayPoints[i]; }
+    size_t          freePointsCount() const { return freePoints.size(); }
+    const WayPoint& freePoint(size_t i) const { return freePoints[i]; }
+    float           searchRadius() const { return distanceThreshold; }
 
   private:
     World&                 world;
@@ -44,20 +89,87 @@ class WayMatrix final {
     std::vector<WayPoint>  freePoints, startPoints;
     std::vector<WayPoint*> indexPoints;
 
-    std::vector<WayPoint*> fpInd;
+    // spatial indices, valid after buildIndex
+    WayIndex               wayIndex;  // wayPoints
+    WayIndex               nextIndex; // indexPoints
 
-    struct FpIndex {
-      std::string                  key;
-      std::vector<const WayPoint*> index;
+    // freepoints by name prefix, built on first request
+    struct NameHash {
+      using is_transparent = void;
+      size_t operator()(std::string_view s) const { return std::hash<std::string_view>()(s); }
+      };
+    mutable std::mutex                                                         fpSync;
+    mutable std::unordered_map<std::string,WayIndex,NameHash,std::equal_to<>>  fpIndex;
+
+    // |at-p|^2 + min(|to-p|^2, 150^2)
+    struct RouteMetric {
+      Tempest::Vec3 at, to;
+      float operator()(const Tempest::Vec3& lo, const Tempest::Vec3& hi) const {
+        return WayIndex::qDist(at,lo,hi) + std::min(WayIndex::qDist(to,lo,hi),150.f*150.f);
+        }
+      float operator()(const WayPoint& w) const {
+        return (at-w.position()).quadLength() + std::min((to-w.position()).quadLength(),150.f*150.f);
+        }
       };
-    mutable std::vector<FpIndex>          fpIndex;
 
-    mutable uint16_t                      pathGen=0;
-    mutable std::vector<const WayPoint*>  stk[2];
+    // |at-p|^2, within R and +/-300 on z-axis
+    struct RangeMetric {
+      Tempest::Vec3 at;
+      float         qR = 0;
+      float operator()(const Tempest::Vec3& lo, const Tempest::Vec3& hi) const {
+        const float l = WayIndex::qDist(at,lo,hi);
+        if(l>qR || hi.z<at.z-300.f || at.z+300.f<lo.z)
+          return std::numeric_limits<float>::infinity();
+        return l;
+        }
+      float operator()(const WayPoint& w) const {
+        const auto  dp = w.position()-at;
+        const float l  = dp.quadLength();
+        if(l>qR || dp.z*dp.z>300.f*300.f)
+          return std::numeric_limits<float>::infinity();
+        return l;
+        }
+      };
+
+    // waynet graph in compact form: edges of point i are graphEdges[graphOffset[i]..graphOffset[i+1])
+    struct Edge {
+      uint32_t to  = 0;
+      float    len = 0;
+      };
+    std::vector<uint32_t>      graphOffset;
+    std::vector<Edge>          graphEdges;
+    std::vector<Tempest::Vec3> graphPos;
+
+    // LRU of recent routes, key is (begin<<32 | end)
+    struct CachedPath {
+      uint64_t key = 0;
+      WayPath  path;
+      };
+    static constexpr size_t                                                 pathCacheSize = 1024;
+    mutable std::mutex                                                      pathSync;
+    mutable std::list<CachedPath>                                           pathLru;
+    mutable std::unordered_map<uint64_t,std::list<CachedPath>::iterator>    pathCache;
+    mutable PathCacheStats                                                  pathStats;
 
     void                   adjustWaypoints(std::vector<WayPoint> &wp);
+    void                   buildGraph();
+    void                   invalidatePathCache();
 
-    const FpIndex&         findFpIndex(std::string_view name) const;
-    const WayPoint*        findFreePoint(float x, float y, float z, const FpIndex &ind,
-                                         const std::function<bool(const WayPoint&)>& filter) const;
+    const WayIndex&        findFpIndex(std::string_view name) const;
   };
+
+template<class Filter>
+const WayPoint* WayMatrix::findWayPoint(const Tempest::Vec3& at, const Tempest::Vec3& to, const Filter& filter) const {
+  return wayIndex.nearest(RouteMetric{at,to},filter);
+  }
+
+template<class Filter>
+const WayPoint* WayMatrix::findFreePoint(const Tempest::Vec3& at, std::string_view name, const Filter& filter) const {
+  auto& index = findFpIndex(name);
+  return index.nearest(RangeMetric{at,distanceThreshold*distanceThreshold},filter);
+  }
+
+template<class Func>
+void WayMatrix::findWayPoints(const Tempest::Vec3& at, float R, const Func& func) const {
+  wayIndex.find(at,R,func);
+  }
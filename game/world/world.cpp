@@ -2,12 +2,15 @@
 
 #include <fstream>
 #include <functional>
+#include <chrono>
+#include <exception>
 #include <cctype>
 
 #include <Tempest/Log>
 #include <Tempest/Painter>
 
 #include "graphics/mesh/submesh/packedmesh.h"
+#include "graphics/mesh/assetcache.h"
 #include "graphics/visualfx.h"
 #include "world/objects/globalfx.h"
 #include "world/objects/npc.h"
@@ -15,7 +18,9 @@
 #include "world/objects/interactive.h"
 #include "game/globaleffects.h"
 #include "game/serialize.h"
+#include "utils/memoryinfo.h"
 #include "utils/string_frm.h"
+#include "utils/workers.h"
 #include "gothic.h"
 #include "focus.h"
 #include "resources.h"
@@ -61,9 +66,74 @@ const char* materialTag(phoenix::material_group src) {
   return "UD";
   }
 
+// FNV-1a of file content: key of on-disk caches, derived from this file
+static uint64_t fileHash(const phoenix::buffer& buf) {
+  auto     data = reinterpret_cast<const uint8_t*>(buf.array());
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for(size_t i=0; i<buf.limit(); ++i) {
+    hash ^= data[i];
+    hash *= 0x100000001b3ull;
+    }
+  return hash;
+  }
+
+namespace {
+
+uint64_t elapsedUs(std::chrono::steady_clock::time_point since) {
+  auto dt = std::chrono::steady_clock::now()-since;
+  return uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(dt).count());
+  }
+
+// stage of world loading, executed by Workers; exception is kept until rethrowIfFailed
+struct LoadStage final {
+  Workers::Task      task;
+  std::exception_ptr err;
+  uint64_t           us = 0;
+
+  template<class F>
+  void start(F func) {
+    task = Workers::async([this,func]() {
+      auto t0 = std::chrono::steady_clock::now();
+      try {
+        func();
+        }
+      catch(...) {
+        err = std::current_exception();
+        }
+      us = elapsedUs(t0);
+      });
+    }
+
+  void rethrowIfFailed() const {
+    if(err)
+      std::rethrow_exception(err);
+    }
+  };
+
+// waiting on Resources caches, summed over all of them
+struct ResourceWait final {
+  uint64_t contended  = 0;
+  uint64_t lockWaitNs = 0;
+  uint64_t loadWaits  = 0;
+  uint64_t loadWaitNs = 0;
+
+  static ResourceWait current() {
+    ResourceWait ret;
+    for(auto& i:Resources::cacheStats()) {
+      ret.contended  += i.contended;
+      ret.lockWaitNs += i.lockWaitNs;
+      ret.loadWaits  += i.loadWaits;
+      ret.loadWaitNs += i.loadWaitNs;
+      }
+    return ret;
+    }
+  };
+
+}
+
 World::World(GameSession& game, std::string_view file, bool startup, std::function<void(int)> loadProgress)
   :wname(std::move(file)), game(game), wsound(game,*this), wobj(*this) {
-  const phoenix::vdf_entry* entry = Resources::vdfsIndex().find_entry(wname);
+  const phoenix::vdf_entry* entry = Resources::findFile(wname);
 
   if(entry == nullptr) {
     Tempest::Log::e("unable to open Zen-file: \"",wname,"\"");
@@ -71,32 +141,74 @@ World::World(GameSession& game, std::string_view file, bool startup, std::functi
     }
 
   try {
-    auto buf = entry->open();
+    const auto time0 = std::chrono::steady_clock::now();
+    const auto wait0 = ResourceWait::current();
+    const auto ac0   = AssetCache::stats();
+    const auto rss0  = MemoryInfo::currentRss();
+    auto buf   = entry->open();
     auto world = phoenix::world::parse(buf, version().game == 1 ? phoenix::game_version::gothic_1
                                                                 : phoenix::game_version::gothic_2);
+    const uint64_t parseUs = elapsedUs(time0);
     loadProgress(20);
 
-    auto& worldMesh = world.world_mesh;
-    {
+    // landscape view, physics and bsp don't depend on each other
+    auto&     worldMesh = world.world_mesh;
+    LoadStage view, physics, rooms;
+    view.start([this,&worldMesh]() {
       PackedMesh vmesh(worldMesh,PackedMesh::PK_VisualLnd);
-      wview.reset   (new WorldView(*this,vmesh));
-    }
-
+      wview.reset(new WorldView(*this,vmesh));
+      });
+    const bool lndCache = Gothic::settingsGetI("PERFORMANCE","landscapeCache")!=0;
+    physics.start([this,&worldMesh,&buf,lndCache]() {
+      wdynamic.reset(new DynamicWorld(*this,worldMesh,lndCache ? fileHash(buf) : 0));
+      });
+    rooms.start([this,&world]() {
+      bsp = std::move(world.world_bsp_tree);
+      bspSectors.resize(bsp.sectors.size());
+      bspRooms.build(bsp);
+      });
+
+    // all stages must be done, before locals are gone
+    view.task.wait();
     loadProgress(50);
-    wdynamic.reset(new DynamicWorld(*this,worldMesh));
+    physics.task.wait();
+    rooms.task.wait();
     loadProgress(70);
+    view.rethrowIfFailed();
+    physics.rethrowIfFailed();
+    rooms.rethrowIfFailed();
 
+    // vobs need view and physics
+    const auto time1 = std::chrono::steady_clock::now();
     globFx.reset(new GlobalEffects(*this));
-
     wmatrix.reset(new WayMatrix(*this,world.world_way_net));
+    const auto vobSt = wobj.addRoots(world.world_vobs,startup);
+    const uint64_t vobsUs = elapsedUs(time1);
+    loadProgress(90);
 
-    for(auto& vob:world.world_vobs)
-      wobj.addRoot(vob,startup);
-
+    // waynet index needs freepoints from vobs
+    const auto time2 = std::chrono::steady_clock::now();
     wmatrix->buildIndex();
-    bsp = std::move(world.world_bsp_tree);
-    bspSectors.resize(bsp.sectors.size());
+    const uint64_t waynetUs = elapsedUs(time2);
     loadProgress(100);
+
+    const auto rss1 = MemoryInfo::currentRss();
+    Tempest::Log::i("world \"",wname,"\" loaded in ",int(elapsedUs(time0)/1000)," ms: parse ",int(parseUs/1000),
+                    ", view ",int(view.us/1000),", physics ",int(physics.us/1000),", bsp ",int(rooms.us/1000),
+                    " (in parallel), vobs ",int(vobsUs/1000)," (",int(vobSt.assets)," assets, prefetch ",int(vobSt.prefetchUs/1000),
+                    ", instantiate ",int(vobSt.instantiateUs/1000),"), waynet ",int(waynetUs/1000),
+                    "; RSS ",int(rss0/(1024*1024))," -> ",int(rss1/(1024*1024))," MiB (delta ",
+                    int((int64_t(rss1)-int64_t(rss0))/(1024*1024)),"), peak ",int(MemoryInfo::peakRss()/(1024*1024))," MiB");
+
+    const auto wait1 = ResourceWait::current();
+    Tempest::Log::i("resources: ",int(wait1.contended-wait0.contended)," contended locks (",int((wait1.lockWaitNs-wait0.lockWaitNs)/1000000)," ms), ",
+                    int(wait1.loadWaits-wait0.loadWaits)," shared loads (",int((wait1.loadWaitNs-wait0.loadWaitNs)/1000000)," ms)");
+    if(AssetCache::isEnabled()) {
+      const auto ac1 = AssetCache::stats();
+      Tempest::Log::i("asset cache: ",int(ac1.hits-ac0.hits)," hits (",int((ac1.loadUs-ac0.loadUs)/1000)," ms, saved ",
+                      int((int64_t(ac1.savedUs-ac0.savedUs)-int64_t(ac1.loadUs-ac0.loadUs))/1000)," ms), ",
+                      int(ac1.misses-ac0.misses)," misses (",int((ac1.bakeUs-ac0.bakeUs)/1000)," ms)");
+      }
     }
   catch(...) {
     Tempest::Log::e("unable to load landscape mesh");
@@ -278,53 +390,23 @@ Npc *World::findNpcByInstance(size_t instance) {
   }
 
 std::string_view World::roomAt(const Tempest::Vec3& p) {
-  if(bsp.nodes.empty())
-    return "";
-
-  const auto* node=&bsp.nodes[0];
-
-  while(true) {
-    const auto v    = node->plane;
-    float        sgn  = v.x*p.x + v.y*p.y + v.z*p.z - v.w;
-    uint32_t     next = (sgn>0) ? node->front_index : node->back_index;
-    if(next>=bsp.nodes.size())
-      break;
-
-    node = &bsp.nodes[next];
-    }
+  return bspRooms.name(bspRooms.roomAt(p));
+  }
 
-  if(node->bbox.min.x <= p.x && p.x <node->bbox.max.x &&
-     node->bbox.min.y <= p.y && p.y <node->bbox.max.y &&
-     node->bbox.min.z <= p.z && p.z <node->bbox.max.z) {
-    return roomAt(*node);
-    }
+uint32_t World::roomIdAt(const Tempest::Vec3& p) const {
+  return bspRooms.roomAt(p);
+  }
 
-  return "";
+uint32_t World::roomIdAt(const Tempest::Vec3& p, BspRooms::Cache& cache) const {
+  return bspRooms.roomAt(p,cache);
   }
 
-std::string_view World::roomAt(const phoenix::bsp_node& node) {
-  const std::string* ret=nullptr;
-  size_t       count=0;
-  auto         id = &node-bsp.nodes.data();(void)id;
+void World::roomIdAt(const Tempest::Vec3* p, size_t count, uint32_t* out) const {
+  bspRooms.roomAt(p,count,out);
+  }
 
-  for(auto& i:bsp.sectors) {
-    for(auto r:i.node_indices)
-      if(r<bsp.leaf_node_indices.size()){
-        size_t idx = bsp.leaf_node_indices[r];
-        if(idx>=bsp.nodes.size())
-          continue;
-        if(&bsp.nodes[idx]==&node) {
-          ret = &i.name;
-          count++;
-          }
-        }
-    }
-  if(count==1) {
-    // TODO: portals
-    return *ret;
-    }
-  static std::string empty;
-  return empty;
+std::string_view World::roomName(uint32_t id) const {
+  return bspRooms.name(id);
   }
 
 World::BspSector* World::portalAt(std::string_view tag) {
@@ -486,6 +568,10 @@ void World::triggerChangeWorld(std::string_view world, std::string_view wayPoint
   game.changeWorld(world,wayPoint);
   }
 
+void World::prefetchWorld(std::string_view world) {
+  game.prefetchWorld(world);
+  }
+
 void World::setMobRoutine(gtime time, std::string_view scheme, int32_t state) {
   wobj.setMobRoutine(time,scheme,state);
   }
@@ -736,8 +822,20 @@ void World::addSound(const phoenix::vob& vob) {
     }
   }
 
-void World::invalidateVobIndex() {
-  wobj.invalidateVobIndex();
+void World::updateVobIndex(const Vob& vob) {
+  wobj.updateVobIndex(vob);
+  }
+
+void World::updateNpcIndex(const Npc& npc) {
+  wobj.updateNpcIndex(npc);
+  }
+
+void World::invalidateSense() {
+  wobj.invalidateSense();
+  }
+
+uint32_t World::senseStamp() const {
+  return wobj.senseStamp();
   }
 
 const phoenix::c_focus& World::searchPolicy(const Npc& pl, TargetCollect& coll, WorldObjects::SearchFlg& opt) const {
@@ -781,10 +879,6 @@ const WayPoint* World::findWayPoint(const Tempest::Vec3& pos) const {
   return wmatrix->findWayPoint(pos,pos,[](const WayPoint&){ return true; });
   }
 
-const WayPoint* World::findWayPoint(const Tempest::Vec3& pos, const std::function<bool(const WayPoint&)>& f) const {
-  return wmatrix->findWayPoint(pos,pos,f);
-  }
-
 const WayPoint *World::findFreePoint(const Npc &npc, std::string_view name) const {
   if(auto p = npc.currentWayPoint()){
     if(p->isFreePoint() && p->checkName(name)) {
@@ -887,8 +981,9 @@ void World::assignRoomToGuild(std::string_view r, int32_t guildId) {
   }
 
 int32_t World::guildOfRoom(const Tempest::Vec3& pos) {
-  std::string_view tg = roomAt(pos);
-  if(auto room=portalAt(tg)) {
+  const uint32_t id = bspRooms.roomAt(pos);
+  if(id<bspSectors.size()) {
+    auto room = &bspSectors[id];
     if(room->guild==GIL_PUBLIC) //FIXME: proper portal implementation
       return room->guild;
     }
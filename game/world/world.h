@@ -18,6 +18,7 @@
 #include "worldsound.h"
 #include "waypoint.h"
 #include "waymatrix.h"
+#include "bsprooms.h"
 #include "resources.h"
 
 class GameSession;
@@ -46,6 +47,8 @@ class World final {
     void                 setPlayer(Npc* npc);
     void                 postInit();
     std::string_view     name() const { return wname; }
+    // assets, looked up since this cache epoch, are used by this world
+    uint32_t             cacheEpoch() const { return useEpoch; }
 
     void                 load(Serialize& fin );
     void                 save(Serialize& fout);
@@ -62,7 +65,10 @@ class World final {
 
     const WayPoint*      findPoint(std::string_view name, bool inexact=true) const;
     const WayPoint*      findWayPoint(const Tempest::Vec3& pos) const;
-    const WayPoint*      findWayPoint(const Tempest::Vec3& pos, const std::function<bool(const WayPoint&)>& f) const;
+    template<class Filter>
+    const WayPoint*      findWayPoint(const Tempest::Vec3& pos, const Filter& f) const { return wmatrix->findWayPoint(pos,pos,f); }
+    template<class Func>
+    void                 findWayPoints(const Tempest::Vec3& pos, float R, const Func& f) const { wmatrix->findWayPoints(pos,R,f); }
 
     const WayPoint*      findFreePoint(const Npc& pos,           std::string_view name) const;
     const WayPoint*      findFreePoint(const Tempest::Vec3& pos, std::string_view name) const;
@@ -82,6 +88,7 @@ class World final {
     WorldSound*          sound()          { return &wsound;        }
     DynamicWorld*        physic()   const { return wdynamic.get(); }
     GlobalEffects*       globalFx() const { return globFx.get();   }
+    const WayMatrix&     wayMatrix() const { return *wmatrix;      }
 
     GameScript&          script()   const;
     GameSession&         gameSession() const { return game; }
@@ -105,12 +112,20 @@ class World final {
     MeshObjects::Mesh    addDecalView (const phoenix::vob& vob);
 
     void                 updateAnimation(uint64_t dt);
+    auto                 animLodStats() const -> const AnimLod::Stats& { return wobj.animLodStats(); }
+    auto                 poseCache() -> PoseCache& { return wobj.poseCache(); }
+    auto                 poseCacheStats() const -> const PoseCache::Stats& { return wobj.poseCacheStats(); }
     void                 resetPositionToTA();
 
     auto                 takeHero() -> std::unique_ptr<Npc>;
     Npc*                 player() const { return npcPlayer; }
     Npc*                 findNpcByInstance(size_t instance);
     std::string_view     roomAt(const Tempest::Vec3& arr);
+    uint32_t             roomIdAt(const Tempest::Vec3& p) const;
+    uint32_t             roomIdAt(const Tempest::Vec3& p, BspRooms::Cache& cache) const;
+    void                 roomIdAt(const Tempest::Vec3* p, size_t count, uint32_t* out) const;
+    std::string_view     roomName(uint32_t id) const;
+    auto                 bspTree() const -> const phoenix::bsp_tree& { return bsp; }
 
     void                 scaleTime(uint64_t& dt);
     void                 tick(uint64_t dt);
@@ -126,6 +141,7 @@ class World final {
     void                 triggerOnStart(bool firstTime);
     void                 triggerEvent(const TriggerEvent& e);
     void                 triggerChangeWorld(std::string_view world, std::string_view wayPoint);
+    void                 prefetchWorld(std::string_view world);
     void                 execTriggerEvent(const TriggerEvent& e);
     void                 enableTicks (AbstractTrigger& t);
     void                 disableTicks(AbstractTrigger& t);
@@ -176,16 +192,21 @@ class World final {
     void                 addFreePoint  (const Tempest::Vec3& pos, const Tempest::Vec3& dir, std::string_view name);
     void                 addSound      (const phoenix::vob& vob);
 
-    void                 invalidateVobIndex();
+    void                 updateVobIndex(const Vob& vob);
+    void                 updateNpcIndex(const Npc& npc);
+    void                 invalidateSense();
+    uint32_t             senseStamp() const;
 
   private:
     const phoenix::c_focus&     searchPolicy(const Npc& pl, TargetCollect& coll, WorldObjects::SearchFlg& opt) const;
     std::string                           wname;
     GameSession&                          game;
+    uint32_t                              useEpoch = CacheUsage::epoch();
 
     std::unique_ptr<WayMatrix>            wmatrix;
     phoenix::bsp_tree                     bsp;
     std::vector<BspSector>                bspSectors;
+    BspRooms                              bspRooms;
 
     Npc*                                  npcPlayer=nullptr;
 
@@ -196,7 +217,6 @@ class World final {
     WorldObjects                          wobj;
     std::unique_ptr<Npc>                  lvlInspector;
 
-    auto         roomAt(const phoenix::bsp_node &node) -> std::string_view;
     auto         portalAt(std::string_view tag) -> BspSector*;
 
     void         initScripts(bool firstTime);
@@ -10,6 +10,8 @@
 #include "world.h"
 #include "utils/workers.h"
 #include "utils/dbgpainter.h"
+#include "utils/fileext.h"
+#include "resources.h"
 #include "gothic.h"
 
 #include <Tempest/Painter>
@@ -18,6 +20,11 @@
 
 #include <glm/gtc/type_ptr.hpp>
 
+#include <cmath>
+#include <chrono>
+#include <limits>
+#include <unordered_set>
+
 using namespace Tempest;
 
 int32_t WorldObjects::MobStates::stateByTime(gtime t) const {
@@ -55,7 +62,7 @@ WorldObjects::SearchOpt::SearchOpt(float rangeMin, float rangeMax, float azi, Ta
   :rangeMin(rangeMin),rangeMax(rangeMax),azi(azi),collectAlgo(collectAlgo),flags(flags) {
   }
 
-WorldObjects::WorldObjects(World& owner):owner(owner){
+WorldObjects::WorldObjects(World& owner):owner(owner),npcGrid(1000.f){
   npcNear.reserve(512);
   }
 
@@ -79,6 +86,9 @@ void WorldObjects::load(Serialize &fin) {
   for(size_t i=0; i<npcArr.size(); ++i) {
     npcArr[i]->load(fin,i);
     }
+  npcGrid.clear();
+  for(size_t i=0; i<npcArr.size(); ++i)
+    npcGrid.insert(npcArr[i].get(),npcArr[i]->position(),uint32_t(i));
 
   fin.setEntry("worlds/",fin.worldName(),"/items");
   fin.read(sz);
@@ -90,6 +100,7 @@ void WorldObjects::load(Serialize &fin) {
 
   for(auto& i:rootVobs)
     i->loadVobTree(fin);
+  invalidateVobIndex();
 
   fin.setEntry("worlds/",fin.worldName(),"/triggerEvents");
   fin.read(sz);
@@ -156,8 +167,13 @@ void WorldObjects::tick(uint64_t dt, uint64_t dtPlayer) {
     std::sort(npcArr.begin(),npcArr.end(),[](std::unique_ptr<Npc>& a, std::unique_ptr<Npc>& b){
       return a->handle().id<b->handle().id;
       });
+    reindexNpc(0);
     }
 
+  // think-phase: route and freepoint lookups of ai-queues; plans are checked against changes from earlier commits
+  tickMovePrepare(Gothic::inst().doParallelNpc());
+
+  // commit-phase: ai-queue and movement, in handle().id order
   for(size_t i=0; i<npcArr.size(); ++i) {
     auto& npc = *npcArr[i];
     if(npc.isPlayer())
@@ -221,13 +237,18 @@ void WorldObjects::tick(uint64_t dt, uint64_t dtPlayer) {
     z->tick(dt);
   tickTriggers(dt);
 
-  for(auto& ptr:npcNear) {
-    Npc& i = *ptr;
+  // think-phase: sensing (rays, rooms), no side effects - may run in parallel
+  tickPerceptionPrepare(*pl,passive,Gothic::inst().doParallelNpc());
+
+  // commit-phase: script calls in handle().id order
+  for(size_t id=0; id<npcNear.size(); ++id) {
+    Npc& i = *npcNear[id];
     if(i.isPlayer() || i.isDead())
       continue;
 
     if(i.processPolicy()==Npc::AiNormal) {
-      for(auto& r:passive) {
+      for(size_t pid=0; pid<passive.size(); ++pid) {
+        auto& r = passive[pid];
         if(r.self==&i)
           continue;
         float l = i.qDistTo(r.pos.x,r.pos.y,r.pos.z);
@@ -236,10 +257,7 @@ void WorldObjects::tick(uint64_t dt, uint64_t dtPlayer) {
         const float range = float(i.handle().senses_range);
         if(l<range*range && r.other!=nullptr && r.victum!=nullptr) {
           // aproximation of behavior of original G2
-          if(!i.isDown() && !i.isPlayer() &&
-             i.canSenseNpc(*r.other, true)!=SensesBit::SENSE_NONE &&
-             i.canSenseNpc(*r.victum,true,float(r.other->handle().senses_range))!=SensesBit::SENSE_NONE
-            ) {
+          if(!i.isDown() && !i.isPlayer() && canSensePassive(i,id,pid,r)) {
             i.perceptionProcess(*r.other,r.victum,l,PercType(r.what));
             }
           }
@@ -253,6 +271,120 @@ void WorldObjects::tick(uint64_t dt, uint64_t dtPlayer) {
     }
   }
 
+void WorldObjects::tickMovePrepare(bool parallel) {
+  if(!parallel)
+    return;
+  // ai-queue execution and regen stay in Npc::tick: both call scripts
+  Workers::parallelTasks(npcArr.size(),[this](uintptr_t id) {
+    npcArr[id]->movePlanPrepare();
+    });
+  }
+
+void WorldObjects::tickPerceptionPrepare(const Npc& pl, const std::vector<PerceptionMsg>& passive, bool parallel) {
+  passiveSense.assign(npcNear.size()*passive.size(),PS_Unknown);
+  passiveEpoch = senseEpoch;
+  passiveNpc.resize(npcNear.size());
+  for(size_t id=0; id<npcNear.size(); ++id) {
+    auto s = npcNear[id]->senseSettings();
+    passiveNpc[id] = {s.senses, s.range};
+    }
+  passiveRange.resize(passive.size());
+  for(size_t pid=0; pid<passive.size(); ++pid)
+    passiveRange[pid] = passive[pid].other!=nullptr ? passive[pid].other->handle().senses_range : 0;
+  if(!parallel)
+    return;
+
+  // same as isSensePassive, unless ray test is needed: then `q` holds rays, which are left to trace
+  auto prepare = [](const Npc& npc, const PerceptionMsg& r, Npc::SenseQuery* q) {
+    q[0] = npc.senseQuery(*r.other,true);
+    q[1] = npc.senseQuery(*r.victum,true,float(r.other->handle().senses_range));
+    for(size_t k=0; k<2; ++k) {
+      if(npc.senseResult(q[k],true)!=SensesBit::SENSE_NONE)
+        q[k].ray = false; // sensed without sight
+      else if(!q[k].ray)
+        return PS_None;
+      }
+    if(!q[0].ray && !q[1].ray)
+      return PS_Sense;
+    return PS_Unknown;
+    };
+
+  // passive senses: cheap tests first; rays, that are still needed, are traced as one batch afterwards
+  const size_t                 count = passive.size();
+  const uint64_t               tick  = owner.tickCount();
+  std::vector<Npc::SenseQuery> query(npcNear.size()*count*2);
+  Workers::parallelTasks(npcNear.size(),[this,&pl,&passive,&query,&prepare,count,tick](uintptr_t id) {
+    Npc& i = *npcNear[id];
+    if(i.isPlayer() || i.isDead() || i.processPolicy()!=Npc::AiNormal)
+      return;
+
+    if(!i.isDown()) {
+      for(size_t pid=0; pid<count; ++pid) {
+        auto& r = passive[pid];
+        if(r.self==&i || r.other==nullptr || r.victum==nullptr)
+          continue;
+        const float l     = i.qDistTo(r.pos.x,r.pos.y,r.pos.z);
+        const float range = float(i.handle().senses_range);
+        if(l<range*range)
+          passiveSense[id*count+pid] = prepare(i,r,&query[(id*count+pid)*2]);
+        }
+      }
+
+    if(i.percNextTime()<=tick)
+      i.perceptionPrepare(pl);
+    });
+
+  std::vector<Tempest::Vec3> from, to;
+  std::vector<size_t>        pair;
+  for(size_t id=0; id<passiveSense.size(); ++id) {
+    if(passiveSense[id]!=PS_Unknown)
+      continue;
+    // pairs, that were not evaluated, have no rays and stay unknown
+    for(size_t k=0; k<2; ++k) {
+      auto& q = query[id*2+k];
+      if(!q.ray)
+        continue;
+      from.push_back(q.from);
+      to  .push_back(q.to);
+      pair.push_back(id);
+      passiveSense[id] = PS_Sense;
+      }
+    }
+  if(pair.empty())
+    return;
+
+  std::vector<DynamicWorld::RayLandResult> hit(pair.size());
+  owner.physic()->ray(from.data(),to.data(),pair.size(),hit.data());
+  for(size_t r=0; r<pair.size(); ++r)
+    if(hit[r].hasCol)
+      passiveSense[pair[r]] = PS_None;
+  }
+
+bool WorldObjects::canSensePassive(const Npc& npc, size_t id, size_t pid, const PerceptionMsg& r) {
+  // script calls of earlier npc's may have moved, killed or turned someone: drop cached results then
+  if(passiveEpoch!=senseEpoch)
+    return isSensePassive(npc,r);
+  // scripts write senses directly, without epoch bump
+  const auto s = npc.senseSettings();
+  if(passiveNpc[id]!=std::make_pair(s.senses,s.range) || passiveRange[pid]!=r.other->handle().senses_range)
+    return isSensePassive(npc,r);
+  const size_t passiveCount = (npcNear.size()==0 ? 0 : passiveSense.size()/npcNear.size());
+  switch(passiveSense[id*passiveCount+pid]) {
+    case PS_Sense:
+      return true;
+    case PS_None:
+      return false;
+    case PS_Unknown:
+      break;
+    }
+  return isSensePassive(npc,r);
+  }
+
+bool WorldObjects::isSensePassive(const Npc& npc, const PerceptionMsg& r) {
+  return npc.canSenseNpc(*r.other, true)!=SensesBit::SENSE_NONE &&
+         npc.canSenseNpc(*r.victum,true,float(r.other->handle().senses_range))!=SensesBit::SENSE_NONE;
+  }
+
 uint32_t WorldObjects::npcId(const Npc *ptr) const {
   if(ptr==nullptr)
     return uint32_t(-1);
@@ -309,6 +441,7 @@ Npc* WorldObjects::addNpc(size_t npcInstance, std::string_view at) {
     npc->attachToPoint(pos);
     npc->updateTransform();
     npcArr.emplace_back(npc);
+    npcGrid.insert(npc,npc->position(),uint32_t(npcArr.size()-1));
     } else {
     auto& point = owner.deadPoint();
     npc->attachToPoint(nullptr);
@@ -327,6 +460,7 @@ Npc* WorldObjects::addNpc(size_t npcInstance, const Vec3& pos) {
   npc->updateTransform();
 
   npcArr.emplace_back(npc);
+  npcGrid.insert(npc,npc->position(),uint32_t(npcArr.size()-1));
   return npc;
   }
 
@@ -348,6 +482,7 @@ Npc* WorldObjects::insertPlayer(std::unique_ptr<Npc> &&npc, std::string_view at)
     npc->attachToPoint(pos);
     npc->updateTransform();
     }
+  npcGrid.insert(npc.get(),npc->position(),uint32_t(npcArr.size()));
   npcArr.emplace_back(std::move(npc));
   return npcArr.back().get();
   }
@@ -356,9 +491,11 @@ std::unique_ptr<Npc> WorldObjects::takeNpc(const Npc* ptr) {
   for(size_t i=0; i<npcArr.size(); ++i){
     auto& npc=*npcArr[i];
     if(&npc==ptr){
+      npcGrid.remove(ptr);
       auto ret=std::move(npcArr[i]);
       npcArr[i] = std::move(npcArr.back());
       npcArr.pop_back();
+      reindexNpc(i);
       return ret;
       }
     }
@@ -408,12 +545,16 @@ void WorldObjects::updateAnimation(uint64_t dt) {
   static bool doAnim=true;
   if(!doAnim)
     return;
-  Workers::parallelTasks(npcArr,[dt](std::unique_ptr<Npc>& i){
-    i->updateAnimation(dt);
+  animLod.beginFrame(*owner.view(),Gothic::inst().doAnimLod());
+  poses.beginFrame(Gothic::inst().doPoseCache());
+  Workers::parallelTasks(npcArr,[this,dt](std::unique_ptr<Npc>& i){
+    i->updateAnimation(dt,&animLod);
     });
-  interactiveObj.parallelFor([dt](Interactive& i){
-    i.updateAnimation(dt);
+  interactiveObj.parallelFor([this,dt](Interactive& i){
+    i.updateAnimation(dt,&animLod);
     });
+  animLod.endFrame();
+  poses.endFrame();
   }
 
 bool WorldObjects::isTargeted(Npc& dst) {
@@ -450,6 +591,11 @@ Npc *WorldObjects::findNpcByInstance(size_t instance) {
   return nullptr;
   }
 
+void WorldObjects::reindexNpc(size_t begin) {
+  for(size_t i=begin; i<npcArr.size(); ++i)
+    npcGrid.reorder(npcArr[i].get(),uint32_t(i));
+  }
+
 void WorldObjects::detectNpcNear(const std::function<void(Npc&)>& f) {
   for(auto& i:npcNear)
     f(*i);
@@ -457,22 +603,18 @@ void WorldObjects::detectNpcNear(const std::function<void(Npc&)>& f) {
 
 void WorldObjects::detectNpc(const float x, const float y, const float z,
                              const float r, const std::function<void(Npc&)>& f) {
-  float maxDist=r*r;
-  for(auto& i:npcArr) {
-    auto qDist = (i->position()-Vec3(x,y,z)).quadLength();
-    if(qDist<maxDist)
-      f(*i);
-    }
+  npcGrid.find(Vec3(x,y,z),r,f);
   }
 
 void WorldObjects::detectItem(const float x, const float y, const float z,
                               const float r, const std::function<void(Item&)>& f) {
-  float maxDist=r*r;
-  for(auto& i:itemArr) {
-    auto qDist = (i->position()-Vec3(x,y,z)).quadLength();
+  const Vec3  pos     = Vec3(x,y,z);
+  const float maxDist = r*r;
+  items.find(pos,r,[&](Item& i){
+    auto qDist = (i.position()-pos).quadLength();
     if(qDist<maxDist)
-      f(*i);
-    }
+      f(i);
+    });
   }
 
 void WorldObjects::addTrigger(AbstractTrigger* tg) {
@@ -660,11 +802,96 @@ void WorldObjects::addRoot(const std::unique_ptr<phoenix::vob>& vob, bool startu
   rootVobs.emplace_back(std::move(p));
   }
 
+namespace {
+struct VobAsset {
+  std::string name;
+  bool        texture = false;
+  };
+}
+
+static void collectAssets(const phoenix::vob& vob, std::unordered_set<std::string>& known, std::vector<VobAsset>& out) {
+  for(auto& i:vob.children)
+    collectAssets(*i,known,out);
+
+  // item visual comes from script instance; *.PFX and *.ZEN are resolved via script and bundle cache
+  if(vob.type==phoenix::vob_type::oCItem || vob.visual_name.empty())
+    return;
+
+  // same rules, as in ObjVisual::setVisual
+  VobAsset a;
+  if(FileExt::hasExt(vob.visual_name,"TGA") && vob.sprite_camera_facing_mode==phoenix::sprite_alignment::none) {
+    a.name    = vob.visual_name;
+    a.texture = true;
+    }
+  else if(FileExt::hasExt(vob.visual_name,"3DS")) {
+    a.name    = vob.visual_name;
+    }
+  else if(FileExt::hasExt(vob.visual_name,"MDS") ||
+          FileExt::hasExt(vob.visual_name,"MMS") ||
+          FileExt::hasExt(vob.visual_name,"ASC")) {
+    a.name    = vob.visual_name;
+    FileExt::exchangeExt(a.name,"ASC","MDL");
+    }
+  else {
+    return;
+    }
+
+  if(known.insert(a.name).second)
+    out.push_back(std::move(a));
+  }
+
+WorldObjects::LoadStats WorldObjects::addRoots(const std::vector<std::unique_ptr<phoenix::vob>>& vobs, bool startup) {
+  LoadStats st;
+
+  // pass 1: decode assets on workers, to have Vob::load served from warm Resources caches
+  const auto time0 = std::chrono::steady_clock::now();
+  std::vector<VobAsset> assets;
+  {
+    std::unordered_set<std::string> known;
+    for(auto& vob:vobs)
+      collectAssets(*vob,known,assets);
+  }
+  st.assets = assets.size();
+  Workers::parallelTasks(assets.size(),[&assets](uintptr_t i){
+    auto& a = assets[i];
+    try {
+      if(a.texture) {
+        Resources::loadTexture(a.name);
+        Resources::loadTextureAnim(a.name);
+        } else {
+        Resources::loadMesh(a.name);
+        }
+      }
+    catch(...) {
+      // not fatal: error will be reported again by serial pass
+      }
+    });
+  const auto time1 = std::chrono::steady_clock::now();
+  st.prefetchUs = uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(time1-time0).count());
+
+  // pass 2: create objects; scripts, physics and world containers are not thread-safe
+  for(auto& vob:vobs)
+    addRoot(vob,startup);
+  const auto time2 = std::chrono::steady_clock::now();
+  st.instantiateUs = uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(time2-time1).count());
+  return st;
+  }
+
 void WorldObjects::invalidateVobIndex() {
   items.invalidate();
   interactiveObj.invalidate();
   }
 
+void WorldObjects::updateVobIndex(const Vob& vob) {
+  items.move(&vob);
+  interactiveObj.move(&vob);
+  }
+
+void WorldObjects::updateNpcIndex(const Npc& npc) {
+  npcGrid.move(&npc,npc.position());
+  senseEpoch++;
+  }
+
 Interactive* WorldObjects::validateInteractive(Interactive *def) {
   return interactiveObj.hasObject(def) ? def : nullptr;
   }
@@ -716,10 +943,10 @@ Npc* WorldObjects::findNpc(const Npc &pl, Npc *def, const SearchOpt& opt) {
     if(def && testObj(*def,pl,xopt))
       return def;
     }
-  auto r = findObj(npcArr,pl,opt);
-  if(r!=nullptr && (!Gothic::inst().doHideFocus() || !r->get()->isDead() ||
-                    r->get()->inventory().iterator(Inventory::T_Ransack).isValid()))
-    return r->get();
+  auto r = findObj(npcGrid,pl,opt);
+  if(r!=nullptr && (!Gothic::inst().doHideFocus() || !r->isDead() ||
+                    r->inventory().iterator(Inventory::T_Ransack).isValid()))
+    return r;
   return nullptr;
   }
 
@@ -840,17 +1067,22 @@ void WorldObjects::resetPositionToTA() {
   for(auto& r:routines)
     r.curState = 0;
 
-  for(auto& i:npcInvalid)
+  for(auto& i:npcInvalid) {
+    npcGrid.insert(i.get(),i->position(),uint32_t(npcArr.size()));
     npcArr.push_back(std::move(i));
+    }
   npcInvalid.clear();
 
+  size_t erased = npcArr.size();
   for(size_t i=0;i<npcArr.size();) {
     auto& n = *npcArr[i];
     if(n.resetPositionToTA()){
       ++i;
       } else {
+      npcGrid.remove(npcArr[i].get());
       npcInvalid.emplace_back(std::move(npcArr[i]));
       npcArr.erase(npcArr.begin()+int(i));
+      erased = std::min(erased,i);
 
       auto& point = owner.deadPoint();
       auto& npc   = *npcInvalid.back();
@@ -859,6 +1091,8 @@ void WorldObjects::resetPositionToTA() {
       npc.updateTransform();
       }
     }
+  reindexNpc(erased);
+
   for(auto& i:routines) {
     auto s = i.stateByTime(owner.time());
     i.curState = s;
@@ -919,8 +1153,8 @@ static bool canSee(const Npc& pl, const Item& n){
   }
 
 template<class T>
-auto WorldObjects::findObj(T &src,const Npc &pl, const SearchOpt& opt) -> typename std::remove_reference<decltype(src[0])>::type* {
-  typename std::remove_reference<decltype(src[0])>::type* ret=nullptr;
+T* WorldObjects::findObj(const SpatialGrid<T>& src, const Npc &pl, const SearchOpt& opt) {
+  T*    ret  = nullptr;
   float rlen = opt.rangeMax*opt.rangeMax;
   if(owner.view()==nullptr)
     return nullptr;
@@ -928,12 +1162,24 @@ auto WorldObjects::findObj(T &src,const Npc &pl, const SearchOpt& opt) -> typena
   if(opt.collectAlgo==TARGET_COLLECT_NONE || opt.collectAlgo==TARGET_COLLECT_CASTER)
     return nullptr;
 
-  for(auto& n:src){
+  auto test = [&](T& n){
     float nlen = rlen;
     if(testObj(n,pl,opt,nlen)){
       rlen = nlen;
-      ret=&n;
+      ret  = &n;
       }
+    };
+
+  // grid reports objects strictly inside of radius, while testObj accepts rangeMax itself
+  const float range = std::nextafter(opt.rangeMax,std::numeric_limits<float>::max());
+  if(bool(opt.flags&SearchFlg::NoAngle)) {
+    src.find(pl.position(),range,test);
+    } else {
+    // testObj measures angle of (pl-npc), so cone axis is opposite to view direction
+    const float plAng = pl.rotationRad()+float(M_PI/2);
+    const Vec2  dir   = Vec2(-std::cos(plAng),-std::sin(plAng));
+    const float ang   = float(std::cos(double(opt.azi)*M_PI/180.0));
+    src.find(pl.position(),range,dir,ang,test);
     }
   return ret;
   }
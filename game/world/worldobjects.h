@@ -5,11 +5,14 @@
 
 #include <phoenix/vobs/misc.hh>
 
+#include "animlod.h"
 #include "bullet.h"
 #include "spaceindex.h"
+#include "spatialgrid.h"
 #include "game/gametime.h"
 #include "game/perceptionmsg.h"
 #include "game/constants.h"
+#include "graphics/mesh/posecache.h"
 
 class Npc;
 class Item;
@@ -46,6 +49,12 @@ class WorldObjects final {
       SearchFlg     flags       = NoFlg;
       };
 
+    struct LoadStats final {
+      size_t        assets        = 0; // unique meshes and textures, referenced by vob-tree
+      uint64_t      prefetchUs    = 0;
+      uint64_t      instantiateUs = 0;
+      };
+
     void           load(Serialize& fout);
     void           save(Serialize& fout);
     void           tick(uint64_t dt, uint64_t dtPlayer);
@@ -56,6 +65,9 @@ class WorldObjects final {
     auto           takeNpc(const Npc* npc) -> std::unique_ptr<Npc>;
 
     void           updateAnimation(uint64_t dt);
+    auto           animLodStats() const -> const AnimLod::Stats& { return animLod.stats(); }
+    auto           poseCache() -> PoseCache& { return poses; }
+    auto           poseCacheStats() const -> const PoseCache::Stats& { return poses.stats(); }
 
     bool           isTargeted(Npc& npc);
     Npc*           findHero();
@@ -104,7 +116,12 @@ class WorldObjects final {
     void           addInteractive(Interactive*         obj);
     void           addStatic     (StaticObj*           obj);
     void           addRoot       (const std::unique_ptr<phoenix::vob>& vob, bool startup);
+    LoadStats      addRoots      (const std::vector<std::unique_ptr<phoenix::vob>>& vobs, bool startup);
     void           invalidateVobIndex();
+    void           updateVobIndex(const Vob& vob);
+    void           updateNpcIndex(const Npc& npc);
+    void           invalidateSense() { senseEpoch++; }
+    uint32_t       senseStamp() const { return senseEpoch; }
 
     Interactive*   validateInteractive(Interactive *def);
     Npc*           validateNpc        (Npc         *def);
@@ -145,6 +162,12 @@ class WorldObjects final {
       uint64_t timeUntil = 0;
       };
 
+    enum PassiveSense : uint8_t {
+      PS_Unknown,
+      PS_None,
+      PS_Sense,
+      };
+
     World&                             owner;
 
     std::vector<CollisionZone*>        collisionZn;
@@ -163,15 +186,24 @@ class WorldObjects final {
     std::vector<std::unique_ptr<Npc>>  npcArr;
     std::vector<std::unique_ptr<Npc>>  npcInvalid;
     std::vector<Npc*>                  npcNear;
+    SpatialGrid<Npc>                   npcGrid;
 
     std::vector<AbstractTrigger*>      triggers;
     std::vector<AbstractTrigger*>      triggersZn;
     std::vector<AbstractTrigger*>      triggersTk;
     std::vector<PerceptionMsg>         sndPerc;
+    std::vector<PassiveSense>          passiveSense;
+    std::vector<std::pair<int32_t,int32_t>> passiveNpc; // senses and senses_range of npcNear, as they were in think-phase
+    std::vector<int32_t>               passiveRange;      // senses_range of PerceptionMsg::other
+    uint32_t                           passiveEpoch = 0;
+    uint32_t                           senseEpoch   = 0; // bumped on any change, that may affect sensing
     std::vector<TriggerEvent>          triggerEvents;
 
+    AnimLod                            animLod;
+    PoseCache                          poses;
+
     template<class T>
-    auto findObj(T &src, const Npc &pl, const SearchOpt& opt) -> typename std::remove_reference<decltype(src[0])>::type*;
+    T*   findObj(const SpatialGrid<T>& src, const Npc &pl, const SearchOpt& opt);
 
     template<class T>
     bool testObj(T &src, const Npc &pl, const SearchOpt& opt);
@@ -179,8 +211,14 @@ class WorldObjects final {
     bool testObj(T &src, const Npc &pl, const SearchOpt& opt, float& rlen);
 
     void             setMobState(std::string_view scheme, int32_t st);
+    // npcGrid reports in npcArr order: indices from `begin` have changed
+    void             reindexNpc(size_t begin);
 
     void             tickNear(uint64_t dt);
     void             tickTriggers(uint64_t dt);
+    void             tickMovePrepare(bool parallel);
+    void             tickPerceptionPrepare(const Npc& pl, const std::vector<PerceptionMsg>& passive, bool parallel);
+    bool             canSensePassive(const Npc& npc, size_t id, size_t pid, const PerceptionMsg& r);
+    static bool      isSensePassive (const Npc& npc, const PerceptionMsg& r);
     static bool      isTargetedBy(Npc& npc,Npc& by);
   };
@@ -0,0 +1,1389 @@
+#include "benchmark.h"
+
+#include <Tempest/Log>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "graphics/mesh/animmath.h"
+#include "graphics/mesh/animpack.h"
+#include "graphics/mesh/animsimd.h"
+#include "graphics/mesh/animationsolver.h"
+#include "graphics/mesh/assetcache.h"
+#include "graphics/mesh/pose.h"
+#include "graphics/mesh/posecache.h"
+#include "graphics/mesh/skeleton.h"
+#include "graphics/texturequeue.h"
+#include "utils/fileext.h"
+#include "utils/string_frm.h"
+#include "utils/vdfsindex.h"
+#include "utils/workers.h"
+#include "world/spatialgrid.h"
+#include "world/objects/item.h"
+#include "world/objects/npc.h"
+#include "world/world.h"
+#include "game/gamescript.h"
+#include "resources.h"
+#include "gothic.h"
+
+#include "legacyworkers.h"
+
+using namespace Tempest;
+
+namespace {
+
+struct Timer final {
+  std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+  // elapsed time in microseconds
+  double us() const {
+    auto now = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double,std::micro>(now-start).count();
+    }
+  };
+
+// World::roomAt before BspRooms: tree walk, then scan of all sectors for the leaf.
+// Sectors without name are skipped, sectors with same name count once; leaf of more than one room is returned in `shared`
+std::string_view legacyRoomAt(const phoenix::bsp_tree& bsp, const Vec3& p, const phoenix::bsp_node*& shared) {
+  shared = nullptr;
+  if(bsp.nodes.empty())
+    return "";
+
+  const auto* node=&bsp.nodes[0];
+  while(true) {
+    const auto v    = node->plane;
+    float      sgn  = v.x*p.x + v.y*p.y + v.z*p.z - v.w;
+    uint32_t   next = (sgn>0) ? node->front_index : node->back_index;
+    if(next>=bsp.nodes.size())
+      break;
+    node = &bsp.nodes[next];
+    }
+
+  if(!(node->bbox.min.x <= p.x && p.x <node->bbox.max.x &&
+       node->bbox.min.y <= p.y && p.y <node->bbox.max.y &&
+       node->bbox.min.z <= p.z && p.z <node->bbox.max.z))
+    return "";
+
+  const std::string* ret = nullptr;
+  for(auto& i:bsp.sectors) {
+    if(i.name.empty())
+      continue;
+    for(auto r:i.node_indices)
+      if(r<bsp.leaf_node_indices.size()) {
+        size_t idx = bsp.leaf_node_indices[r];
+        if(idx<bsp.nodes.size() && &bsp.nodes[idx]==node) {
+          if(ret!=nullptr && *ret!=i.name)
+            shared = node;
+          ret = &i.name;
+          }
+        }
+    }
+  if(ret==nullptr || shared!=nullptr)
+    return "";
+  return *ret;
+  }
+
+// portal resolution of BspRooms, by brute force: room, which own leaves, touching the shared one, are closest to the point
+class LegacyPortals final {
+  public:
+    explicit LegacyPortals(const phoenix::bsp_tree& bsp):bsp(bsp), owners(bsp.nodes.size()) {
+      for(size_t i=0; i<bsp.sectors.size(); ++i) {
+        auto& sec = bsp.sectors[i];
+        if(sec.name.empty())
+          continue;
+        first.emplace(sec.name,uint32_t(i));
+        for(auto r:sec.node_indices) {
+          if(r>=bsp.leaf_node_indices.size() || bsp.leaf_node_indices[r]>=bsp.nodes.size())
+            continue;
+          auto& o = owners[bsp.leaf_node_indices[r]];
+          if(std::find(o.begin(),o.end(),sec.name)==o.end())
+            o.push_back(sec.name);
+          }
+        }
+      }
+
+    std::string_view roomAt(const phoenix::bsp_node& leaf, const Vec3& p) const {
+      // 1cm of tolerance, as in BspRooms
+      const float      eps  = 1.f;
+      const auto&      sh   = leaf.bbox;
+      std::string_view ret;
+      uint32_t         id   = uint32_t(-1);
+      float            dist = std::numeric_limits<float>::max();
+      for(auto room:owners[size_t(&leaf-bsp.nodes.data())]) {
+        for(size_t i=0; i<owners.size(); ++i) {
+          if(owners[i].size()!=1 || owners[i][0]!=room)
+            continue;
+          auto& b = bsp.nodes[i].bbox;
+          if(!(b.min.x<=sh.max.x+eps && sh.min.x<=b.max.x+eps &&
+               b.min.y<=sh.max.y+eps && sh.min.y<=b.max.y+eps &&
+               b.min.z<=sh.max.z+eps && sh.min.z<=b.max.z+eps))
+            continue;
+          const float    dx  = std::max({b.min.x-p.x, 0.f, p.x-b.max.x});
+          const float    dy  = std::max({b.min.y-p.y, 0.f, p.y-b.max.y});
+          const float    dz  = std::max({b.min.z-p.z, 0.f, p.z-b.max.z});
+          const float    d   = dx*dx + dy*dy + dz*dz;
+          const uint32_t rid = first.find(room)->second;
+          if(d<dist || (d==dist && rid<id)) {
+            ret  = room;
+            id   = rid;
+            dist = d;
+            }
+          }
+        }
+      return ret;
+      }
+
+  private:
+    const phoenix::bsp_tree&                      bsp;
+    std::vector<std::vector<std::string_view>>    owners; // distinct named sectors of every leaf
+    std::unordered_map<std::string_view,uint32_t> first;  // room id: index of first sector with the name
+  };
+
+// WayMatrix::findFreePoint before WayIndex: points of a name prefix sorted by x, scan of slab x+/-R
+template<class Filter>
+const WayPoint* legacyFindFreePoint(const std::vector<const WayPoint*>& index, const Vec3& at, float R, const Filter& filter) {
+  auto b = std::lower_bound(index.begin(),index.end(), at.x-R ,[](const WayPoint *a, float b){
+    return a->x<b;
+    });
+  auto e = std::upper_bound(index.begin(),index.end(), at.x+R ,[](float a,const WayPoint *b){
+    return a<b->x;
+    });
+
+  const WayPoint* ret  = nullptr;
+  float           dist = R*R;
+  for(auto i=b;i!=e;++i){
+    auto& w  = **i;
+    auto  dp = w.position()-at;
+    float l  = dp.quadLength();
+    if(l>dist || dp.z*dp.z>300*300)
+      continue;
+    if(!filter(w))
+      continue;
+    ret  = &w;
+    dist = l;
+    }
+  return ret;
+  }
+
+// WayMatrix::findWayPoint before WayIndex: filter is called for every waypoint
+template<class Filter>
+const WayPoint* legacyFindWayPoint(const WayMatrix& wm, const Vec3& at, const Filter& filter) {
+  const WayPoint* ret  = nullptr;
+  float           dist = std::numeric_limits<float>::max();
+  for(size_t i=0; i<wm.wayPointsCount(); ++i) {
+    auto& w = wm.wayPoint(i);
+    if(!filter(w))
+      continue;
+    float l = (at-w.position()).quadLength();
+    l += std::min(l,150.f*150.f);
+    if(l<dist){
+      ret  = &w;
+      dist = l;
+      }
+    }
+  return ret;
+  }
+
+}
+
+Benchmark::Benchmark(std::function<void(std::string_view)> print)
+  :print(std::move(print)) {
+  }
+
+template<class ... Args>
+void Benchmark::report(const Args&... args) {
+  string_frm msg(args...);
+  Log::i(msg);
+  print(msg);
+  }
+
+template<class ... Args>
+void Benchmark::reportError(const Args&... args) {
+  string_frm msg(args...);
+  Log::e(msg);
+  print(msg);
+  }
+
+bool Benchmark::exec(std::string_view name) {
+  static const struct {
+    std::string_view name;
+    void (Benchmark::*run)();
+    } bench[] = {
+    {"workers",  &Benchmark::workers     },
+    {"spatial",  &Benchmark::spatial     },
+    {"items",    &Benchmark::items       },
+    {"rooms",    &Benchmark::rooms       },
+    {"waynet",   &Benchmark::waynet      },
+    {"fp",       &Benchmark::freepoints  },
+    {"rays",     &Benchmark::rays        },
+    {"texq",     &Benchmark::textureQueue},
+    {"vdfs",     &Benchmark::vdfs        },
+    {"assets",   &Benchmark::assets      },
+    {"pose",     &Benchmark::pose        },
+    {"animpack", &Benchmark::animPack    },
+    {"animload", &Benchmark::animLoad    },
+    {"crowd",    &Benchmark::crowd       },
+    };
+  for(auto& i:bench)
+    if(i.name==name) {
+      (this->*i.run)();
+      return true;
+      }
+  return false;
+  }
+
+void Benchmark::workers() {
+  const size_t  maxTh = Workers::maxThreads();
+  const auto    st0   = Workers::stats();
+  LegacyWorkers legacyPool;
+
+  {
+  // dispatch latency: tiny payload, cost dominated by fork/join
+  std::vector<uint32_t> data(maxTh);
+  const int             iter = 10000;
+  double                legacy = 0, dispatch = 0;
+  {
+  Timer t;
+  for(int i=0; i<iter; ++i) {
+    legacyPool.parallelFor(data,[](uint32_t& v){ ++v; });
+    }
+  legacy = t.us()/iter;
+  }
+  {
+  Timer t;
+  for(int i=0; i<iter; ++i) {
+    Workers::parallelFor(data,[](uint32_t& v){ ++v; });
+    }
+  dispatch = t.us()/iter;
+  }
+  report("workers: parallelFor dispatch ",float(legacy)," -> ",float(dispatch)," us");
+  }
+
+  {
+  // task graph: 4-stage chain, similar to npc -> anim -> visibility -> commit
+  const int iter = 10000;
+  double    legacy = 0, graph = 0;
+  {
+  // same chain as serial barriers: one fork/join per stage, 3rd stage joins 2nd and 3rd tasks
+  std::vector<uint32_t> one(1), two(2);
+  Timer t;
+  for(int i=0; i<iter; ++i) {
+    legacyPool.parallelFor(one,[](uint32_t&){});
+    legacyPool.parallelFor(one,[](uint32_t&){});
+    legacyPool.parallelFor(two,[](uint32_t&){});
+    }
+  legacy = t.us()/iter;
+  }
+  {
+  Timer t;
+  for(int i=0; i<iter; ++i) {
+    auto a = Workers::async([](){});
+    auto b = Workers::then(a,[](){});
+    auto c = Workers::then(b,[](){});
+    auto d = Workers::async({b,c},[](){});
+    d.wait();
+    }
+  graph = t.us()/iter;
+  }
+  report("workers: 4-task graph ",float(graph)," us, as fork/join barriers ",float(legacy)," us");
+  }
+
+  // scaling: fixed amount of ALU work split across 1..N threads; old pool had at most 16 threads
+  std::vector<float> data(1024*1024);
+  auto   work   = [](float& v){
+    for(int r=0; r<16; ++r)
+      v = std::sqrt(v*v+1.f);
+    };
+  double base   = 0;
+  double legacy = 0;
+  for(size_t th=1; th<=maxTh; th*=2) {
+    const int iter = 16;
+    double    dt   = 0, ldt = 0;
+    {
+    Timer t;
+    for(int i=0; i<iter; ++i)
+      legacyPool.parallelFor(data,th,work);
+    ldt = t.us()/iter;
+    }
+    {
+    Timer t;
+    for(int i=0; i<iter; ++i)
+      Workers::parallelFor(data,th,work);
+    dt = t.us()/iter;
+    }
+    if(th==1) {
+      base   = dt;
+      legacy = ldt;
+      }
+    report("workers: threads=",int(th)," ",float(ldt)," -> ",float(dt)," us, speedup x",float(legacy/ldt)," -> x",float(base/dt),
+           th>size_t(LegacyWorkers::MAX_THREADS) ? " (old pool capped at 16)" : "");
+    }
+
+  const auto st1   = Workers::stats();
+  const auto calls = std::max<uint64_t>(1,st1.calls-st0.calls);
+  const double dispatch = double(st1.dispatchNs-st0.dispatchNs)/double(calls)/1000.0;
+  const double join     = double(st1.joinNs    -st0.joinNs    )/double(calls)/1000.0;
+  report("workers: overhead per call: dispatch ",float(dispatch)," us, join ",float(join)," us,",
+         " total ",float(dispatch+join)," us; helpers reclaimed ",unsigned(st1.reclaimed-st0.reclaimed),
+         ", foreign jobs in waits ",float(double(st1.foreignNs-st0.foreignNs)/1000.0)," us");
+  }
+
+void Benchmark::spatial() {
+  // few thousand agents over a Khorinis-sized area, queried with typical senses_range
+  struct Agent {
+    Vec3 pos;
+    };
+  const size_t count  = 4000;
+  const float  extent = 40000;
+  const float  range  = 2000;
+  const int    iter   = 20000;
+
+  std::mt19937                          rng(0);
+  std::uniform_real_distribution<float> coord(-extent*0.5f,extent*0.5f);
+  std::uniform_real_distribution<float> step(-50.f,50.f);
+
+  std::vector<Agent> agents(count);
+  for(auto& i:agents)
+    i.pos = Vec3(coord(rng),coord(rng)*0.05f,coord(rng));
+
+  std::vector<Vec3> query(1024);
+  for(auto& i:query)
+    i = agents[rng()%count].pos;
+
+  size_t hits   = 0;
+  double linear = 0;
+  {
+  Timer t;
+  for(int i=0; i<iter; ++i) {
+    auto& p = query[size_t(i)%query.size()];
+    for(auto& a:agents)
+      if((a.pos-p).quadLength()<range*range)
+        ++hits;
+    }
+  linear = t.us()/iter;
+  }
+
+  SpatialGrid<Agent> grid(1000.f);
+  double build = 0;
+  {
+  Timer t;
+  for(size_t i=0; i<agents.size(); ++i)
+    grid.insert(&agents[i],agents[i].pos,uint32_t(i));
+  build = t.us();
+  }
+
+  size_t gridHits = 0;
+  double radius   = 0;
+  {
+  Timer t;
+  for(int i=0; i<iter; ++i) {
+    grid.find(query[size_t(i)%query.size()],range,[&gridHits](Agent&){ ++gridHits; });
+    }
+  radius = t.us()/iter;
+  }
+
+  size_t coneHits = 0;
+  double cone     = 0;
+  {
+  Timer t;
+  for(int i=0; i<iter; ++i) {
+    const float a = float(i)*0.1f;
+    grid.find(query[size_t(i)%query.size()],range,Vec2(std::cos(a),std::sin(a)),0.7f,[&coneHits](Agent&){ ++coneHits; });
+    }
+  cone = t.us()/iter;
+  }
+
+  double move = 0;
+  {
+  // one simulation tick: everybody walks a bit
+  Timer t;
+  for(auto& i:agents) {
+    i.pos.x += step(rng);
+    i.pos.z += step(rng);
+    grid.move(&i,i.pos);
+    }
+  move = t.us();
+  }
+
+  if(hits!=gridHits)
+    reportError("spatial: grid query mismatch ",int(hits)," vs ",int(gridHits));
+
+  report("spatial: ",int(count)," agents, linear ",float(linear)," us, grid ",float(radius)," us, cone ",float(cone)," us",
+         " (x",float(linear/radius),"); build ",float(build)," us, tick update ",float(move)," us",
+         "; avg neighbours ",float(double(hits)/iter),", in cone ",float(double(coneHits)/iter));
+  }
+
+void Benchmark::items() {
+  // stress for item SpaceIndex: thousands of items around the player, moved, re-added and queried every frame
+  World* world  = Gothic::inst().world();
+  Npc*   player = Gothic::inst().player();
+  if(world==nullptr || player==nullptr) {
+    print("items: world is not loaded");
+    return;
+    }
+
+  size_t cls = size_t(-1);
+  for(auto name:{"ItMi_Gold","ItMiNugget"}) {
+    cls = world->script().getSymbolIndex(name);
+    if(cls!=size_t(-1))
+      break;
+    }
+  if(cls==size_t(-1)) {
+    print("items: no suitable item class");
+    return;
+    }
+
+  const size_t count  = 2000;
+  const size_t churn  = count/10;
+  const int    frames = 30;
+  const int    query  = 256;
+  const float  extent = 8000;
+  const Vec3   center = player->position();
+
+  std::mt19937                          rng(0);
+  std::uniform_real_distribution<float> coord(-extent*0.5f,extent*0.5f);
+  auto rndPos = [&]() { return center+Vec3(coord(rng),0,coord(rng)); };
+
+  std::vector<Item*> spawned;
+  spawned.reserve(count);
+  double add = 0, del = 0, move = 0, find = 0;
+  size_t hits = 0, removed = 0;
+
+  {
+  Timer t;
+  for(size_t i=0; i<count; ++i)
+    spawned.push_back(world->addItem(cls,rndPos()));
+  add += t.us();
+  }
+
+  for(int f=0; f<frames; ++f) {
+    {
+    Timer t;
+    for(auto i:spawned) {
+      auto p = rndPos();
+      i->setPosition(p.x,p.y,p.z);
+      }
+    move += t.us();
+    }
+    {
+    Timer t;
+    for(size_t i=0; i<churn; ++i) {
+      auto& it = spawned[rng()%count];
+      if(it==nullptr)
+        continue;
+      world->removeItem(*it);
+      it = nullptr;
+      ++removed;
+      }
+    del += t.us();
+    }
+    {
+    Timer t;
+    for(auto& i:spawned)
+      if(i==nullptr)
+        i = world->addItem(cls,rndPos());
+    add += t.us();
+    }
+    {
+    Timer t;
+    for(int i=0; i<query; ++i)
+      world->detectItem(rndPos(),1000,[&hits](Item&){ ++hits; });
+    find += t.us();
+    }
+    }
+
+  for(auto i:spawned)
+    world->removeItem(*i);
+
+  const double moves = double(count)*frames;
+  report("items: ",int(count)," items, ",int(frames)," frames; move ",float(move/moves)," us",
+         ", query ",float(find/(query*frames))," us (",float(double(hits)/(query*frames))," hits)",
+         ", add ",float(add/double(count+removed))," us, remove ",float(del/double(std::max<size_t>(removed,1)))," us");
+  }
+
+void Benchmark::rooms() {
+  World* world = Gothic::inst().world();
+  if(world==nullptr) {
+    print("rooms: world is not loaded");
+    return;
+    }
+
+  // npc positions, walked a little per sample - same pattern as perception checks
+  std::vector<Vec3> pos;
+  for(uint32_t i=0; i<world->npcCount(); ++i)
+    pos.push_back(world->npcById(i)->position());
+  if(pos.empty()) {
+    print("rooms: no npc in world");
+    return;
+    }
+
+  const int   steps = 64;
+  const float speed = 5.f;
+  std::vector<Vec3> pts;
+  for(auto& p:pos)
+    for(int i=0; i<steps; ++i)
+      pts.push_back(p+Vec3(float(i)*speed,0,float(i)*speed*0.5f));
+
+  auto& bsp = world->bspTree();
+  size_t mismatch = 0;
+
+  double legacy = 0;
+  std::vector<std::string_view>         names(pts.size());
+  std::vector<const phoenix::bsp_node*> shared(pts.size());
+  {
+  Timer t;
+  for(size_t i=0; i<pts.size(); ++i)
+    names[i] = legacyRoomAt(bsp,pts[i],shared[i]);
+  legacy = t.us();
+  }
+
+  // not timed: portals were not resolved before BspRooms
+  size_t portals = 0;
+  {
+  LegacyPortals lp(bsp);
+  for(size_t i=0; i<pts.size(); ++i)
+    if(shared[i]!=nullptr) {
+      names[i] = lp.roomAt(*shared[i],pts[i]);
+      ++portals;
+      }
+  }
+
+  double table = 0;
+  std::vector<uint32_t> ids(pts.size());
+  {
+  Timer t;
+  for(size_t i=0; i<pts.size(); ++i)
+    ids[i] = world->roomIdAt(pts[i]);
+  table = t.us();
+  }
+  for(size_t i=0; i<pts.size(); ++i)
+    if(world->roomName(ids[i])!=names[i])
+      ++mismatch;
+
+  double cached = 0;
+  {
+  Timer t;
+  for(size_t n=0; n<pos.size(); ++n) {
+    BspRooms::Cache cache;
+    for(int i=0; i<steps; ++i) {
+      size_t id = n*steps+size_t(i);
+      ids[id] = world->roomIdAt(pts[id],cache);
+      }
+    }
+  cached = t.us();
+  }
+  for(size_t i=0; i<pts.size(); ++i)
+    if(world->roomName(ids[i])!=names[i])
+      ++mismatch;
+
+  double batch = 0;
+  {
+  Timer t;
+  world->roomIdAt(pts.data(),pts.size(),ids.data());
+  batch = t.us();
+  }
+  for(size_t i=0; i<pts.size(); ++i)
+    if(world->roomName(ids[i])!=names[i])
+      ++mismatch;
+
+  const double n = double(pts.size());
+  report("rooms: ",int(pts.size())," queries (",int(portals)," on shared leaves); legacy ",float(legacy/n*1000.0)," ns",
+         ", table ",float(table/n*1000.0)," ns, cached ",float(cached/n*1000.0)," ns",
+         ", batch ",float(batch/n*1000.0)," ns");
+  if(mismatch>0)
+    reportError("rooms: ",int(mismatch)," results differ from sector scan");
+  }
+
+void Benchmark::waynet() {
+  World* world = Gothic::inst().world();
+  if(world==nullptr) {
+    print("waynet: world is not loaded");
+    return;
+    }
+
+  auto& wm = world->wayMatrix();
+  std::vector<const WayPoint*> points;
+  for(size_t i=0; i<wm.wayPointsCount(); ++i)
+    if(!wm.wayPoint(i).isFreePoint())
+      points.push_back(&wm.wayPoint(i));
+  if(points.size()<2) {
+    print("waynet: world has no waynet");
+    return;
+    }
+
+  struct Request {
+    const WayPoint* begin = nullptr;
+    const WayPoint* end   = nullptr;
+    };
+  std::mt19937         rng(0);
+  std::vector<Request> req(2000);
+  for(auto& i:req) {
+    i.begin = points[rng()%points.size()];
+    i.end   = points[rng()%points.size()];
+    }
+
+  WayMatrix::Query q;
+  size_t expanded = 0, found = 0;
+  double serial   = 0;
+  {
+  Timer t;
+  for(auto& i:req) {
+    auto path = wm.wayTo(*i.begin,*i.end,q);
+    expanded += q.expanded;
+    if(path.last()!=nullptr)
+      ++found;
+    }
+  serial = t.us();
+  }
+
+  // same requests from worker threads, each with own thread-local query context; fills path cache
+  auto                stat0 = wm.pathCacheStats();
+  std::atomic<size_t> foundMt{0};
+  double parallel = 0;
+  {
+  Timer t;
+  Workers::parallelFor(req,[&wm,&foundMt](Request& i){
+    auto path = wm.wayTo(*i.begin,*i.end);
+    if(path.last()!=nullptr)
+      foundMt.fetch_add(1,std::memory_order_relaxed);
+    });
+  parallel = t.us();
+  }
+
+  // repeated routes, as npc routines do: served from path cache
+  double cached = 0;
+  {
+  Timer t;
+  Workers::parallelFor(req,[&wm](Request& i){
+    wm.wayTo(*i.begin,*i.end);
+    });
+  cached = t.us();
+  }
+  auto stat1 = wm.pathCacheStats();
+
+  const double n = double(req.size());
+  report("waynet: ",int(points.size())," points, ",int(req.size())," queries; ",float(serial/n)," us/query",
+         ", expanded ",float(double(expanded)/n)," nodes, found ",int(found),
+         "; parallel ",float(parallel/n)," us/query");
+  report("waynet: repeated ",float(cached/n)," us/query, cache hits ",unsigned(stat1.hits-stat0.hits),
+         ", misses ",unsigned(stat1.misses-stat0.misses),", evictions ",unsigned(stat1.evictions-stat0.evictions));
+  if(found!=foundMt.load())
+    reportError("waynet: parallel run found ",int(foundMt.load())," paths instead of ",int(found));
+  }
+
+void Benchmark::freepoints() {
+  World* world = Gothic::inst().world();
+  if(world==nullptr || world->player()==nullptr) {
+    print("fp: world is not loaded");
+    return;
+    }
+
+  auto& wm  = world->wayMatrix();
+  auto& npc = *world->player();
+  if(wm.freePointsCount()==0 || wm.wayPointsCount()==0) {
+    print("fp: world has no freepoints");
+    return;
+    }
+
+  // name prefixes, as scripts use them: "FP_ROAM", "FP_SMALLTALK", ...
+  std::vector<std::string> prefix;
+  for(size_t i=0; i<wm.freePointsCount(); ++i) {
+    auto& name = wm.freePoint(i).name;
+    auto  sep  = name.find('_',name.find('_')+1);
+    auto  p    = name.substr(0,sep);
+    if(std::find(prefix.begin(),prefix.end(),p)==prefix.end())
+      prefix.push_back(p);
+    }
+
+  std::vector<std::vector<const WayPoint*>> legacyIndex(prefix.size());
+  for(size_t i=0; i<prefix.size(); ++i) {
+    for(size_t r=0; r<wm.freePointsCount(); ++r)
+      if(wm.freePoint(r).checkName(prefix[i]))
+        legacyIndex[i].push_back(&wm.freePoint(r));
+    std::sort(legacyIndex[i].begin(),legacyIndex[i].end(),[](const WayPoint* a,const WayPoint* b){
+      return a->x<b->x;
+      });
+    }
+
+  // npcs stand near waypoints most of the time
+  struct Request {
+    Vec3   at;
+    size_t prefix = 0;
+    };
+  std::mt19937                          rng(0);
+  std::uniform_real_distribution<float> jitter(-500.f,500.f);
+  std::vector<Request>                  req(20000);
+  for(auto& i:req) {
+    auto& w  = wm.wayPoint(rng()%wm.wayPointsCount());
+    i.at     = w.position()+Vec3(jitter(rng),0,jitter(rng));
+    i.prefix = rng()%prefix.size();
+    }
+
+  const float R      = wm.searchRadius();
+  const auto  isFree = [](const WayPoint& w){ return !w.isLocked(); };
+
+  // compared after timing: same point, or other one at the same distance (ties may resolve differently)
+  struct Result {
+    size_t found    = 0;
+    size_t mismatch = 0;
+    };
+  auto compare = [&req](const std::vector<const WayPoint*>& ref, const std::vector<const WayPoint*>& ret, size_t n) {
+    Result r;
+    for(size_t i=0; i<n; ++i) {
+      auto a = ref[i], b = ret[i];
+      if(a!=nullptr)
+        ++r.found;
+      if(a==b)
+        continue;
+      if(a==nullptr || b==nullptr || (a->position()-req[i].at).quadLength()!=(b->position()-req[i].at).quadLength())
+        ++r.mismatch;
+      }
+    return r;
+    };
+
+  // Wld_IsFPAvailable: nearest unlocked freepoint
+  std::vector<const WayPoint*> ref(req.size()), ret(req.size());
+  double legacyAvail = 0, avail = 0;
+  {
+  Timer t;
+  for(size_t i=0; i<req.size(); ++i)
+    ref[i] = legacyFindFreePoint(legacyIndex[req[i].prefix],req[i].at,R,isFree);
+  legacyAvail = t.us();
+  }
+  {
+  Timer t;
+  for(size_t i=0; i<req.size(); ++i)
+    ret[i] = wm.findFreePoint(req[i].at,prefix[req[i].prefix],isFree);
+  avail = t.us();
+  }
+  const Result resAvail = compare(ref,ret,req.size());
+
+  // AI_GotoFP: nearest unlocked freepoint, that npc can see; ray-test count is the cost
+  const size_t rq         = req.size()/10;
+  size_t       legacyRays = 0, rays = 0;
+  double       legacyGoto = 0, goTo = 0;
+  {
+  Timer t;
+  for(size_t i=0; i<rq; ++i)
+    ref[i] = legacyFindFreePoint(legacyIndex[req[i].prefix],req[i].at,R,[&](const WayPoint& w){
+      ++legacyRays;
+      return !w.isLocked() && npc.canSeeNpc(w.x,w.y+10,w.z,true);
+      });
+  legacyGoto = t.us();
+  }
+  {
+  Timer t;
+  for(size_t i=0; i<rq; ++i)
+    ret[i] = wm.findFreePoint(req[i].at,prefix[req[i].prefix],[&](const WayPoint& w){
+      ++rays;
+      return !w.isLocked() && npc.canSeeNpc(w.x,w.y+10,w.z,true);
+      });
+  goTo = t.us();
+  }
+  const Result resGoto = compare(ref,ret,rq);
+
+  // World::wayTo: nearest visible waypoint to start a route from
+  const size_t wq           = std::max<size_t>(req.size()/200,1);
+  size_t       legacyWpRays = 0, wpRays = 0;
+  double       legacyWp     = 0, wp = 0;
+  {
+  Timer t;
+  for(size_t i=0; i<wq; ++i)
+    ref[i] = legacyFindWayPoint(wm,req[i].at,[&](const WayPoint& w){
+      ++legacyWpRays;
+      return npc.canSeeNpc(w.x,w.y+10,w.z,true);
+      });
+  legacyWp = t.us();
+  }
+  {
+  Timer t;
+  for(size_t i=0; i<wq; ++i)
+    ret[i] = wm.findWayPoint(req[i].at,req[i].at,[&](const WayPoint& w){
+      ++wpRays;
+      return npc.canSeeNpc(w.x,w.y+10,w.z,true);
+      });
+  wp = t.us();
+  }
+  const Result resWp = compare(ref,ret,wq);
+
+  const double n = double(req.size());
+  report("fp: ",int(wm.freePointsCount())," freepoints, ",int(prefix.size())," prefixes; ",
+         "IsFPAvailable ",float(legacyAvail/n)," -> ",float(avail/n)," us/query, ",int(resAvail.found)," of ",int(req.size())," found");
+  report("fp: GotoFP ",float(legacyGoto/double(rq))," -> ",float(goTo/double(rq))," us/query, rays ",
+         float(double(legacyRays)/double(rq))," -> ",float(double(rays)/double(rq))," per query, ",
+         int(resGoto.found)," of ",int(rq)," found");
+  report("fp: waypoint ",float(legacyWp/double(wq))," -> ",float(wp/double(wq))," us/query, rays ",
+         float(double(legacyWpRays)/double(wq))," -> ",float(double(wpRays)/double(wq))," per query, ",
+         int(resWp.found)," of ",int(wq)," found");
+  if(resAvail.mismatch+resGoto.mismatch+resWp.mismatch>0)
+    reportError("fp: results differ from linear search: IsFPAvailable ",int(resAvail.mismatch),
+                ", GotoFP ",int(resGoto.mismatch),", waypoint ",int(resWp.mismatch));
+  }
+
+void Benchmark::rays() {
+  World* world = Gothic::inst().world();
+  if(world==nullptr) {
+    print("rays: world is not loaded");
+    return;
+    }
+
+  auto& wm  = world->wayMatrix();
+  auto& phy = *world->physic();
+  if(wm.wayPointsCount()==0) {
+    print("rays: world has no waynet");
+    return;
+    }
+
+  // line of sight between points of waynet, at eye height, as perception does
+  const size_t                          count = 16*1024;
+  std::mt19937                          rng(0);
+  std::uniform_real_distribution<float> jitter(-1500.f,1500.f);
+  std::vector<Vec3>                     from(count), to(count);
+  for(size_t i=0; i<count; ++i) {
+    auto& w = wm.wayPoint(rng()%wm.wayPointsCount());
+    from[i] = w.position()+Vec3(0,180,0);
+    to  [i] = from[i]+Vec3(jitter(rng),0,jitter(rng));
+    }
+
+  std::vector<DynamicWorld::RayLandResult>  land(count),  landMt(count);
+  std::vector<DynamicWorld::RayLandResult>  los(count),   losMt(count);
+  std::vector<DynamicWorld::RayWaterResult> water(count), waterMt(count);
+
+  double serial[3] = {}, batch[3] = {};
+  {
+  Timer t;
+  for(size_t i=0; i<count; ++i)
+    los[i] = phy.ray(from[i],to[i]);
+  serial[0] = t.us();
+  }
+  {
+  Timer t;
+  for(size_t i=0; i<count; ++i)
+    land[i] = phy.landRay(to[i]);
+  serial[1] = t.us();
+  }
+  {
+  Timer t;
+  for(size_t i=0; i<count; ++i)
+    water[i] = phy.waterRay(to[i]);
+  serial[2] = t.us();
+  }
+
+  {
+  Timer t;
+  phy.ray(from.data(),to.data(),count,losMt.data());
+  batch[0] = t.us();
+  }
+  {
+  Timer t;
+  phy.landRay(to.data(),count,landMt.data());
+  batch[1] = t.us();
+  }
+  {
+  Timer t;
+  phy.waterRay(to.data(),count,waterMt.data());
+  batch[2] = t.us();
+  }
+
+  size_t mismatch = 0, hits = 0;
+  for(size_t i=0; i<count; ++i) {
+    if(los[i].hasCol!=losMt[i].hasCol || los[i].v!=losMt[i].v)
+      ++mismatch;
+    if(land[i].hasCol!=landMt[i].hasCol || land[i].v!=landMt[i].v)
+      ++mismatch;
+    if(water[i].hasCol!=waterMt[i].hasCol || water[i].wdepth!=waterMt[i].wdepth)
+      ++mismatch;
+    if(los[i].hasCol)
+      ++hits;
+    }
+
+  static const char* name[3] = {"los","land","water"};
+  for(int i=0; i<3; ++i) {
+    report("rays: ",name[i]," ",int(count)," rays; ",float(serial[i]/double(count))," us/ray",
+           ", batched ",float(batch[i]/double(count))," us/ray, ",int(Workers::maxThreads())," threads");
+    }
+  report("rays: los blocked ",int(hits)," of ",int(count));
+  if(mismatch>0)
+    reportError("rays: ",int(mismatch)," batched results differ from serial");
+  }
+
+void Benchmark::textureQueue() {
+  // self-check of upload budget and of failed decodes: synthetic textures, no device involved
+  struct Frame {
+    size_t count = 0;
+    size_t bytes = 0;
+    };
+  std::vector<Frame> frames;
+  size_t             empty = 0;
+
+  TextureQueue::Decoder decoder = [](std::string_view name, Pixmap& out) {
+    if(name=="fail")
+      return false;
+    if(name=="throw")
+      throw std::runtime_error("decoder failure");
+    const uint32_t sz = uint32_t(std::atoi(std::string(name).c_str()));
+    out = Pixmap(sz,sz,Pixmap::Format::RGBA);
+    return true;
+    };
+  TextureQueue::Sink sink = [&frames,&empty](const std::string&, Pixmap&& pm) {
+    if(pm.isEmpty())
+      ++empty;
+    frames.back().count += 1;
+    frames.back().bytes += TextureQueue::byteSize(pm);
+    };
+
+  const size_t             budget = 256*256*4;
+  std::vector<std::string> names  = {"fail","throw","512"}; // 512x512 is above budget: must go alone
+  for(int i=0; i<64; ++i)
+    names.push_back(std::to_string(16 << (i%5)));
+
+  TextureQueue queue(decoder,sink);
+  for(auto& i:names)
+    queue.push(i);
+  queue.wait();
+
+  size_t total = 0;
+  while(true) {
+    frames.emplace_back();
+    const size_t n = queue.flush(budget);
+    if(n!=frames.back().count)
+      reportError("texq: flush reported ",int(n)," textures, sink got ",int(frames.back().count));
+    if(n==0)
+      break;
+    if(frames.back().bytes>budget && frames.back().count>1)
+      reportError("texq: frame ",int(frames.size())," uploaded ",int(frames.back().bytes)," bytes over budget of ",int(budget));
+    total += n;
+    }
+
+  const auto st = queue.stats();
+  if(total!=names.size())
+    reportError("texq: ",int(total)," of ",int(names.size())," textures reached the sink");
+  if(empty!=2 || st.failed!=2 || st.uploaded!=names.size()-2)
+    reportError("texq: failed decodes: ",int(empty)," empty pixmaps, stats failed ",int(st.failed),", uploaded ",int(st.uploaded));
+  if(st.decoding!=0 || st.ready!=0)
+    reportError("texq: queue is not drained: decoding ",int(st.decoding),", ready ",int(st.ready));
+  report("texq: ",int(names.size())," textures in ",int(frames.size()-1)," frames, budget ",int(budget/1024)," KiB");
+  }
+
+void Benchmark::vdfs() {
+  // lookup pattern of asset loading: mostly existing names in mixed case, some probes of rewritten extensions, that miss
+  std::vector<std::string> names;
+  double                   build = 0;
+  VdfsIndex                index;
+  {
+  Timer t;
+  index = VdfsIndex(Resources::vdfsIndex());
+  build = t.us();
+  }
+  index.forEach([&names](std::string_view name, const phoenix::vdf_entry& e){
+    if(!e.is_directory())
+      names.emplace_back(name);
+    });
+  if(names.empty()) {
+    print("vdfs: no archives loaded");
+    return;
+    }
+
+  std::mt19937 rng(0);
+  std::shuffle(names.begin(),names.end(),rng);
+  for(size_t i=0; i<names.size(); ++i) {
+    auto& n = names[i];
+    if(i%2==0)
+      std::transform(n.begin(),n.end(),n.begin(),[](char c){ return char(std::tolower(c)); });
+    if(i%8==0)
+      n += ".MISS";
+    }
+
+  const size_t count = std::min<size_t>(names.size(),32*1024);
+  size_t found[2] = {};
+  double time [2] = {};
+  {
+  Timer t;
+  for(size_t i=0; i<count; ++i)
+    if(Resources::vdfsIndex().find_entry(names[i])!=nullptr)
+      ++found[0];
+  time[0] = t.us();
+  }
+  {
+  Timer t;
+  for(size_t i=0; i<count; ++i)
+    if(Resources::findFile(names[i])!=nullptr)
+      ++found[1];
+  time[1] = t.us();
+  }
+
+  const double perSec[2] = {double(count)*1e6/std::max(time[0],1.0), double(count)*1e6/std::max(time[1],1.0)};
+  report("vdfs: ",int(index.size())," entries, ",int(count)," lookups; tree ",float(perSec[0]/1e6)," M/s",
+         ", index ",float(perSec[1]/1e6)," M/s (x",float(perSec[1]/perSec[0]),"); index build ",float(build/1000.0)," ms");
+  if(found[0]!=found[1])
+    reportError("vdfs: index found ",int(found[1])," files, tree ",int(found[0]));
+  }
+
+void Benchmark::assets() {
+  // cold: sources are parsed and packed, as on first start; warm: same assets from on-disk cache
+  if(!AssetCache::isEnabled()) {
+    print("assets: asset cache is disabled");
+    return;
+    }
+
+  static const char* ext[] = {"MRM","MDM","MDH","MAN"};
+  std::vector<const phoenix::vdf_entry*> files[4];
+  VdfsIndex(Resources::vdfsIndex()).forEach([&files](std::string_view name, const phoenix::vdf_entry& e){
+    if(e.is_directory())
+      return;
+    for(size_t i=0; i<4; ++i)
+      if(FileExt::hasExt(name,ext[i]))
+        files[i].push_back(&e);
+    });
+
+  std::mt19937 rng(0);
+  for(auto& i:files) {
+    std::shuffle(i.begin(),i.end(),rng);
+    if(i.size()>512)
+      i.resize(512);
+    }
+
+  auto measure = [this](const char* kind, const std::vector<const phoenix::vdf_entry*>& files, auto bake, auto cached) {
+    if(files.empty())
+      return;
+    size_t failed = 0;
+    auto   run    = [&failed,&files](auto fn) {
+      Timer t;
+      for(auto e:files) {
+        try {
+          fn(*e);
+          }
+        catch(...) {
+          ++failed;
+          }
+        }
+      return t.us();
+      };
+
+    const double cold   = run(bake);
+    const size_t broken = failed;
+    run(cached); // populate cache files, if any are missing or stale
+    const auto   st0    = AssetCache::stats();
+    const double warm   = run(cached);
+    const auto   st1    = AssetCache::stats();
+
+    const double n = double(files.size());
+    report("assets: ",kind," ",int(files.size())," files; cold ",float(cold/n)," us, warm ",float(warm/n)," us",
+           " (x",float(cold/std::max(warm,1.0)),"), hits ",int(st1.hits-st0.hits),", failed ",int(broken));
+    };
+
+  measure(ext[0],files[0],AssetCache::bakeMesh,     AssetCache::mesh);
+  measure(ext[1],files[1],AssetCache::bakeModel,    AssetCache::model);
+  measure(ext[2],files[2],AssetCache::bakeHierarchy,AssetCache::hierarchy);
+  measure(ext[3],files[3],AssetCache::bakeAnimation,AssetCache::animation);
+  }
+
+void Benchmark::pose() {
+  // steady state of Pose::update for a crowd: one looping sequence, sampled at different time per skeleton
+  static const size_t count = 1000;
+  const Skeleton* sk = Resources::loadSkeleton("HUMANS.MDS");
+  const Animation::Sequence* sq = sk!=nullptr ? sk->sequence("S_RUNL") : nullptr;
+  if(sq==nullptr || sq->data==nullptr || sq->data->numFrames==0 || sq->data->nodeIndex.empty()) {
+    print("pose: HUMANS.MDS or S_RUNL is not available");
+    return;
+    }
+  if(!sk->ordered || sk->nodes.size()>BoneSamples::Capacity) {
+    print("pose: skeleton layout is not supported");
+    return;
+    }
+
+  auto&        d         = *sq->data;
+  auto&        nodes     = sk->nodes;
+  const size_t numBones  = nodes.size();
+  const size_t numTracks = std::min(d.nodeIndex.size(),BoneSamples::Capacity);
+
+  struct Frame {
+    size_t a = 0, b = 0;
+    float  t = 0;
+    };
+  auto frameAt = [&d](size_t i) {
+    uint64_t frame = uint64_t(float(i*37)*d.fpsRate);
+    Frame    f;
+    f.a = size_t((frame/1000)%d.numFrames);
+    f.b = size_t((frame/1000+1)%d.numFrames);
+    f.t = float(frame%1000)/1000.f;
+    return f;
+    };
+
+  // Pose before SoA kernels: per-bone slerp and full matrix products, parent by parent
+  struct LegacyPose {
+    phoenix::animation_sample base[Resources::MAX_NUM_SKELETAL_NODES] = {};
+    bool                      has [Resources::MAX_NUM_SKELETAL_NODES] = {};
+    Matrix4x4                 tr  [Resources::MAX_NUM_SKELETAL_NODES];
+    };
+  struct SoaPose {
+    BoneSamples base;
+    bool        has[Resources::MAX_NUM_SKELETAL_NODES] = {};
+    Matrix4x4   tr [Resources::MAX_NUM_SKELETAL_NODES];
+    };
+  std::vector<LegacyPose> legacy(count);
+  std::vector<SoaPose>    soa(count);
+  phoenix::animation_sample bufA[BoneSamples::Capacity], bufB[BoneSamples::Capacity];
+
+  auto runLegacy = [&]() {
+    for(size_t k=0; k<count; ++k) {
+      auto& p  = legacy[k];
+      auto  f  = frameAt(k);
+      auto* sa = d.frame(f.a,bufA,numTracks);
+      auto* sb = d.frame(f.b,bufB,numTracks);
+      for(size_t i=0; i<numTracks; ++i) {
+        size_t idx = d.nodeIndex[i];
+        if(idx>=numBones)
+          continue;
+        p.base[idx] = mix(sa[i],sb[i],f.t);
+        p.has [idx] = true;
+        }
+      for(size_t i=0; i<numBones; ++i) {
+        auto mat = p.has[i] ? mkMatrix(p.base[i]) : nodes[i].tr;
+        if(nodes[i].parent<numBones)
+          p.tr[i] = p.tr[nodes[i].parent]*mat; else
+          p.tr[i] = mat;
+        }
+      }
+    };
+
+  auto runSoa = [&]() {
+    for(size_t k=0; k<count; ++k) {
+      auto& p  = soa[k];
+      auto  f  = frameAt(k);
+      auto* sa = d.frame(f.a,bufA,numTracks);
+      auto* sb = d.frame(f.b,bufB,numTracks);
+
+      BoneSamples smp, cur;
+      alignas(32) float weight[BoneSamples::Capacity] = {};
+      AnimSimd::sample(smp,sa,sb,numTracks,f.t);
+      for(size_t i=0; i<numTracks; ++i) {
+        size_t idx = d.nodeIndex[i];
+        if(idx>=numBones)
+          continue;
+        cur.copy(idx,smp,i);
+        weight[idx] = 1;
+        p.has [idx] = true;
+        }
+      AnimSimd::blend(p.base,cur,weight,numBones);
+
+      Matrix4x4 local[Resources::MAX_NUM_SKELETAL_NODES];
+      AnimSimd::toMatrix(local,p.base,numBones);
+      for(size_t i=0; i<numBones; ++i) {
+        auto& mat = p.has[i] ? local[i] : nodes[i].tr;
+        if(nodes[i].parent<numBones)
+          AnimSimd::mul(p.tr[i],p.tr[nodes[i].parent],mat); else
+          p.tr[i] = mat;
+        }
+      }
+    };
+
+  // first pass brings both sets of poses into memory
+  runLegacy();
+  runSoa();
+  Timer t0;
+  runLegacy();
+  const double legacyUs = t0.us();
+  Timer t1;
+  runSoa();
+  const double soaUs = t1.us();
+
+  // deviation of model-space positions of bones, relative to skeleton size
+  float maxErr = 0, maxPos = 0;
+  for(size_t k=0; k<count; ++k)
+    for(size_t i=0; i<numBones; ++i)
+      for(int c=0; c<3; ++c) {
+        maxErr = std::max(maxErr,std::abs(legacy[k].tr[i].at(3,c)-soa[k].tr[i].at(3,c)));
+        maxPos = std::max(maxPos,std::abs(legacy[k].tr[i].at(3,c)));
+        }
+
+  report("pose: ",int(count)," skeletons x ",int(numBones)," bones (",AnimSimd::isa(),"); legacy ",float(legacyUs/count)," us,",
+         " soa ",float(soaUs/count)," us (x",float(legacyUs/std::max(soaUs,1.0)),"), max deviation ",maxErr," of ",maxPos);
+  }
+
+void Benchmark::animPack() {
+  // memory of HUMANS.MDS samples and decode cost of S_RUNL
+  const Animation*           anim = Resources::loadAnimation("HUMANS.MDS");
+  const Animation::Sequence* sq   = anim!=nullptr ? anim->sequence("S_RUNL") : nullptr;
+  if(sq==nullptr || sq->data==nullptr || sq->data->nodeIndex.empty()) {
+    print("animpack: HUMANS.MDS or S_RUNL is not available");
+    return;
+    }
+
+  // with lazy loading, only sequences in use are resident
+  anim->warmup("").wait();
+  auto st = anim->sampleStats();
+  report("animpack: HUMANS.MDS ",unsigned(st.sequences)," sequences, samples ",unsigned(st.rawBytes/1024)," KiB,",
+         " stored ",unsigned(st.bytes/1024)," KiB",AnimPack::isEnabled() ? "" : " (packing is disabled)");
+
+  // with packing disabled S_RUNL is packed here, what also allows to measure the error
+  auto&           d         = *sq->data;
+  const size_t    numTracks = d.nodeIndex.size();
+  AnimPack        local;
+  const AnimPack* pk        = &d.packed;
+  if(pk->isEmpty()) {
+    local = AnimPack(d.samples,numTracks);
+    pk    = &local;
+    }
+  if(pk->isEmpty()) {
+    print("animpack: unable to pack S_RUNL");
+    return;
+    }
+
+  static const size_t passes = 4000;
+  const size_t frames = pk->size()/numTracks;
+  std::vector<phoenix::animation_sample> buf(numTracks);
+  pk->decode(buf.data(),0,numTracks);
+  Timer t;
+  for(size_t i=0; i<passes; ++i)
+    pk->decode(buf.data(),i%frames,numTracks);
+  const double ns = t.us()*1000.0/double(passes*numTracks);
+
+  float maxRot = 0, maxPos = 0;
+  if(!d.samples.empty()) {
+    for(size_t f=0; f<frames; ++f) {
+      pk->decode(buf.data(),f,numTracks);
+      for(size_t i=0; i<numTracks; ++i) {
+        auto& a = buf[i];
+        auto& b = d.samples[f*numTracks+i];
+        // q and -q are the same rotation; angle from chord is stable for small errors
+        float dot  = a.rotation.x*b.rotation.x + a.rotation.y*b.rotation.y + a.rotation.z*b.rotation.z + a.rotation.w*b.rotation.w;
+        float s    = dot<0 ? -1.f : 1.f;
+        float dx   = a.rotation.x-s*b.rotation.x, dy = a.rotation.y-s*b.rotation.y;
+        float dz   = a.rotation.z-s*b.rotation.z, dw = a.rotation.w-s*b.rotation.w;
+        float ch   = std::sqrt(dx*dx + dy*dy + dz*dz + dw*dw);
+        maxRot = std::max(maxRot,4.f*std::asin(std::min(ch*0.5f,1.f)));
+        maxPos = std::max(maxPos,std::abs(a.position.x-b.position.x));
+        maxPos = std::max(maxPos,std::abs(a.position.y-b.position.y));
+        maxPos = std::max(maxPos,std::abs(a.position.z-b.position.z));
+        }
+      }
+    }
+
+  report("animpack: S_RUNL ",unsigned(numTracks)," tracks x ",unsigned(frames)," frames, ",
+         unsigned(pk->size()*sizeof(phoenix::animation_sample))," -> ",unsigned(pk->memoryUsage())," bytes,",
+         " decode ",float(ns)," ns per bone, max error: rotation ",maxRot," rad, position ",maxPos);
+  }
+
+void Benchmark::animLoad() {
+  // HUMANS.MDS with samples read in constructor and on first use; asset cache is warm in both cases
+  const bool        g2    = Gothic::inst().version().game==2;
+  const auto*       entry = Resources::findFile(g2 ? "HUMANS.MSB" : "HUMANS.MDS");
+  if(entry==nullptr) {
+    print("animload: HUMANS.MDS is not available");
+    return;
+    }
+
+  const bool lazy  = Animation::isLazyLoad();
+  auto       build = [entry,g2](bool lz, double& us) {
+    Animation::setLazyLoad(lz);
+    auto   reader = entry->open();
+    auto   p      = phoenix::model_script::parse(reader);
+    Timer  t;
+    auto   ret    = std::make_unique<Animation>(p,"HUMANS",!g2);
+    us = t.us();
+    return ret;
+    };
+
+  double warm = 0, eagerUs = 0, lazyUs = 0;
+  build(false,warm); // populate asset cache
+  auto eager = build(false,eagerUs);
+  auto ondem = build(true, lazyUs);
+  Animation::setLazyLoad(lazy);
+
+  const size_t initial = ondem->memoryUsage();
+  const auto   st0     = Animation::loadStats();
+  Timer t;
+  ondem->warmup("1H").wait();
+  const double fightUs = t.us();
+  const auto   st1     = Animation::loadStats();
+  const size_t fight   = ondem->memoryUsage();
+  ondem->warmup("").wait();
+  const auto   st2     = Animation::loadStats();
+
+  report("animload: HUMANS.MDS eager ",float(eagerUs/1000.0)," ms, ",unsigned(eager->memoryUsage()/1024)," KiB;",
+         " lazy ",float(lazyUs/1000.0)," ms, ",unsigned(initial/1024)," KiB;",
+         " 1H warm-up ",unsigned(st1.loads-st0.loads)," sequences in ",float(fightUs/1000.0)," ms, ",unsigned(fight/1024)," KiB;",
+         " all ",unsigned(st2.loads-st0.loads)," sequences, ",float(double(st2.loadUs-st0.loadUs)/1000.0)," ms of loading, ",
+         unsigned(ondem->memoryUsage()/1024)," KiB");
+  }
+
+void Benchmark::crowd() {
+  // idle crowd in town: everyone plays S_RUN on HUMANS.MDS; groups of npc started idle at same time,
+  // as daily routines of many npc change at once. Pose::update without and with shared pose cache
+  static const size_t count  = 512;
+  static const size_t groups = 24;
+  static const size_t frames = 120;
+  const Skeleton*            sk = Resources::loadSkeleton("HUMANS.MDS");
+  const Animation::Sequence* sq = sk!=nullptr ? sk->sequence("S_RUN") : nullptr;
+  if(sq==nullptr || sq->data==nullptr || sq->data->numFrames==0) {
+    print("crowd: HUMANS.MDS or S_RUN is not available");
+    return;
+    }
+
+  AnimationSolver solver;
+  solver.setSkeleton(sk);
+  const uint64_t start = 1000;
+  auto mkCrowd = [&]() {
+    std::vector<std::unique_ptr<Pose>> ret(count);
+    for(size_t i=0; i<count; ++i) {
+      ret[i].reset(new Pose());
+      auto& p = *ret[i];
+      p.setSkeleton(sk);
+      p.setObjectMatrix(Matrix4x4::mkIdentity(),false);
+      p.startAnim(solver,sq,0,BS_STAND,Pose::NoHint,start+(i%groups)*37);
+      // some of them look around
+      if(i%4==0)
+        p.setHeadRotation(0.1f*float(i%7),0.05f*float(i%5));
+      }
+    return ret;
+    };
+
+  auto plain  = mkCrowd();
+  auto shared = mkCrowd();
+  PoseCache cache;
+
+  auto run = [&](std::vector<std::unique_ptr<Pose>>& crowd, PoseCache* c, uint64_t& lookups, uint64_t& hits) {
+    Timer t;
+    for(size_t f=0; f<frames; ++f) {
+      const uint64_t tick = start + groups*37 + 1000 + f*16;
+      if(c!=nullptr)
+        c->beginFrame(true);
+      Workers::parallelTasks(crowd,[c,tick](std::unique_ptr<Pose>& p){
+        p->update(tick,c);
+        });
+      if(c!=nullptr) {
+        c->endFrame();
+        lookups += c->stats().lookups;
+        hits    += c->stats().hits;
+        }
+      }
+    return t.us();
+    };
+
+  // first pass brings poses and cache entries into memory
+  uint64_t lookups = 0, hits = 0;
+  run(plain, nullptr,lookups,hits);
+  run(shared,&cache, lookups,hits);
+  lookups = hits = 0;
+  const double plainUs  = run(plain, nullptr,lookups,hits);
+  const double sharedUs = run(shared,&cache, lookups,hits);
+
+  // quantized sample time: deviation of model-space bone positions on last frame
+  float maxErr = 0;
+  for(size_t k=0; k<count; ++k)
+    for(size_t i=0; i<plain[k]->boneCount(); ++i)
+      for(int c=0; c<3; ++c)
+        maxErr = std::max(maxErr,std::abs(plain[k]->bone(i).at(3,c)-shared[k]->bone(i).at(3,c)));
+
+  report("crowd: ",unsigned(count)," npc, ",unsigned(groups)," start times; plain ",float(plainUs/double(frames)/1000.0)," ms,",
+         " shared ",float(sharedUs/double(frames)/1000.0)," ms per frame (x",float(plainUs/std::max(sharedUs,1.0)),"),",
+         " hits ",unsigned(hits)," of ",unsigned(lookups),", max deviation ",maxErr);
+  }
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string_view>
+#include <functional>
+
+class World;
+
+// Micro-benchmarks, invoked from console via "bench <name>".
+// Built only with OPENGOTHIC_BENCHMARK cmake option.
+class Benchmark final {
+  public:
+    explicit Benchmark(std::function<void(std::string_view)> print);
+
+    bool exec(std::string_view name);
+
+  private:
+    std::function<void(std::string_view)> print;
+
+    // to log and to console
+    template<class ... Args>
+    void report(const Args&... args);
+    template<class ... Args>
+    void reportError(const Args&... args);
+
+    void workers();
+    void spatial();
+    void items();
+    void rooms();
+    void waynet();
+    void freepoints();
+    void rays();
+    void textureQueue();
+    void vdfs();
+    void assets();
+    void pose();
+    void animPack();
+    void animLoad();
+    void crowd();
+  };
@@ -0,0 +1,63 @@
+#include "legacyworkers.h"
+
+LegacyWorkers::LegacyWorkers() {
+  size_t id=0;
+  for(auto& i:th) {
+    i = std::thread([this,id]() noexcept {
+      threadFunc(id);
+      });
+    ++id;
+    }
+  }
+
+LegacyWorkers::~LegacyWorkers() {
+  running   = false;
+  workTasks = MAX_THREADS;
+  execWork();
+  for(auto& i:th)
+    i.join();
+  }
+
+void LegacyWorkers::threadFunc(size_t id) {
+  while(true) {
+    {
+    std::unique_lock<std::mutex> lck(sync);
+    while(!workInc[id])
+      workWait.wait(lck);
+    workInc[id]=false;
+    }
+
+    if(!running) {
+      workDone.fetch_add(1);
+      return;
+      }
+
+    size_t b = std::min((id  )*batchSize, workSize);
+    size_t e = std::min((id+1)*batchSize, workSize);
+
+    if(b!=e) {
+      void* d = workSet + b*workEltSize;
+      workFunc(d,e-b);
+      }
+
+    if(size_t(workDone.fetch_add(1)+1)==workTasks)
+      std::this_thread::yield();
+    }
+  }
+
+void LegacyWorkers::execWork() {
+  {
+    std::unique_lock<std::mutex> lck(sync);
+    for(size_t i=0; i<workTasks; ++i)
+      workInc[i]=true;
+    workWait.notify_all();
+  }
+  std::this_thread::yield();
+
+  while(true) {
+    int expect = int(workTasks);
+    if(workDone.compare_exchange_strong(expect,0,std::memory_order::acq_rel))
+      break;
+    std::this_thread::yield();
+    }
+  }
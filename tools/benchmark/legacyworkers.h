@@ -0,0 +1,67 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+#include <condition_variable>
+
+// Fork/join pool, that Workers was before the job system: baseline for "bench workers".
+// One batch per thread, mutex+condvar wake per call, spin-yield join, std::function per dispatch.
+class LegacyWorkers final {
+  public:
+    LegacyWorkers();
+    ~LegacyWorkers();
+
+    template<class T,class F>
+    void parallelFor(std::vector<T>& data, const F& func) {
+      runParallelFor(data.data(),data.size(),std::thread::hardware_concurrency(),func);
+      }
+
+    template<class T,class F>
+    void parallelFor(std::vector<T>& data, size_t maxTh, const F& func) {
+      runParallelFor(data.data(),data.size(),maxTh,func);
+      }
+
+    enum { MAX_THREADS=16 };
+
+  private:
+    void threadFunc(size_t id);
+    void execWork();
+
+    template<class T,class F>
+    void runParallelFor(T* data, size_t sz, size_t maxTh, const F& func) {
+      workSet     = reinterpret_cast<uint8_t*>(data);
+      workSize    = sz;
+      workEltSize = sizeof(T);
+
+      workFunc = [&func](void* data,size_t sz) {
+        T* tdata = reinterpret_cast<T*>(data);
+        for(size_t i=0;i<sz;++i)
+          func(tdata[i]);
+        };
+
+      if(maxTh>MAX_THREADS)
+        workTasks = MAX_THREADS; else
+        workTasks = maxTh;
+
+      batchSize = std::max<size_t>(16,(sz+workTasks-1)/workTasks);
+      execWork();
+      }
+
+    std::thread                       th     [MAX_THREADS];
+    bool                              workInc[MAX_THREADS] = {};
+
+    bool                              running=true;
+
+    uint8_t*                          workSet=nullptr;
+    size_t                            workSize=0, batchSize=0, workEltSize=0;
+    size_t                            workTasks=0;
+    std::function<void(void*,size_t)> workFunc;
+
+    std::mutex                        sync;
+    std::condition_variable           workWait;
+    std::atomic_int                   workDone{0};
+  };